@@ -0,0 +1,116 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// Measure the file access modes of the stream on a sequential scan:
+//  - read throughput
+//  - fraction of the file left in the page cache after the scan
+//    (mincore, Linux only): the streaming mode should leave none
+// The file is dropped from the page cache before each scan, so the
+// scans start cold when the file system honors the hint
+//
+// usage: bench_access [size_mb] [record_kb]
+
+#include <common.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// the fraction of the file pages in the page cache
+double cached_fraction(const std::string &fname) {
+#if defined(__linux__)
+  int fd = ::open(fname.c_str(), O_RDONLY);
+  struct stat st;
+  if((fd < 0) or (0 != fstat(fd, &st)) or (0 == st.st_size)) {
+    if(fd >= 0) {
+      ::close(fd);
+    }
+    return -1.;
+  }
+  void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  const std::size_t page = sysconf(_SC_PAGESIZE);
+  std::vector<unsigned char> pages((st.st_size + page - 1) / page);
+  double fraction = -1.;
+  if((MAP_FAILED != addr) and (0 == mincore(addr, st.st_size, pages.data()))) {
+    std::size_t resident = 0;
+    for(auto p : pages) {
+      resident += (p & 1);
+    }
+    fraction = static_cast<double>(resident) / pages.size();
+  }
+  if(MAP_FAILED != addr) {
+    munmap(addr, st.st_size);
+  }
+  ::close(fd);
+  return fraction;
+#else
+  (void)fname;
+  return -1.;
+#endif
+}
+
+// drop the file from the page cache
+void drop_cache(const std::string &fname) {
+  FILE *file = std::fopen(fname.c_str(), "rb");
+  accio::io::file::advise(file, 0, 0, accio::io::file::advice::dont_need);
+  std::fclose(file);
+}
+
+int main(int argc, char **argv) {
+  const std::size_t size_mb = (argc > 1) ? std::atoi(argv[1]) : 256;
+  const std::size_t record_kb = (argc > 2) ? std::atoi(argv[2]) : 64;
+  const std::string fname = "bench_access.accio";
+  const std::size_t nrecords = size_mb * 1024 / record_kb;
+  {
+    accio::file_writer<bench::io_config> writer;
+    bench::waveform_record record;
+    bench::waveform wf;
+    bench::fill(wf, record_kb * 1024 / sizeof(float), 1);
+    writer.open(fname);
+    for(std::size_t r = 0 ; r < nrecords ; r++) {
+      writer.write_record("waveform", record, wf);
+    }
+    writer.close();
+  }
+  std::cout << "Sequential scan of " << size_mb << " MB, records of " << record_kb << " KB" << std::endl;
+  const char *names[] = {"normal", "sequential", "streaming"};
+  const accio::io::access_mode modes[] = {accio::io::access_mode::normal, accio::io::access_mode::sequential, accio::io::access_mode::streaming};
+  for(std::size_t m = 0 ; m < 3 ; m++) {
+    drop_cache(fname);
+    const double cached_before = cached_fraction(fname);
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    accio::buffer<unsigned char> buffer(1024);
+    stream.set_access_mode(modes[m]);
+    stream.open(fname, accio::io::open_mode::read);
+    bench::timer timer;
+    std::size_t nread = 0;
+    while(accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) {
+      nread++;
+    }
+    const double elapsed = timer.elapsed();
+    stream.close();
+    std::cout << "  " << std::left << std::setw(12) << names[m] << std::right << std::fixed
+      << std::setw(8) << std::setprecision(0) << size_mb / elapsed << " MB/s"
+      << std::setw(8) << std::setprecision(1) << 100. * cached_before << " % cached before"
+      << std::setw(8) << 100. * cached_fraction(fname) << " % cached after"
+      << ((nread == nrecords) ? "" : "  MISSING RECORDS") << std::endl;
+  }
+  std::remove(fname.c_str());
+  return 0;
+}
@@ -0,0 +1,109 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// Measure the cost of record checksums:
+//  - raw CRC32C throughput (hardware and software)
+//  - write throughput with and without checksums. The checksums of
+//    large payloads are computed on a worker thread while writing if
+//    the machine has more than one hardware thread
+//  - read throughput with no, synchronous and asynchronous verification
+//
+// usage: bench_checksum [file] [nrecords] [record size in Mo]
+
+#include <common.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <accio/checksum.h>
+
+double write_file(const std::string &fname, unsigned int nrecords, const bench::waveform &wf, bool checksum) {
+  accio::file_writer<bench::io_config> writer;
+  bench::waveform_record record;
+  writer.set_checksum(checksum);
+  writer.open(fname);
+  bench::timer timer;
+  for(unsigned int i=0 ; i<nrecords ; i++) {
+    writer.write_record("waveform", record, wf);
+  }
+  writer.close();
+  return timer.elapsed();
+}
+
+double read_file(const std::string &fname, accio::io::verify_mode mode, unsigned int &nrecords) {
+  accio::stream<unsigned char> stream;
+  accio::io::record_header header;
+  accio::io::record_summary summary;
+  accio::buffer<unsigned char> buffer(1024);
+  stream.set_verify_mode(mode);
+  stream.open(fname, accio::io::open_mode::read);
+  nrecords = 0;
+  bench::timer timer;
+  while(accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) {
+    nrecords++;
+  }
+  if(accio::error_codes::stream::success != stream.wait_checksum()) {
+    std::cout << "ERROR - checksum verification failed" << std::endl;
+  }
+  stream.close();
+  return timer.elapsed();
+}
+
+int main(int argc, char **argv) {
+
+  const std::string fname = (argc > 1) ? argv[1] : "bench_checksum.accio";
+  const unsigned int nrecords = (argc > 2) ? std::atoi(argv[2]) : 200;
+  const std::size_t record_size = ((argc > 3) ? std::atoi(argv[3]) : 1)*1024*1024;
+  const unsigned int ntrials = 5;
+  const double mbytes = static_cast<double>(nrecords)*record_size / (1024.*1024.);
+
+  // raw checksum throughput
+  std::vector<unsigned char> data(64*1024*1024, 0x5a);
+  bench::timer hw_timer;
+  auto crc = accio::checksum::crc32c_hardware(data.data(), data.size());
+  double hw_time = hw_timer.elapsed();
+  bench::timer sw_timer;
+  crc ^= accio::checksum::crc32c_software(data.data(), data.size());
+  double sw_time = sw_timer.elapsed();
+  std::cout << "Hardware threads          : " << std::thread::hardware_concurrency()
+    << " (asynchronous checksums " << (accio::checksum_worker::concurrent() ? "on" : "off") << ")" << std::endl;
+  std::cout << "CRC32C hardware available : " << (accio::checksum::hardware_available() ? "yes" : "no") << std::endl;
+  std::cout << "CRC32C hardware           : " << 64. / hw_time << " Mo/s" << std::endl;
+  std::cout << "CRC32C software           : " << 64. / sw_time << " Mo/s" << " (" << crc << ")" << std::endl;
+
+  // write throughput, best of n trials
+  bench::waveform wf;
+  bench::fill(wf, record_size / sizeof(float), 42);
+  double best_plain = 1e9, best_checksum = 1e9;
+  for(unsigned int t=0 ; t<ntrials ; t++) {
+    best_plain = std::min(best_plain, write_file(fname, nrecords, wf, false));
+    best_checksum = std::min(best_checksum, write_file(fname, nrecords, wf, true));
+  }
+  std::cout << "Write without checksum    : " << mbytes / best_plain << " Mo/s" << std::endl;
+  std::cout << "Write with checksum       : " << mbytes / best_checksum << " Mo/s" << std::endl;
+  std::cout << "Write overhead            : " << 100.*(best_checksum - best_plain) / best_plain << " %" << std::endl;
+
+  // read throughput
+  const char *names[3] = {"Read without verification ", "Read, sync verification   ", "Read, async verification  "};
+  accio::io::verify_mode modes[3] = {accio::io::verify_mode::none, accio::io::verify_mode::sync, accio::io::verify_mode::async};
+  for(unsigned int m=0 ; m<3 ; m++) {
+    double best = 1e9;
+    unsigned int nread = 0;
+    for(unsigned int t=0 ; t<ntrials ; t++) {
+      best = std::min(best, read_file(fname, modes[m], nread));
+    }
+    std::cout << names[m] << ": " << mbytes / best << " Mo/s (" << nread << " records)" << std::endl;
+  }
+  std::remove(fname.c_str());
+  return 0;
+}
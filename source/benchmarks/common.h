@@ -0,0 +1,81 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_BENCHMARKS_COMMON_H
+#define ACCIO_BENCHMARKS_COMMON_H 1
+
+#include <chrono>
+#include <vector>
+
+#include <accio/writer.h>
+
+namespace bench {
+
+  /// Simple wall clock timer
+  class timer {
+  public:
+    timer() : m_start(std::chrono::steady_clock::now()) {}
+
+    /// Elapsed time in seconds since construction
+    double elapsed() const {
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+  private:
+    std::chrono::steady_clock::time_point     m_start;
+  };
+
+  /// A record made of a float waveform
+  struct waveform {
+    std::vector<float>    m_samples{};
+  };
+
+  struct io_config {
+    typedef waveform                             record_type;
+    typedef unsigned char                        char_type;
+    typedef accio::copy::standard                copy_type;
+    typedef std::allocator<char_type>            allocator_type;
+  };
+
+  class waveform_writer : public accio::block_writer<io_config> {
+  public:
+    waveform_writer(const waveform &wf) :
+      accio::block_writer<io_config>("waveform", "waveform", 1),
+      m_waveform(wf) {}
+
+    accio::error_codes::code_type write(buffer_type &outbuf) const {
+      outbuf.write_data(m_waveform.m_samples);
+      return accio::error_codes::block::success;
+    }
+
+  private:
+    const waveform     &m_waveform;
+  };
+
+  class waveform_record : public accio::record_io<io_config> {
+  public:
+    accio::error_codes::code_type create_writers(const waveform& record, block_writers &blocks) const {
+      blocks.push_back(std::make_shared<waveform_writer>(record));
+      return accio::error_codes::record::success;
+    }
+  };
+
+  /// Fill a waveform with pseudo random samples
+  inline void fill(waveform &wf, std::size_t nsamples, unsigned int seed) {
+    wf.m_samples.resize(nsamples);
+    unsigned int state = seed*2654435761u + 1;
+    for(auto &sample : wf.m_samples) {
+      state = state*1664525u + 1013904223u;
+      sample = static_cast<float>(state >> 8) / 16777216.f;
+    }
+  }
+}
+
+#endif  //  ACCIO_BENCHMARKS_COMMON_H
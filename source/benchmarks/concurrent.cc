@@ -0,0 +1,82 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// Measure the record throughput with several producer threads:
+//  - file_writer protected by a global mutex
+//  - concurrent_writer
+//
+// usage: bench_concurrent [file] [nrecords per thread] [record size in Ko]
+
+#include <common.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <accio/concurrent_writer.h>
+
+template <typename F>
+void run_producers(unsigned int nthreads, F produce) {
+  std::vector<std::thread> threads;
+  for(unsigned int t=0 ; t<nthreads ; t++) {
+    threads.emplace_back(produce);
+  }
+  for(auto &thread : threads) {
+    thread.join();
+  }
+}
+
+int main(int argc, char **argv) {
+  const std::string fname = (argc > 1) ? argv[1] : "bench_concurrent.accio";
+  const unsigned int nrecords = (argc > 2) ? std::atoi(argv[2]) : 2000;
+  const std::size_t record_size = ((argc > 3) ? std::atoi(argv[3]) : 64)*1024;
+  const unsigned int max_threads = std::max(4u, std::thread::hardware_concurrency());
+
+  bench::waveform wf;
+  bench::fill(wf, record_size / sizeof(float), 42);
+  bench::waveform_record record;
+  std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+  for(unsigned int nthreads=1 ; nthreads<=max_threads ; nthreads*=2) {
+    const double total = static_cast<double>(nthreads)*nrecords;
+    // global mutex
+    accio::file_writer<bench::io_config> writer;
+    std::mutex mutex;
+    writer.open(fname);
+    bench::timer timer;
+    run_producers(nthreads, [&]() {
+      for(unsigned int i=0 ; i<nrecords ; i++) {
+        std::lock_guard<std::mutex> lock(mutex);
+        writer.write_record("waveform", record, wf);
+      }
+    });
+    writer.close();
+    double elapsed = timer.elapsed();
+    std::cout << nthreads << " threads, mutex      : " << total / elapsed << " records/s" << std::endl;
+    // concurrent writer
+    accio::concurrent_writer<bench::io_config> cwriter;
+    cwriter.open(fname);
+    bench::timer ctimer;
+    run_producers(nthreads, [&]() {
+      for(unsigned int i=0 ; i<nrecords ; i++) {
+        cwriter.write_record("waveform", record, wf);
+      }
+    });
+    // include the time to write the pending records
+    cwriter.close();
+    elapsed = ctimer.elapsed();
+    std::cout << nthreads << " threads, concurrent : " << total / elapsed << " records/s" << std::endl;
+  }
+  std::remove(fname.c_str());
+  return 0;
+}
@@ -0,0 +1,99 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// Measure the preset dictionaries on small records (< 4 KB), compressed
+// one by one: deflate ratio and compress/uncompress throughput without
+// dictionary and with trained dictionaries of several sizes.
+// The dictionaries are trained on the first records and measured on the
+// next ones
+//
+// usage: bench_dictionary [nrecords] [level]
+
+#include <common.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+// a small record: a header and a few hits with named detectors, serialized
+// as a block writer would
+std::vector<unsigned char> make_record(unsigned int index) {
+  const char *detectors[] = {"ElectromagneticCalorimeterBarrel", "HadronicCalorimeterEndcap", "SiliconVertexDetectorLayer", "MuonChamberBarrel"};
+  accio::buffer<unsigned char> buffer(4096);
+  const std::string header = "run:1042 event:" + std::to_string(index) + " trigger:physics";
+  buffer.write_data(std::vector<char>(header.begin(), header.end()));
+  unsigned int seed = 12345u + index;
+  const unsigned int nhits = 10 + index % 40;
+  for(unsigned int i = 0 ; i < nhits ; i++) {
+    seed = seed*1664525u + 1013904223u;
+    const std::string detector = detectors[(seed >> 8) % 4];
+    buffer.write_data(std::vector<char>(detector.begin(), detector.end()));
+    buffer.write_data(static_cast<std::int32_t>(seed >> 20));
+    buffer.write_data(static_cast<float>(seed >> 24) * 0.5f);
+    buffer.write_data(static_cast<std::uint16_t>(i));
+  }
+  auto data = reinterpret_cast<const unsigned char*>(buffer.begin());
+  return std::vector<unsigned char>(data, data + buffer.tell());
+}
+
+int main(int argc, char **argv) {
+  const unsigned int nrecords = (argc > 1) ? std::atoi(argv[1]) : 20000;
+  const int level = (argc > 2) ? std::atoi(argv[2]) : 6;
+  const unsigned int ntraining = 200;
+  std::vector<std::vector<unsigned char>> records;
+  std::size_t total = 0;
+  for(unsigned int i = 0 ; i < ntraining + nrecords ; i++) {
+    records.push_back(make_record(i));
+    total += (i >= ntraining) ? records.back().size() : 0;
+  }
+  std::cout << "Small records: " << nrecords << " records, " << total / nrecords << " bytes on average, level " << level << std::endl;
+  const std::vector<std::vector<unsigned char>> samples(records.begin(), records.begin() + ntraining);
+  accio::compressor comp;
+  accio::decompressor decomp;
+  std::vector<unsigned char> output(8192);
+  std::vector<std::vector<unsigned char>> compressed(records.size());
+  for(std::size_t dict_size : {0, 1024, 4096, 16384, 32768}) {
+    bench::timer train_timer;
+    const auto dictionary = (0 == dict_size) ? accio::compressor::dictionary_type() : accio::compressor::train_dictionary(samples, dict_size);
+    const double train_time = train_timer.elapsed();
+    const accio::compressor::dictionary_type *dict = dictionary.empty() ? nullptr : &dictionary;
+    std::size_t compressed_size = 0;
+    bench::timer compress_timer;
+    for(unsigned int i = ntraining ; i < records.size() ; i++) {
+      comp.begin(level, records[i].size(), dict);
+      comp.update(records[i].data(), records[i].size());
+      const auto size = comp.finish();
+      compressed[i].assign(comp.data(), comp.data() + size);
+      compressed_size += size;
+    }
+    const double compress_speed = 1e-6 * total / compress_timer.elapsed();
+    bool match = true;
+    bench::timer uncompress_timer;
+    for(unsigned int i = ntraining ; i < records.size() ; i++) {
+      match = decomp.uncompress(compressed[i].data(), compressed[i].size(), output.data(), records[i].size(), dict) and match;
+    }
+    const double uncompress_speed = 1e-6 * total / uncompress_timer.elapsed();
+    // check the round trip, out of the timed loop
+    for(unsigned int i = ntraining ; match and (i < records.size()) ; i++) {
+      decomp.uncompress(compressed[i].data(), compressed[i].size(), output.data(), records[i].size(), dict);
+      match = std::equal(records[i].begin(), records[i].end(), output.begin());
+    }
+    std::cout << "  dictionary " << std::setw(6) << dictionary.size() << " bytes" << std::fixed
+      << std::setw(8) << std::setprecision(1) << 100. * compressed_size / total << " % size"
+      << std::setw(10) << std::setprecision(0) << compress_speed << " MB/s compress"
+      << std::setw(10) << uncompress_speed << " MB/s uncompress"
+      << std::setw(8) << std::setprecision(1) << 1e3 * train_time << " ms training"
+      << (match ? "" : "  MISMATCH") << std::endl;
+  }
+  return 0;
+}
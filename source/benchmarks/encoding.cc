@@ -0,0 +1,114 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// Measure the size and the encode/decode throughput of the integer
+// array encodings:
+//  - 64 bit timestamps with a jittered period
+//  - 32 bit sorted ids
+//  - 4 bit status codes
+//  - flags (bools)
+//
+// usage: bench_encoding [nvalues] [niterations]
+
+#include <common.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+#include <accio/encoding.h>
+
+template <typename T>
+void run(const char *title, const std::vector<T> &data, unsigned int niterations) {
+  std::cout << title << " (" << data.size() << " values)" << std::endl;
+  const char *names[] = {"raw", "frame of ref.", "delta", "delta of delta", "packed"};
+  for(auto enc : {accio::encoding::raw, accio::encoding::frame_of_reference, accio::encoding::delta, accio::encoding::delta_of_delta, accio::encoding::packed}) {
+    accio::buffer<unsigned char> outbuf(sizeof(T)*data.size() + 1024);
+    std::vector<T> read_data;
+    std::size_t size = 0;
+    bench::timer write_timer;
+    for(unsigned int i=0 ; i<niterations ; i++) {
+      outbuf.reset(outbuf.memsize(), std::ios_base::out);
+      size = accio::write_encoded(outbuf, data, enc);
+    }
+    const double write_time = write_timer.elapsed();
+    accio::buffer<unsigned char> inbuf(outbuf.begin(), size, true);
+    bench::timer read_timer;
+    for(unsigned int i=0 ; i<niterations ; i++) {
+      inbuf.seekpos(0);
+      accio::read_encoded(inbuf, read_data);
+    }
+    const double read_time = read_timer.elapsed();
+    const double mbytes = 1e-6 * sizeof(T) * data.size() * niterations;
+    std::cout << "  " << std::left << std::setw(16) << names[static_cast<int>(enc)] << std::right << std::fixed << std::setprecision(2)
+      << std::setw(8) << 8.0 * size / data.size() << " bits/value"
+      << std::setw(10) << std::setprecision(0) << mbytes / write_time << " MB/s encode"
+      << std::setw(10) << mbytes / read_time << " MB/s decode"
+      << ((read_data == data) ? "" : "  MISMATCH") << std::endl;
+  }
+}
+
+int main(int argc, char **argv) {
+  const std::size_t nvalues = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+  const unsigned int niterations = (argc > 2) ? std::atoi(argv[2]) : 50;
+  std::vector<std::uint64_t> timestamps(nvalues);
+  std::vector<std::int32_t> ids(nvalues);
+  unsigned int state = 12345;
+  std::uint64_t timestamp = 1600000000000000ull;
+  std::int32_t id = 0;
+  for(std::size_t i=0 ; i<nvalues ; i++) {
+    state = state*1664525u + 1013904223u;
+    timestamp += 1000 + (state >> 28);
+    id += 1 + (state >> 26);
+    timestamps[i] = timestamp;
+    ids[i] = id;
+  }
+  run("Timestamps, 64 bits", timestamps, niterations);
+  run("Sorted ids, 32 bits", ids, niterations);
+  std::vector<unsigned char> codes(nvalues);
+  std::vector<bool> flags(nvalues);
+  for(std::size_t i=0 ; i<nvalues ; i++) {
+    state = state*1664525u + 1013904223u;
+    codes[i] = static_cast<unsigned char>(state >> 28);
+    flags[i] = (0 != (state & 0x10000));
+  }
+  run("Status codes, 4 bits", codes, niterations);
+
+  // one bit per flag vs one byte per flag
+  std::vector<unsigned char> flag_bytes(flags.begin(), flags.end());
+  accio::buffer<unsigned char> outbuf(nvalues + 1024);
+  std::size_t packed_size = 0, byte_size = 0;
+  bench::timer timer;
+  for(unsigned int i=0 ; i<niterations ; i++) {
+    outbuf.reset(outbuf.memsize(), std::ios_base::out);
+    packed_size = accio::write_packed(outbuf, flags);
+  }
+  const double write_time = timer.elapsed();
+  accio::buffer<unsigned char> inbuf(outbuf.begin(), packed_size, true);
+  std::vector<bool> read_flags;
+  bench::timer read_timer;
+  for(unsigned int i=0 ; i<niterations ; i++) {
+    inbuf.seekpos(0);
+    accio::read_packed(inbuf, read_flags);
+  }
+  const double read_time = read_timer.elapsed();
+  outbuf.reset(outbuf.memsize(), std::ios_base::out);
+  byte_size = outbuf.write_data(flag_bytes);
+  std::cout << "Flags (" << nvalues << " values)" << std::endl;
+  std::cout << "  " << std::left << std::setw(16) << "bytes" << std::right << std::fixed << std::setprecision(2)
+    << std::setw(8) << 8.0 * byte_size / nvalues << " bits/value" << std::endl;
+  std::cout << "  " << std::left << std::setw(16) << "packed" << std::right << std::fixed << std::setprecision(2)
+    << std::setw(8) << 8.0 * packed_size / nvalues << " bits/value"
+    << std::setw(10) << std::setprecision(0) << 1e-6 * nvalues * niterations / write_time << " Mflags/s encode"
+    << std::setw(10) << 1e-6 * nvalues * niterations / read_time << " Mflags/s decode"
+    << ((read_flags == flags) ? "" : "  MISMATCH") << std::endl;
+  return 0;
+}
@@ -0,0 +1,97 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// Measure the record groups on small records (slow control readings),
+// compressed one by one or by groups of several sizes:
+//  - file size and write throughput
+//  - sequential read throughput
+//  - random reads from the record index
+//
+// usage: bench_group [nrecords] [level]
+
+#include <common.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+int main(int argc, char **argv) {
+  const unsigned int nrecords = (argc > 1) ? std::atoi(argv[1]) : 200000;
+  const unsigned int level = (argc > 2) ? std::atoi(argv[2]) : 6;
+  const unsigned int nrandom = 2000;
+  const std::string fname = "bench_group.accio";
+  // slow control readings: 16 slowly drifting channels with a little noise
+  std::vector<bench::waveform> readings(nrecords);
+  unsigned int state = 12345;
+  for(unsigned int r = 0 ; r < nrecords ; r++) {
+    readings[r].m_samples.resize(16);
+    for(unsigned int c = 0 ; c < 16 ; c++) {
+      state = state*1664525u + 1013904223u;
+      readings[r].m_samples[c] = 20.f + c + 0.0001f * r + static_cast<float>(state >> 28) * 0.01f;
+    }
+  }
+  const double total = 1e-6 * nrecords * (sizeof(float) * 16);
+  std::cout << "Small records: " << nrecords << " records of 16 floats, level " << level << std::endl;
+  bench::waveform_record record;
+  for(std::size_t grouping : {0, 16*1024, 256*1024, 1024*1024}) {
+    accio::file_writer<bench::io_config> writer;
+    writer.set_compression(level);
+    writer.set_checksum(true);
+    writer.set_grouping(grouping);
+    writer.open(fname);
+    bench::timer write_timer;
+    for(auto &reading : readings) {
+      writer.write_record("readings", record, reading);
+    }
+    writer.close();
+    const double write_time = write_timer.elapsed();
+    FILE *file = std::fopen(fname.c_str(), "rb");
+    std::fseek(file, 0, SEEK_END);
+    const double file_size = 1e-6 * std::ftell(file);
+    std::fclose(file);
+    // sequential reads
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    accio::buffer<unsigned char> buffer(1024);
+    bench::waveform wf;
+    stream.open(fname, accio::io::open_mode::read);
+    bench::timer read_timer;
+    unsigned int nread = 0;
+    while(accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) {
+      buffer.read_data(wf.m_samples);
+      nread++;
+    }
+    const double read_time = read_timer.elapsed();
+    // random reads
+    std::vector<accio::io::record_position> index;
+    bench::timer index_timer;
+    stream.build_index(index);
+    const double index_time = index_timer.elapsed();
+    bench::timer random_timer;
+    for(unsigned int i = 0 ; i < nrandom ; i++) {
+      state = state*1664525u + 1013904223u;
+      stream.seek_record(index[state % index.size()]);
+      stream.read_record(header, summary, buffer);
+    }
+    const double random_time = random_timer.elapsed();
+    stream.close();
+    std::cout << "  group " << std::setw(8) << grouping << " bytes" << std::fixed
+      << std::setw(8) << std::setprecision(1) << 100. * file_size / total << " % size"
+      << std::setw(8) << std::setprecision(0) << total / write_time << " MB/s write"
+      << std::setw(8) << total / read_time << " MB/s read"
+      << std::setw(8) << std::setprecision(1) << 1e3 * index_time << " ms index"
+      << std::setw(10) << std::setprecision(0) << nrandom / random_time << " random reads/s"
+      << ((nread == nrecords) ? "" : "  MISSING RECORDS") << std::endl;
+  }
+  std::remove(fname.c_str());
+  return 0;
+}
@@ -0,0 +1,91 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// Measure the huge page allocator against std::allocator on multi-MB
+// record buffers:
+//  - serialization throughput into a new buffer (page faults included)
+//    and into a reused buffer
+//  - byte swapped read throughput
+//  - memory backed by huge pages while the buffer is alive
+//    (AnonHugePages, Linux only)
+//
+// usage: bench_huge_page [size_mb] [niterations]
+
+#include <common.h>
+
+#include <accio/huge_page_allocator.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+// the anonymous memory backed by huge pages in kB, -1 if unknown
+long anon_huge_pages() {
+  std::ifstream file("/proc/self/smaps_rollup");
+  std::string line;
+  while(std::getline(file, line)) {
+    if(0 == line.compare(0, 14, "AnonHugePages:")) {
+      std::istringstream value(line.substr(14));
+      long kb = -1;
+      value >> kb;
+      return kb;
+    }
+  }
+  return -1;
+}
+
+template <typename alloc>
+void run(const char *title, const bench::waveform &wf, unsigned int niterations) {
+  typedef accio::buffer<unsigned char, accio::copy::standard, alloc> buffer_type;
+  const std::size_t size = wf.m_samples.size()*sizeof(float);
+  std::vector<float> samples(wf.m_samples.size());
+  double fresh_time = 0., reuse_time = 0., swap_time = 0.;
+  long huge_kb = -1;
+  for(unsigned int i=0 ; i<niterations ; i++) {
+    bench::timer fresh_timer;
+    buffer_type buffer(size + 1024);
+    buffer.write_data(wf.m_samples[0], wf.m_samples.size());
+    fresh_time += fresh_timer.elapsed();
+    bench::timer reuse_timer;
+    buffer.reset(size + 1024, std::ios_base::out);
+    buffer.write_data(wf.m_samples[0], wf.m_samples.size());
+    reuse_time += reuse_timer.elapsed();
+    // the bytes are swapped on read only
+    buffer.reset(buffer.size(), std::ios_base::in);
+    buffer.set_byte_swap(true);
+    bench::timer swap_timer;
+    buffer.read_data(samples[0], samples.size());
+    swap_time += swap_timer.elapsed();
+    buffer.set_byte_swap(false);
+    huge_kb = anon_huge_pages();
+  }
+  const double mb = 1e-6 * size * niterations;
+  std::cout << std::setw(22) << std::left << title << std::right << std::fixed << std::setprecision(1)
+    << std::setw(12) << mb / fresh_time << " MB/s"
+    << std::setw(12) << mb / reuse_time << " MB/s"
+    << std::setw(12) << mb / swap_time << " MB/s"
+    << std::setw(12) << huge_kb / 1024. << " MB" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  const std::size_t size_mb = (argc > 1) ? std::atoi(argv[1]) : 64;
+  const unsigned int niterations = (argc > 2) ? std::atoi(argv[2]) : 20;
+  bench::waveform wf;
+  bench::fill(wf, size_mb*1024*1024 / sizeof(float), 1);
+  std::cout << "Buffers of " << size_mb << " MB, " << niterations << " iterations, transparent huge pages "
+    << (accio::huge_pages_enabled() ? "enabled" : "disabled") << std::endl;
+  std::cout << std::setw(22) << std::left << "allocator" << std::right
+    << std::setw(17) << "new buffer" << std::setw(17) << "reused" << std::setw(17) << "byte swap" << std::setw(15) << "huge pages" << std::endl;
+  run<std::allocator<unsigned char>>("std::allocator", wf, niterations);
+  run<accio::huge_page_allocator<unsigned char>>("huge_page_allocator", wf, niterations);
+  return 0;
+}
@@ -0,0 +1,54 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// Measure the effect of the mantissa truncation of float arrays:
+//  - buffer write throughput
+//  - zlib compressed size of the payload
+//  - maximum relative error introduced
+//
+// usage: bench_mantissa [nvalues] [niterations]
+
+#include <common.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+#include <zlib.h>
+
+int main(int argc, char **argv) {
+  const std::size_t nvalues = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+  const unsigned int niterations = (argc > 2) ? std::atoi(argv[2]) : 50;
+  // energies with a smooth spectrum, as out of a digitizer
+  bench::waveform wf;
+  bench::fill(wf, nvalues, 42);
+  for(auto &sample : wf.m_samples) {
+    sample = 10.f * sample * sample + 0.5f;
+  }
+  std::vector<Bytef> compressed(compressBound(sizeof(float)*nvalues + 1024));
+  std::cout << "Float array of " << nvalues << " values" << std::endl;
+  for(unsigned int bits : {0, 8, 12, 16}) {
+    accio::buffer<unsigned char> outbuf(sizeof(float)*nvalues + 1024);
+    outbuf.set_truncation(bits);
+    bench::timer timer;
+    for(unsigned int i=0 ; i<niterations ; i++) {
+      outbuf.reset(outbuf.memsize(), std::ios_base::out);
+      outbuf.write_data(wf.m_samples);
+    }
+    const double write_time = timer.elapsed();
+    uLongf compressed_size = compressed.size();
+    compress2(compressed.data(), &compressed_size, outbuf.begin(), outbuf.tell(), Z_DEFAULT_COMPRESSION);
+    std::cout << "  " << std::setw(2) << bits << " bits zeroed" << std::fixed
+      << std::setw(10) << std::setprecision(0) << 1e-6 * sizeof(float) * nvalues * niterations / write_time << " MB/s"
+      << std::setw(8) << std::setprecision(1) << 100. * compressed_size / outbuf.tell() << " % compressed size"
+      << std::setw(12) << std::scientific << std::setprecision(2) << outbuf.truncation_error() << " max rel. error" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,88 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// Measure the record cache on repeated random reads: a handful of
+// compressed records revisited many times (event display, iterative
+// calibration), read from the file or through caches of several budgets
+//
+// usage: bench_record_cache [nrecords] [nreads] [nrevisited]
+
+#include <common.h>
+
+#include <accio/record_cache.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+int main(int argc, char **argv) {
+  const unsigned int nrecords = (argc > 1) ? std::atoi(argv[1]) : 2000;
+  const unsigned int nreads = (argc > 2) ? std::atoi(argv[2]) : 20000;
+  const unsigned int nrevisited = (argc > 3) ? std::atoi(argv[3]) : 20;
+  const std::size_t nsamples = 4096;
+  const std::string fname = "bench_record_cache.accio";
+  {
+    accio::file_writer<bench::io_config> writer;
+    writer.set_compression(6);
+    writer.set_checksum(true);
+    bench::waveform_record record;
+    bench::waveform wf;
+    writer.open(fname);
+    for(unsigned int r = 0 ; r < nrecords ; r++) {
+      bench::fill(wf, nsamples, r);
+      // digitized samples compress
+      for(auto &sample : wf.m_samples) {
+        sample = static_cast<float>(static_cast<int>(sample * 64.f));
+      }
+      writer.write_record("waveform", record, wf);
+    }
+    writer.close();
+  }
+  accio::stream<unsigned char> stream;
+  accio::io::record_header header;
+  accio::io::record_summary summary;
+  accio::buffer<unsigned char> buffer(1024);
+  std::vector<accio::io::record_position> index;
+  stream.open(fname, accio::io::open_mode::read);
+  stream.build_index(index);
+  std::cout << nreads << " reads of " << nrevisited << " records out of " << nrecords << " (" << nsamples << " floats each)" << std::endl;
+  bench::waveform wf;
+  typedef accio::record_cache<accio::cached_record<unsigned char>> cache_type;
+  for(std::size_t budget : {0, 256*1024, 1024*1024, 16*1024*1024}) {
+    cache_type cache(budget);
+    unsigned int state = 42;
+    bench::timer timer;
+    for(unsigned int i = 0 ; i < nreads ; i++) {
+      state = state*1664525u + 1013904223u;
+      const auto &position = index[((state >> 16) % nrevisited) * (nrecords / nrevisited)];
+      if(0 == budget) {
+        stream.seek_record(position);
+        stream.read_record(header, summary, buffer);
+      }
+      else {
+        accio::read_record(stream, cache, position, header, summary, buffer);
+      }
+      buffer.read_data(wf.m_samples);
+    }
+    const double elapsed = timer.elapsed();
+    auto stats = cache.statistics();
+    std::cout << "  " << ((0 == budget) ? "no cache      " : "cache ") << std::setw(8);
+    if(0 != budget) {
+      std::cout << budget;
+    }
+    std::cout << std::fixed << std::setprecision(0) << std::setw(12) << nreads / elapsed << " reads/s"
+      << std::setw(8) << std::setprecision(1) << ((0 == budget) ? 0. : 100. * stats.m_hits / nreads) << " % hits"
+      << std::setw(6) << stats.m_records << " records cached" << std::endl;
+  }
+  stream.close();
+  std::remove(fname.c_str());
+  return 0;
+}
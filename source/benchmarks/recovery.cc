@@ -0,0 +1,74 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// Measure the record scanner throughput:
+//  - marker search in memory
+//  - scan of a valid file (header to header)
+//  - scan of a file with a broken first record (marker search up to the next one)
+//
+// usage: bench_recovery [file] [nrecords] [record size in Ko]
+
+#include <common.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <accio/recovery.h>
+
+double scan_file(const std::string &fname, accio::scan_report &report) {
+  accio::record_scanner scanner;
+  bench::timer timer;
+  scanner.scan(fname, report);
+  return timer.elapsed();
+}
+
+int main(int argc, char **argv) {
+  const std::string fname = (argc > 1) ? argv[1] : "bench_recovery.accio";
+  const unsigned int nrecords = (argc > 2) ? std::atoi(argv[2]) : 2000;
+  const std::size_t record_size = ((argc > 3) ? std::atoi(argv[3]) : 256)*1024;
+
+  // marker search in memory
+  std::vector<unsigned char> data(64*1024*1024, 0);
+  bench::timer search_timer;
+  auto pos = accio::record_scanner::find_marker(data.data(), data.size());
+  const double search_time = search_timer.elapsed();
+  std::cout << "Marker search        : " << data.size() / (1024.*1024.) / search_time << " Mo/s (" << (pos == data.size()) << ")" << std::endl;
+
+  bench::waveform wf;
+  bench::fill(wf, record_size / sizeof(float), 42);
+  accio::file_writer<bench::io_config> writer;
+  bench::waveform_record record;
+  writer.open(fname);
+  for(unsigned int i=0 ; i<nrecords ; i++) {
+    writer.write_record("waveform", record, wf);
+  }
+  writer.close();
+
+  accio::scan_report report;
+  double best = 1e9;
+  for(int i=0 ; i<5 ; i++) {
+    best = std::min(best, scan_file(fname, report));
+  }
+  std::cout << "Scan valid file      : " << report.m_file_size / (1024.*1024.) / best << " Mo/s (" << report.m_records.size() << " records)" << std::endl;
+
+  // break the first record marker
+  FILE *file = fopen(fname.c_str(), "r+b");
+  fputc(0, file);
+  fclose(file);
+  best = 1e9;
+  for(int i=0 ; i<5 ; i++) {
+    best = std::min(best, scan_file(fname, report));
+  }
+  std::cout << "Scan broken file     : " << report.m_file_size / (1024.*1024.) / best << " Mo/s (" << report.m_records.size() << " records)" << std::endl;
+  std::remove(fname.c_str());
+  return 0;
+}
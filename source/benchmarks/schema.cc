@@ -0,0 +1,98 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// Measure the per-record serialization overhead of a 30 blocks record:
+//  - record_io: block writers created for each record, virtual calls
+//  - record_schema: static block list, direct calls
+//
+// usage: bench_schema [nrecords]
+
+#include <common.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <utility>
+
+/// A small block of the waveform: the blocks differ by their index only
+template <std::size_t index>
+struct sample_block {
+  static const char *type() { return "sample"; }
+  static const char *name() { return "sample"; }
+  static constexpr accio::types::version_type version() { return accio::version::encode(1, 0); }
+  template <typename buffer_type>
+  static accio::error_codes::code_type write(buffer_type &outbuf, const bench::waveform &wf) {
+    outbuf.write_data(wf.m_samples[index]);
+    return accio::error_codes::block::success;
+  }
+};
+
+class sample_writer : public accio::block_writer<bench::io_config> {
+public:
+  sample_writer(const bench::waveform &wf, std::size_t index) :
+    accio::block_writer<bench::io_config>("sample", "sample", accio::version::encode(1, 0)),
+    m_waveform(wf),
+    m_index(index) {}
+
+  accio::error_codes::code_type write(buffer_type &outbuf) const {
+    outbuf.write_data(m_waveform.m_samples[m_index]);
+    return accio::error_codes::block::success;
+  }
+
+private:
+  const bench::waveform     &m_waveform;
+  const std::size_t          m_index;
+};
+
+constexpr std::size_t nblocks = 30;
+
+class samples_record : public accio::record_io<bench::io_config> {
+public:
+  accio::error_codes::code_type create_writers(const bench::waveform& record, block_writers &blocks) const {
+    for(std::size_t b=0 ; b<nblocks ; b++) {
+      blocks.push_back(std::make_shared<sample_writer>(record, b));
+    }
+    return accio::error_codes::record::success;
+  }
+};
+
+template <std::size_t... indices>
+accio::record_schema<bench::io_config, sample_block<indices>...> make_schema(std::index_sequence<indices...>) {
+  return accio::record_schema<bench::io_config, sample_block<indices>...>();
+}
+
+template <typename layout>
+double run(const layout &record_layout, const bench::waveform &wf, unsigned int nrecords) {
+  accio::file_writer<bench::io_config> writer;
+  accio::io::record_header header;
+  accio::io::record_summary summary;
+  accio::file_writer<bench::io_config>::buffer_type outbuf(64*1024);
+  bench::timer timer;
+  for(unsigned int i=0 ; i<nrecords ; i++) {
+    writer.serialize_record("waveform", record_layout, wf, header, summary, outbuf);
+  }
+  return timer.elapsed();
+}
+
+int main(int argc, char **argv) {
+  const unsigned int nrecords = (argc > 1) ? std::atoi(argv[1]) : 200000;
+  bench::waveform wf;
+  bench::fill(wf, nblocks, 42);
+  samples_record record;
+  auto schema = make_schema(std::make_index_sequence<nblocks>());
+  const double dynamic_time = run(record, wf, nrecords);
+  const double static_time = run(schema, wf, nrecords);
+  std::cout << "Serialization of " << nblocks << " blocks records" << std::endl;
+  std::cout << "  " << std::left << std::setw(16) << "record_io" << std::right << std::fixed << std::setprecision(1)
+    << std::setw(10) << 1e9 * dynamic_time / nrecords << " ns/record" << std::endl;
+  std::cout << "  " << std::left << std::setw(16) << "record_schema" << std::right << std::fixed << std::setprecision(1)
+    << std::setw(10) << 1e9 * static_time / nrecords << " ns/record" << std::endl;
+  return 0;
+}
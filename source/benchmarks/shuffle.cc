@@ -0,0 +1,93 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// Measure the shuffle filters applied before the record compression:
+//  - throughput of the shuffle kernels (AVX2 if available vs scalar)
+//  - deflate ratio and compress/uncompress throughput, per filter,
+//    on digitized waveforms stored as floats and as 32 bit integers
+//
+// usage: bench_shuffle [nvalues] [niterations] [level]
+
+#include <common.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+template <typename F>
+double throughput(std::size_t size, unsigned int niterations, F &&func) {
+  bench::timer timer;
+  for(unsigned int i=0 ; i<niterations ; i++) {
+    func();
+  }
+  return 1e-6 * size * niterations / timer.elapsed();
+}
+
+void run(const char *title, const std::vector<unsigned char> &data, std::size_t element, unsigned int niterations, int level) {
+  std::cout << title << " (" << data.size() / element << " values, level " << level << ")" << std::endl;
+  const char *names[] = {"none", "byte shuffle", "bit shuffle"};
+  const accio::types::option_word types[] = {accio::io::filter::none, accio::io::filter::byte_shuffle, accio::io::filter::bit_shuffle};
+  std::vector<unsigned char> filtered(data.size()), restored(data.size()), scratch(data.size());
+  accio::compressor comp;
+  accio::decompressor decomp;
+  for(std::size_t f=0 ; f<3 ; f++) {
+    const auto filter = accio::io::filter::encode(types[f], element);
+    std::size_t compressed_size = 0;
+    const double compress_speed = throughput(data.size(), niterations, [&]() {
+      accio::shuffle::encode(filter, data.data(), data.size(), filtered.data());
+      comp.begin(level, data.size());
+      comp.update(filtered.data(), filtered.size());
+      compressed_size = comp.finish();
+    });
+    const double uncompress_speed = throughput(data.size(), niterations, [&]() {
+      decomp.uncompress(comp.data(), compressed_size, scratch.data(), scratch.size());
+      accio::shuffle::decode(filter, scratch.data(), scratch.size(), restored.data());
+    });
+    std::cout << "  " << std::left << std::setw(14) << names[f] << std::right << std::fixed
+      << std::setw(8) << std::setprecision(1) << 100. * compressed_size / data.size() << " % size"
+      << std::setw(10) << std::setprecision(0) << compress_speed << " MB/s compress"
+      << std::setw(10) << uncompress_speed << " MB/s uncompress"
+      << ((restored == data) ? "" : "  MISMATCH") << std::endl;
+  }
+  // the kernels alone
+  const std::size_t n = data.size() / element;
+  std::cout << "  kernels" << (accio::shuffle::avx2_available() ? " (AVX2)" : "") << std::fixed << std::setprecision(0)
+    << ": byte " << throughput(data.size(), niterations, [&]() { accio::shuffle::byte_shuffle(data.data(), data.size(), element, filtered.data()); })
+    << " / " << throughput(data.size(), niterations, [&]() { accio::shuffle::byte_unshuffle(filtered.data(), data.size(), element, restored.data()); })
+    << " MB/s, bit " << throughput(data.size(), niterations, [&]() { accio::shuffle::bit_shuffle(data.data(), data.size(), element, filtered.data()); })
+    << " / " << throughput(data.size(), niterations, [&]() { accio::shuffle::bit_unshuffle(filtered.data(), data.size(), element, restored.data()); })
+    << " MB/s, scalar byte " << throughput(data.size(), niterations, [&]() { accio::details::byte_shuffle_scalar(data.data(), 0, n, n, element, filtered.data()); })
+    << " MB/s, scalar bit " << throughput(data.size(), niterations, [&]() { accio::details::bit_shuffle_scalar(data.data(), 0, n/8, n/8, element, filtered.data()); })
+    << " MB/s (shuffle / unshuffle)" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  const std::size_t nvalues = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+  const unsigned int niterations = (argc > 2) ? std::atoi(argv[2]) : 10;
+  const int level = (argc > 3) ? std::atoi(argv[3]) : 1;
+  // digitized waveforms: a baseline with noise and pulses every 100 samples
+  std::vector<float> samples(nvalues);
+  std::vector<std::int32_t> adc(nvalues);
+  unsigned int state = 12345;
+  for(std::size_t i=0 ; i<nvalues ; i++) {
+    state = state*1664525u + 1013904223u;
+    const float noise = static_cast<float>(state >> 20) / 4096.f - 0.5f;
+    const float t = static_cast<float>(i % 100);
+    const float pulse = (t > 20.f) ? 800.f * (t - 20.f) / 10.f * std::exp(-(t - 20.f) / 10.f) : 0.f;
+    samples[i] = 200.f + 3.f * noise + pulse;
+    adc[i] = static_cast<std::int32_t>(samples[i]);
+  }
+  auto float_bytes = reinterpret_cast<const unsigned char*>(samples.data());
+  auto adc_bytes = reinterpret_cast<const unsigned char*>(adc.data());
+  run("Float waveform", std::vector<unsigned char>(float_bytes, float_bytes + sizeof(float)*nvalues), sizeof(float), niterations, level);
+  run("ADC counts, 32 bits", std::vector<unsigned char>(adc_bytes, adc_bytes + sizeof(std::int32_t)*nvalues), sizeof(std::int32_t), niterations, level);
+  return 0;
+}
@@ -5,6 +5,7 @@
 
 #include <accio/definitions.h>
 #include <accio/writer.h>
+#include <accio/descriptor.h>
 
 // A basic structure holding event data (not mandatory)
 struct event_info {
@@ -12,6 +13,16 @@ struct event_info {
   int   m_run;
 };
 
+// The fields of event_info, declared once for writing and reading
+namespace accio {
+  template <>
+  struct descriptor<event_info> {
+    static constexpr auto fields() {
+      return make_fields(&event_info::m_event, &event_info::m_run);
+    }
+  };
+}
+
 // The main interface to interact with our data
 // A record in this example correspond to the data hold
 // by this class
@@ -32,6 +43,10 @@ public:
     return m_info.m_event;
   }
 
+  const event_info &info() const {
+    return m_info;
+  }
+
 private:
   event_info       m_info;
 };
@@ -52,8 +67,10 @@ public:
   }
 
   accio::error_codes::code_type write(buffer_type &outbuf) const {
-    outbuf.write_data(m_event.event_nb());
-    outbuf.write_data(m_event.run_nb());
+    // the two fields are written in a single copy
+    if(0 == accio::write_fields(outbuf, m_event.info())) {
+      return accio::error_codes::block::bad_fields;
+    }
     return accio::error_codes::block::success;
   }
 
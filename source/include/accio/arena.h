@@ -0,0 +1,188 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_ARENA_H
+#define ACCIO_ARENA_H 1
+
+// -- std headers
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace accio {
+
+  /// arena class
+  ///
+  /// A record scoped monotonic memory arena. Memory is obtained by
+  /// bumping a pointer in large chunks and is never released object
+  /// by object: the whole arena is reset at once when moving to the
+  /// next record. The chunks are kept across resets, so that reading
+  /// records of similar sizes doesn't allocate any memory from the
+  /// system in steady state.
+  class arena {
+  public:
+    // traits
+    typedef std::size_t             size_type;
+
+    // constants
+    static constexpr size_type      default_chunk_size = 1024*1024; // 1 Mo chunks
+
+  public:
+    /// Constructor with chunk size
+    arena(size_type chunk_size = default_chunk_size);
+
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+    /// Destructor. Destroy the remaining objects and release the chunks
+    ~arena();
+
+    /// Allocate 'size' bytes aligned on 'align' (a power of 2)
+    void *allocate(size_type size, size_type align = alignof(std::max_align_t));
+
+    /// Construct an object in the arena. If the object is not trivially
+    /// destructible, its destructor is called when the arena is reset
+    template <typename T, typename ...Args>
+    T *create(Args&& ...args);
+
+    /// Allocate an array of 'count' default initialized trivially
+    /// destructible objects. Throws std::bad_array_new_length if the
+    /// array size overflows
+    template <typename T>
+    T *create_array(size_type count);
+
+    /// Reset the arena. All objects created in the arena are destroyed
+    /// and the memory is reused by the next allocations. This is O(1)
+    /// if only trivially destructible objects were created
+    void reset() noexcept;
+
+    /// The number of bytes currently allocated in the arena
+    inline size_type allocated() const noexcept {
+      return m_allocated;
+    }
+
+    /// The total number of bytes reserved by the arena chunks
+    inline size_type capacity() const noexcept {
+      return m_capacity;
+    }
+
+  private:
+    /// Move to a chunk able to hold 'size' bytes aligned on 'align'
+    void next_chunk(size_type size, size_type align);
+
+  private:
+    /// A memory chunk
+    struct chunk {
+      /// The chunk memory
+      char                    *m_data;
+      /// The chunk size
+      size_type                m_size;
+    };
+
+    /// A pending destructor call, itself allocated in the arena
+    struct destructor {
+      /// The function calling the object destructor
+      void                   (*m_function)(void*);
+      /// The object to destroy
+      void                    *m_object;
+      /// The previously registered destructor
+      destructor              *m_next;
+    };
+
+    /// The default chunk size
+    const size_type            m_chunk_size;
+    /// The list of allocated chunks
+    std::vector<chunk>         m_chunks{};
+    /// The index of the chunk in use
+    size_type                  m_index{0};
+    /// The current allocation position in the chunk in use
+    char                      *m_current{nullptr};
+    /// The end of the chunk in use
+    char                      *m_end{nullptr};
+    /// The list of destructors to call on reset (last created first)
+    destructor                *m_destructors{nullptr};
+    /// The number of allocated bytes
+    size_type                  m_allocated{0};
+    /// The total size of the chunks
+    size_type                  m_capacity{0};
+  };
+
+  /// arena_allocator class
+  ///
+  /// A standard allocator adapter allocating from an arena.
+  /// Deallocation is a no-op: the memory is reclaimed when the arena
+  /// is reset, so containers using this allocator must not be used
+  /// after the arena reset. Can be used as buffer allocator to get
+  /// record buffers from the same arena as the decoded objects.
+  template <typename T>
+  class arena_allocator {
+  public:
+    // traits
+    typedef T                       value_type;
+    typedef std::size_t             size_type;
+    typedef std::ptrdiff_t          difference_type;
+
+    template <typename U>
+    struct rebind {
+      typedef arena_allocator<U> other;
+    };
+
+  public:
+    /// Constructor with arena
+    inline arena_allocator(arena &a) noexcept :
+      m_arena(&a) {
+      /* nop */
+    }
+
+    /// Converting constructor
+    template <typename U>
+    inline arena_allocator(const arena_allocator<U> &rhs) noexcept :
+      m_arena(rhs.get_arena()) {
+      /* nop */
+    }
+
+    /// Allocate 'n' objects in the arena
+    inline value_type *allocate(size_type n) {
+      return static_cast<value_type*>(m_arena->allocate(n*sizeof(value_type), alignof(value_type)));
+    }
+
+    /// No-op. See class description
+    inline void deallocate(value_type *, size_type) noexcept {
+      /* nop */
+    }
+
+    /// Get the arena
+    inline arena *get_arena() const noexcept {
+      return m_arena;
+    }
+
+    /// Equality operator
+    template <typename U>
+    inline friend bool operator==(const arena_allocator<T> &lhs, const arena_allocator<U> &rhs) noexcept {
+      return (lhs.get_arena() == rhs.get_arena());
+    }
+
+    /// Inequality operator
+    template <typename U>
+    inline friend bool operator!=(const arena_allocator<T> &lhs, const arena_allocator<U> &rhs) noexcept {
+      return not (lhs == rhs);
+    }
+
+  private:
+    /// The arena to allocate from
+    arena                     *m_arena{nullptr};
+  };
+}
+
+#include <accio/details/arena_impl.h>
+
+#endif  //  ACCIO_ARENA_H
@@ -0,0 +1,65 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_BITPACK_H
+#define ACCIO_BITPACK_H 1
+
+// -- std headers
+#include <cstddef>
+#include <cstdint>
+
+namespace accio {
+
+  /// Bit packing of unsigned integers.
+  ///
+  /// Values are packed by blocks of at most block_size values in 32 bit
+  /// words, 'bits' bits per value. Blocks of block_size values of at most
+  /// 32 bits are packed in 4 interleaved lanes: value k is stored in lane
+  /// k % 4, the words of a lane being every 4th word of the block. All the
+  /// lanes have the same bit offsets, so that a full block is unpacked with
+  /// SIMD shifts and masks. Shorter blocks and 64 bit values are packed
+  /// contiguously, from the least significant bit of the first word.
+  /// A block of n values always uses words(n, bits) words.
+  struct bitpack {
+    typedef std::size_t             size_type;
+    typedef std::uint32_t           word_type;
+
+    /// The maximum number of values in a block
+    static constexpr size_type block_size = 128;
+
+    /// The number of words needed to pack 'count' values of 'bits' bits
+    static constexpr size_type words(size_type count, unsigned int bits) noexcept {
+      return (count*bits + 31) / 32;
+    }
+
+    /// The number of bits needed to store a value
+    static unsigned int width(std::uint64_t value) noexcept;
+
+    /// Pack a block of 'count' (<= block_size) values of 'bits' (<= 32) bits
+    static void pack(const std::uint32_t *values, size_type count, unsigned int bits, word_type *words) noexcept;
+
+    /// Pack a block of 'count' (<= block_size) values of 'bits' (<= 64) bits
+    static void pack(const std::uint64_t *values, size_type count, unsigned int bits, word_type *words) noexcept;
+
+    /// Unpack a block of 'count' values of 'bits' (<= 32) bits, using
+    /// the SIMD implementation when available
+    static void unpack(const word_type *words, size_type count, unsigned int bits, std::uint32_t *values) noexcept;
+
+    /// Unpack a block of 'count' values of 'bits' (<= 32) bits in software
+    static void unpack_scalar(const word_type *words, size_type count, unsigned int bits, std::uint32_t *values) noexcept;
+
+    /// Unpack a block of 'count' values of 'bits' (<= 64) bits
+    static void unpack(const word_type *words, size_type count, unsigned int bits, std::uint64_t *values) noexcept;
+  };
+}
+
+#include <accio/details/bitpack_impl.h>
+
+#endif  //  ACCIO_BITPACK_H
@@ -12,15 +12,21 @@
 #define ACCIO_BUFFER_H 1
 
 // -- std headers
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <cstring>
 #include <limits>
 #include <iostream>
+#include <stdexcept>
 #include <type_traits>
+#include <vector>
+#include <array>
 
 // -- fio headers
 #include <accio/definitions.h>
 #include <accio/copy.h>
+#include <accio/mantissa.h>
 
 namespace accio {
 
@@ -59,6 +65,76 @@ namespace accio {
     size_type          m_size{0};
   };
 
+  /// array_view class
+  ///
+  /// A non-owning const typed view on an array stored in a buffer.
+  /// The view is only valid as long as the underlying buffer is
+  /// alive and not modified.
+  template <typename T>
+  class array_view {
+  public:
+    // traits
+    typedef T                       value_type;
+    typedef std::size_t             size_type;
+    typedef const T*                const_iterator;
+
+  public:
+    /// Default constructor (empty view)
+    array_view() = default;
+
+    /// Constructor with array and number of elements
+    inline array_view(const value_type *data, size_type count) :
+      m_data(data),
+      m_size(count) {
+      /* nop */
+    }
+
+    /// Pointer access function
+    inline const value_type *data() const noexcept {
+      return m_data;
+    }
+
+    /// Number of elements in the view
+    inline size_type size() const noexcept {
+      return m_size;
+    }
+
+    /// Whether the view is empty
+    inline bool empty() const noexcept {
+      return (0 == m_size);
+    }
+
+    /// Iterator to the first element
+    inline const_iterator begin() const noexcept {
+      return m_data;
+    }
+
+    /// Iterator past the last element
+    inline const_iterator end() const noexcept {
+      return m_data + m_size;
+    }
+
+    /// Operator 'at' (no bound check)
+    inline const value_type &operator[](size_type pos) const noexcept {
+      return m_data[pos];
+    }
+
+    /// Get an element at a specific position.
+    /// Throw out_of_range exception if not in view range
+    inline const value_type &at(size_type pos) const {
+      if(pos >= m_size) {
+        throw std::out_of_range("accio::array_view::at: out of range");
+      }
+      return m_data[pos];
+    }
+
+  private:
+    /// The raw array pointer
+    const value_type  *m_data{nullptr};
+    /// The number of elements
+    size_type          m_size{0};
+  };
+
   /// buffer class
   ///
   /// Main interface to write/read to/from a memory buffer.
@@ -66,12 +142,13 @@ namespace accio {
   /// in a specific endianess. Default value is copy::standard,
   /// meaning that the byte ordering is conserved. To target
   /// big endian, use copy::big_endian and copy::little_endian
-  /// for little endian copy.
+  /// for little endian copy. When reading data written in the
+  /// opposite byte order (see set_byte_swap()), the bytes are
+  /// swapped on read only: the writer never pays for the conversion.
   template <class charT,
             class copy = copy::standard,
             class alloc = std::allocator<charT>>
   class buffer {
-    buffer() = delete;
     buffer(const buffer&) = delete;
     buffer& operator=(const buffer&) = delete;
 
@@ -99,25 +176,32 @@ namespace accio {
   public:
     /// Allocate a buffer in write mode
     template <class = typename std::enable_if<sizeof(charT)==1,charT>::type>
-    buffer(size_type size = default_size);
+    buffer(size_type size = default_size, const allocator_type &allocator = allocator_type());
 
-    /// Adopt/copy the buffer and set the buffer in read mode
+    /// Adopt/copy the buffer and set the buffer in read mode.
+    /// An adopted buffer is released with the buffer allocator
+    /// and thus must have been allocated with it
     template <class = typename std::enable_if<sizeof(charT)==1,charT>::type>
-    buffer(char_type *bytes, size_type size, bool cpy = false);
+    buffer(char_type *bytes, size_type size, bool cpy = false, const allocator_type &allocator = allocator_type());
 
     /// Read n bytes from the file handle and set the buffer in read mode
     template <class = typename std::enable_if<sizeof(charT)==1,charT>::type>
-    buffer(FILE *file, size_type size);
+    buffer(FILE *file, size_type size, const allocator_type &allocator = allocator_type());
 
     /// Move constructor
     buffer(buffer<charT, copy, alloc> &&rhs);
 
-    /// Destructor. Always call delete on char buffer
+    /// Destructor. Release the char buffer with the allocator
     ~buffer();
 
     /// Move assignment operator
     buffer<charT, copy, alloc> &&operator=(buffer<charT, copy, alloc> &&rhs);
 
+    /// Reset the buffer to 'size' bytes in the given mode (in or out).
+    /// The memory is re-used if the buffer is large enough in memory.
+    /// The buffer content is undefined and the position is set at beginning
+    void reset(size_type size, open_mode md);
+
     /// Get the buffer size
     inline size_type size() const noexcept {
       return m_size;
@@ -128,6 +212,45 @@ namespace accio {
       return m_memsize;
     }
 
+    /// Get the buffer allocator
+    inline const allocator_type &get_allocator() const noexcept {
+      return m_allocator;
+    }
+
+    /// Whether the data read are in the opposite byte order
+    /// of what the copy policy expects
+    inline bool byte_swap() const noexcept {
+      return m_swap;
+    }
+
+    /// Set whether the data read are in the opposite byte order of what
+    /// the copy policy expects. The stream sets it from the file header
+    inline void set_byte_swap(bool swap) noexcept {
+      m_swap = swap;
+    }
+
+    /// Get the number of low mantissa bits zeroed when writing float values
+    inline unsigned int float_truncation() const noexcept {
+      return m_float_truncation;
+    }
+
+    /// Get the number of low mantissa bits zeroed when writing double values
+    inline unsigned int double_truncation() const noexcept {
+      return m_double_truncation;
+    }
+
+    /// Set the number of low mantissa bits zeroed when writing float and
+    /// double values, before the copy policy (lossy, see mantissa). Values
+    /// carrying less significant bits than their type become much more
+    /// compressible. Resets the truncation error
+    void set_truncation(unsigned int float_bits, unsigned int double_bits = 0) noexcept;
+
+    /// Get the maximum relative error introduced by the mantissa
+    /// truncation since the last call to set_truncation()
+    inline double truncation_error() const noexcept {
+      return m_truncation_error;
+    }
+
     /// Get the distance between the current buffer position
     /// and the end of the buffer
     inline size_type remaining() const noexcept {
@@ -155,28 +278,80 @@ namespace accio {
     /// Returns the number of char added
     size_type expand(size_type len);
 
+    /// Make sure that 'len' bytes can be written from the current
+    /// position without expanding the buffer.
+    /// Returns false if the buffer couldn't be expanded
+    bool reserve(size_type len);
+
     /// Read a bunch of data.
     /// Returns the size of actual read data
     /// Returns 0 if not in read mode
     size_type read(char_type *data, size_type memlen, size_type count);
 
-    /// Write a bunch of data.
+    /// Write a bunch of data. The bytes are copied as is: the mantissa
+    /// truncation only applies to the typed write_data() overloads.
     /// Returns the size of actual written data
     /// Returns 0 if not in write mode
     size_type write(const char_type *data, size_type memlen, size_type count);
 
-    /// Write a bunch of data, either a single value or array
+    /// Write a bunch of data, either a single value or array.
+    /// The data are converted by the copy policy using copy_unit<T>
     template <typename T>
     inline size_type write_data(const T &data, size_type len = 1) noexcept {
-      return write(reinterpret_cast<const char_type*>(&data), sizeof(T), len);
+      typedef typename copy_unit<T>::type unit_type;
+      const size_type count = len*(sizeof(T)/sizeof(unit_type));
+      if((0 == count) or not check_mode(std::ios_base::out) or not reserve(io::padded_size(sizeof(unit_type), count))) {
+        return 0;
+      }
+      return write_units(reinterpret_cast<const unit_type*>(&data), count);
     }
 
-    /// Read a bunch of data, either a single value or array
+    /// Read a bunch of data, either a single value or array.
+    /// The data are converted by the copy policy using copy_unit<T>
     template <typename T>
     inline size_type read_data(T &data, size_type len = 1) noexcept {
-      return read(reinterpret_cast<char_type*>(&data), sizeof(T), len);
+      typedef typename copy_unit<T>::type unit_type;
+      return read(reinterpret_cast<char_type*>(&data), sizeof(unit_type), len*(sizeof(T)/sizeof(unit_type)));
+    }
+
+    /// Write a fixed size array in one go. An empty array writes nothing
+    template <typename T, std::size_t N>
+    inline size_type write_data(const std::array<T, N> &data) noexcept {
+      return (0 == N) ? 0 : write_data(*data.data(), N);
+    }
+
+    /// Read a fixed size array in one go. An empty array reads nothing
+    template <typename T, std::size_t N>
+    inline size_type read_data(std::array<T, N> &data) noexcept {
+      return (0 == N) ? 0 : read_data(*data.data(), N);
     }
 
+    /// Write a vector of trivially copyable data, prefixed by its length.
+    /// The buffer capacity is checked once for the whole vector. The
+    /// length is stored on 32 bits: longer vectors are not written
+    template <typename T, typename A>
+    size_type write_data(const std::vector<T, A> &data);
+
+    /// Read a vector of trivially copyable data written with the
+    /// overload above. The vector is resized once to the stored length
+    template <typename T, typename A>
+    size_type read_data(std::vector<T, A> &data);
+
+    /// Get a typed view on an array of 'count' elements stored at
+    /// the current position, without copying the data.
+    /// This is only possible if the copy policy preserves the byte
+    /// ordering and if the current position is aligned for T.
+    /// Returns the size of read data, as for read(), or 0 if a view
+    /// can't be provided. In this case, the buffer position is left
+    /// untouched and the data can still be copied with read_data()
+    template <typename T>
+    size_type read_view(array_view<T> &view, size_type count) noexcept;
+
+    /// Get a typed view on a length prefixed array, as written by
+    /// write_data(const std::vector<T, A>&). See above for conditions
+    template <typename T>
+    size_type read_view(array_view<T> &view) noexcept;
+
     /// Write an address
     size_type write_pointer(const address_type *addr);
 
@@ -266,6 +441,42 @@ namespace accio {
     bool relocate();
 
   private:
+    /// Check the buffer state before an io operation in the specified mode
+    bool check_mode(open_mode md) noexcept;
+
+    /// Read data and move the current position. No check performed
+    size_type read_unchecked(char_type *data, size_type memlen, size_type count) noexcept;
+
+    /// Write data and move the current position. No check performed
+    size_type write_unchecked(const char_type *data, size_type memlen, size_type count) noexcept;
+
+    /// Write copy units and move the current position, truncating the
+    /// mantissas of float and double values. No check performed
+    template <typename U>
+    inline size_type write_units(const U *data, size_type count) noexcept {
+      return write_units(data, count, std::integral_constant<bool, std::is_same<U, float>::value or std::is_same<U, double>::value>());
+    }
+
+    template <typename U>
+    inline size_type write_units(const U *data, size_type count, std::false_type) noexcept {
+      return write_unchecked(reinterpret_cast<const char_type*>(data), sizeof(U), count);
+    }
+
+    template <typename F>
+    size_type write_units(const F *data, size_type count, std::true_type) noexcept;
+
+    /// The number of mantissa bits zeroed when writing float and double values
+    inline unsigned int truncation(const float*) const noexcept {
+      return m_float_truncation;
+    }
+
+    inline unsigned int truncation(const double*) const noexcept {
+      return m_double_truncation;
+    }
+
+  private:
+    /// The buffer allocator
+    allocator_type             m_allocator;
     /// The buffer open mode
     open_mode                  m_mode{std::ios_base::out};
     /// The buffer io state
@@ -278,6 +489,14 @@ namespace accio {
     char_type*                 m_buffer{nullptr};
     /// The current read/write position in the buffer
     char_type*                 m_current{nullptr};
+    /// Whether the bytes of the data read must be swapped
+    bool                       m_swap{false};
+    /// The number of low mantissa bits zeroed when writing float values
+    unsigned int               m_float_truncation{0};
+    /// The number of low mantissa bits zeroed when writing double values
+    unsigned int               m_double_truncation{0};
+    /// The maximum relative error introduced by the mantissa truncation
+    double                     m_truncation_error{0.};
     /// The map of pointers 'pointed at'
     pointed_at                 m_pointed_at{};
     /// The map of pointers 'pointer to'
@@ -0,0 +1,112 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_CHECKSUM_H
+#define ACCIO_CHECKSUM_H 1
+
+// -- std headers
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace accio {
+
+  /// CRC32C (Castagnoli) checksum computation.
+  ///
+  /// Uses the SSE4.2 crc32 instruction when available at runtime
+  /// and a software (slicing by 8) implementation otherwise.
+  /// The crc argument allows to compute a checksum in several steps:
+  ///   auto crc = checksum::crc32c(data1, len1);
+  ///   crc = checksum::crc32c(data2, len2, crc);
+  struct checksum {
+    typedef std::uint32_t           value_type;
+    typedef std::size_t             size_type;
+
+    /// Compute the CRC32C of 'len' bytes, using the fastest implementation
+    static value_type crc32c(const void *data, size_type len, value_type crc = 0) noexcept;
+
+    /// Compute the CRC32C of 'len' bytes in software
+    static value_type crc32c_software(const void *data, size_type len, value_type crc = 0) noexcept;
+
+    /// Compute the CRC32C of 'len' bytes with the SSE4.2 crc32 instruction.
+    /// Must only be called if hardware_available() returns true
+    static value_type crc32c_hardware(const void *data, size_type len, value_type crc = 0) noexcept;
+
+    /// Whether the crc32 instruction is supported by the cpu
+    static bool hardware_available() noexcept;
+  };
+
+  /// checksum_worker class
+  ///
+  /// Compute checksums on a worker thread, off the critical path.
+  /// Only one computation is pending at a time: submitting a new
+  /// one waits for the previous one to complete. The memory passed
+  /// to submit() must stay untouched until wait() is called. With a
+  /// single hardware thread, the checksum is computed by submit()
+  class checksum_worker {
+  public:
+    typedef checksum::value_type    value_type;
+    typedef checksum::size_type     size_type;
+
+  public:
+    checksum_worker() = default;
+    checksum_worker(const checksum_worker&) = delete;
+    checksum_worker& operator=(const checksum_worker&) = delete;
+
+    /// Destructor. Stop the worker thread
+    ~checksum_worker();
+
+    /// Submit the computation of the checksum of 'len' bytes,
+    /// starting from the 'crc' value
+    void submit(const void *data, size_type len, value_type crc = 0);
+
+    /// Wait for the last submitted computation and get its result
+    value_type wait();
+
+    /// Whether running the worker can overlap with the caller thread
+    /// (i.e the machine has more than one hardware thread)
+    static bool concurrent() noexcept;
+
+    /// Whether a computation has been submitted and not yet collected by wait()
+    inline bool pending() const noexcept {
+      return m_submitted;
+    }
+
+  private:
+    /// The worker thread main loop
+    void run();
+
+  private:
+    /// The worker thread, started on first submission
+    std::thread                 m_thread{};
+    /// The mutex protecting the fields below
+    std::mutex                  m_mutex{};
+    /// The condition variable to signal job submission and completion
+    std::condition_variable     m_condition{};
+    /// The data to process
+    const void                 *m_data{nullptr};
+    /// The length of data to process
+    size_type                   m_len{0};
+    /// The initial crc value, replaced by the result
+    value_type                  m_crc{0};
+    /// Whether a computation is running
+    bool                        m_running{false};
+    /// Whether the worker must stop
+    bool                        m_stop{false};
+    /// Whether a computation has been submitted (accessed by the caller thread only)
+    bool                        m_submitted{false};
+  };
+}
+
+#include <accio/details/checksum_impl.h>
+
+#endif  //  ACCIO_CHECKSUM_H
@@ -0,0 +1,117 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_COMPRESSION_H
+#define ACCIO_COMPRESSION_H 1
+
+// -- std headers
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// -- zlib headers
+#include <zlib.h>
+
+namespace accio {
+
+  /// compressor class
+  ///
+  /// Compress record payloads with zlib, in raw deflate format: the record
+  /// checksum already protects the payload, the zlib header and adler32
+  /// trailer are not written. The deflate state and the output memory are
+  /// kept across records, the state being only reset between records.
+  /// Small records with a common structure compress much better with a
+  /// preset dictionary: content the payloads are likely to repeat,
+  /// referenced by the deflate matches as if it preceded each payload
+  class compressor {
+  public:
+    typedef std::size_t                              size_type;
+    typedef std::vector<unsigned char>               dictionary_type;
+
+    /// The maximum compression level
+    static constexpr int max_level = 9;
+    /// The maximum useful dictionary size: the deflate window
+    static constexpr size_type max_dictionary_size = 32*1024;
+    /// The maximum deflate compression ratio: a 258 bytes match in 2 bits
+    static constexpr size_type max_ratio = 1032;
+
+  public:
+    compressor() = default;
+    compressor(const compressor&) = delete;
+    compressor &operator=(const compressor&) = delete;
+    ~compressor();
+
+    /// Start the compression of a payload of 'size' bytes at 'level' (1-9),
+    /// with an optional preset dictionary. The payload is then given by
+    /// parts with update()
+    bool begin(int level, size_type size, const dictionary_type *dictionary = nullptr);
+
+    /// Compress the next 'len' bytes of the payload
+    bool update(const void *data, size_type len);
+
+    /// Finish the compression. Returns the compressed size, 0 on failure
+    size_type finish();
+
+    /// The compressed payload, valid until the next call to begin()
+    inline const unsigned char *data() const noexcept {
+      return m_output.data();
+    }
+
+    /// Build a preset dictionary of at most 'size' bytes from sample
+    /// payloads. The dictionary is made of the byte ranges found in several
+    /// samples, the most common ones last, i.e closest to the compressed
+    /// data. Returns an empty dictionary if the samples have nothing in common
+    static dictionary_type train_dictionary(const std::vector<dictionary_type> &samples, size_type size = max_dictionary_size);
+
+  private:
+    /// Make room for more output, keeping the written part
+    void grow();
+
+  private:
+    /// The zlib deflate stream
+    z_stream                     m_stream{};
+    /// Whether the deflate stream is initialized
+    bool                         m_init{false};
+    /// The level of the deflate stream
+    int                          m_level{0};
+    /// The compressed payload
+    std::vector<unsigned char>   m_output{};
+  };
+
+  /// decompressor class
+  ///
+  /// Uncompress payloads written by the compressor,
+  /// the inflate state being kept across records
+  class decompressor {
+  public:
+    typedef std::size_t             size_type;
+
+  public:
+    decompressor() = default;
+    decompressor(const decompressor&) = delete;
+    decompressor &operator=(const decompressor&) = delete;
+    ~decompressor();
+
+    /// Uncompress 'len' bytes in 'output', which must be filled exactly
+    /// with 'size' bytes, using the dictionary the payload was compressed
+    /// with. Returns false on corrupted input or size mismatch
+    bool uncompress(const void *input, size_type len, void *output, size_type size, const compressor::dictionary_type *dictionary = nullptr);
+
+  private:
+    /// The zlib inflate stream
+    z_stream                     m_stream{};
+    /// Whether the inflate stream is initialized
+    bool                         m_init{false};
+  };
+}
+
+#include <accio/details/compression_impl.h>
+
+#endif  //  ACCIO_COMPRESSION_H
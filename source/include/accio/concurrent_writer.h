@@ -0,0 +1,198 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_CONCURRENT_WRITER_H
+#define ACCIO_CONCURRENT_WRITER_H 1
+
+// -- std headers
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <accio/writer.h>
+#include <accio/mpsc_queue.h>
+
+namespace accio {
+
+  /// A serialized record waiting to be written
+  template <class config>
+  struct pending_record : public mpsc_node {
+    typedef typename file_writer<config>::buffer_type    buffer_type;
+    typedef typename file_writer<config>::block_writers  block_writers;
+
+    /// The record header
+    io::record_header            m_header{};
+    /// The record summary
+    io::record_summary           m_summary{};
+    /// The record payload
+    buffer_type                  m_buffer{};
+    /// The block writers list used to serialize the record
+    block_writers                m_writers{};
+  };
+
+  /// buffer_pool class
+  ///
+  /// A bounded pool of record buffers. The buffers keep their memory
+  /// when released, so that a record is serialized without allocation
+  /// once the pool is warm. acquire() blocks when all the buffers are
+  /// in use, limiting the memory used by records waiting to be written.
+  /// acquire() and release() lock a mutex shared by all the threads,
+  /// once per record, only to take or give back a pointer: this is
+  /// small next to the record serialization, but the producers do
+  /// contend on it with small records and many threads
+  template <class config>
+  class buffer_pool {
+  public:
+    typedef pending_record<config>             value_type;
+
+  public:
+    /// Constructor with the maximum number of buffers
+    buffer_pool(std::size_t capacity);
+    buffer_pool(const buffer_pool&) = delete;
+    buffer_pool& operator=(const buffer_pool&) = delete;
+
+    /// Get a buffer, waiting for one to be released if all are in use
+    value_type *acquire();
+
+    /// Give a buffer back to the pool
+    void release(value_type *value);
+
+    /// The maximum number of buffers
+    inline std::size_t capacity() const noexcept {
+      return m_capacity;
+    }
+
+  private:
+    /// The maximum number of buffers
+    const std::size_t                             m_capacity;
+    /// All the buffers created by the pool
+    std::vector<std::unique_ptr<value_type>>      m_values{};
+    /// The buffers available
+    std::vector<value_type*>                      m_free{};
+    /// The number of threads waiting for a buffer
+    std::size_t                                   m_waiting{0};
+    /// The mutex protecting the fields above
+    std::mutex                                    m_mutex{};
+    /// The condition variable signaling a released buffer
+    std::condition_variable                       m_condition{};
+  };
+
+  /// concurrent_writer class
+  ///
+  /// A file_writer that can be used from several threads at the same time.
+  /// Each producer thread serializes its records in buffers taken from a
+  /// pool, then submits them through a lock-free queue to a single committer
+  /// thread appending them to the file. Records are written atomically, in
+  /// submission order for a given producer thread
+  template <class config>
+  class concurrent_writer {
+  public:
+    typedef file_writer<config>                        writer_type;
+    typedef typename writer_type::record_type          record_type;
+    typedef typename writer_type::record_io            record_io;
+    typedef pending_record<config>                     pending_type;
+
+    /// The default maximum number of records serialized but not written yet
+    static constexpr std::size_t default_max_pending = 64;
+
+  public:
+    /// Constructor with the maximum number of records serialized but not written yet
+    concurrent_writer(std::size_t max_pending = default_max_pending);
+    concurrent_writer(const concurrent_writer&) = delete;
+    concurrent_writer& operator=(const concurrent_writer&) = delete;
+
+    /// Destructor. Write the pending records and close the file
+    ~concurrent_writer();
+
+    /// Open a file in write mode and start the committer thread
+    error_codes::code_type open(const std::string &fname);
+
+    /// Open shard files in write mode and start the committer thread
+    error_codes::code_type open(const std::vector<std::string> &patterns);
+
+    /// Write the pending records, stop the committer thread and close the file(s).
+    /// Returns the first error met while writing, if any
+    error_codes::code_type close();
+
+    /// Set whether a checksum is written with each record. Must be called before open()
+    inline void set_checksum(bool enable) noexcept {
+      m_writer.set_checksum(enable);
+    }
+
+    /// Set the file rotation limits, see file_writer. Must be called before open()
+    inline void set_rotation(std::size_t max_size, std::size_t max_records = 0) noexcept {
+      m_writer.set_rotation(max_size, max_records);
+    }
+
+    /// The names of the files opened since open(). Not thread safe: call it after close()
+    inline const std::vector<std::string> &files() const noexcept {
+      return m_writer.files();
+    }
+
+    /// Serialize a record and submit it for writing. Thread safe.
+    /// Returns the first error met by the committer thread, if any
+    error_codes::code_type write_record(
+      const string32 &name,                // the record name to write
+      const record_io &io_config,          // the io config: record and block settings
+      const record_type &rec               // the record product to write: event, run header, etc ...
+    );
+
+    /// Serialize a record with a static schema and submit it for writing. Thread safe
+    template <typename... blocks>
+    error_codes::code_type write_record(
+      const string32 &name,                          // the record name to write
+      const record_schema<config, blocks...> &schema,  // the record layout
+      const record_type &rec                         // the record product to write
+    );
+
+  private:
+    /// Serialize a record in a pending record taken from the
+    /// pool, using the functor, and submit it to the committer
+    template <typename serializer>
+    error_codes::code_type submit(serializer serialize);
+
+    /// Start the committer thread
+    void start();
+
+    /// The committer thread main loop
+    void commit();
+
+  private:
+    /// The underlying writer, used by the committer thread only once opened
+    writer_type                               m_writer{};
+    /// The pool of record buffers
+    buffer_pool<config>                       m_pool;
+    /// The queue of records to write
+    mpsc_queue<pending_type>                  m_queue{};
+    /// The committer thread
+    std::thread                               m_committer{};
+    /// Whether the file is open
+    std::atomic<bool>                         m_open{false};
+    /// The number of records being submitted
+    std::atomic<std::size_t>                  m_submitting{0};
+    /// Whether the committer thread must stop
+    std::atomic<bool>                         m_stop{false};
+    /// Whether the committer thread is sleeping
+    std::atomic<bool>                         m_sleeping{false};
+    /// The first write error
+    std::atomic<error_codes::code_type>       m_status{error_codes::stream::success};
+    /// The mutex used to wake up the committer thread
+    std::mutex                                m_mutex{};
+    /// The condition variable used to wake up the committer thread
+    std::condition_variable                   m_condition{};
+  };
+}
+
+#include <accio/details/concurrent_writer_impl.h>
+
+#endif  //  ACCIO_CONCURRENT_WRITER_H
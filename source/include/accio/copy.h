@@ -14,14 +14,38 @@
 // -- std headers
 #include <cstring>
 
+// the host byte order, detected at compile time
+#if defined(__LITTLE_ENDIAN__) || defined(_WIN32) || \
+  (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+#define ACCIO_LITTLE_ENDIAN 1
+#endif
+
 namespace accio {
 
+  /// The unit of data converted by the copy policies when copying
+  /// an object of type T. By default, the object is converted as a
+  /// whole, which is fine for arithmetic types. Specialize it for
+  /// trivially copyable structs made of fields of the same size, e.g:
+  ///   template <> struct copy_unit<hit> { typedef float type; };
+  template <typename T>
+  struct copy_unit {
+    typedef T type;
+  };
+
+  template <typename T, std::size_t N>
+  struct copy_unit<T[N]> {
+    typedef typename copy_unit<T>::type type;
+  };
+
   struct copy {
     struct standard {
     public:
       typedef unsigned char buffer_type;
       typedef std::size_t   size_type;
 
+      /// Whether the copied data keep the plateform byte ordering
+      static constexpr bool native = true;
+
       /// The standard std::memcpy call
       /// plateform endianess -> plateform endianess
       static void memcpy(
@@ -36,6 +60,13 @@ namespace accio {
       typedef unsigned char buffer_type;
       typedef std::size_t   size_type;
 
+      /// Whether the copied data keep the plateform byte ordering
+#ifdef ACCIO_LITTLE_ENDIAN
+      static constexpr bool native = false;
+#else
+      static constexpr bool native = true;
+#endif
+
       /// Copy data to 'destination' in big endian
       /// plateform endianess -> big endian
       static void memcpy(
@@ -50,6 +81,13 @@ namespace accio {
       typedef unsigned char buffer_type;
       typedef std::size_t   size_type;
 
+      /// Whether the copied data keep the plateform byte ordering
+#ifdef ACCIO_LITTLE_ENDIAN
+      static constexpr bool native = true;
+#else
+      static constexpr bool native = false;
+#endif
+
       /// Copy data to 'destination' in little endian
       /// plateform endianess -> little endian
       static void memcpy(
@@ -58,6 +96,14 @@ namespace accio {
         size_type          size,
         size_type          count);
     };
+
+    /// Copy 'count' elements of 'size' bytes to 'destination',
+    /// reversing the bytes of each element
+    static void swap(
+      unsigned char*       destination,
+      const unsigned char* source,
+      std::size_t          size,
+      std::size_t          count);
   };
 }
 
@@ -15,6 +15,9 @@
 #include <map> // map, multimap
 #include <sys/stat.h> // stat
 #include <stdio.h>
+#if !defined(_WIN32)
+#include <fcntl.h> // posix_fadvise
+#endif
 #include <type_traits>
 #include <vector> // vector
 #include <array> // array
@@ -43,6 +46,8 @@ namespace accio {
     typedef unsigned int                            size_type;
     typedef unsigned int                            marker_type;
     typedef unsigned int                            version_type;
+    typedef std::uint64_t                           size64_type;
+    typedef std::int64_t                            offset_type;
 
   public:
     /// Cast any pointer to a certain char type
@@ -72,6 +77,8 @@ namespace accio {
       static constexpr code_type success          = 0x08020001;
       static constexpr code_type not_found        = 0x08020014;
       static constexpr code_type skip             = 0x08020024;
+      static constexpr code_type dup_reader       = 0x08020034;
+      static constexpr code_type bad_fields       = 0x08020044;
     };
     struct stream {
       static constexpr code_type facility         = 0x08000000;
@@ -92,6 +99,10 @@ namespace accio {
       static constexpr code_type eof              = 0x080000e4;
       static constexpr code_type no_record_marker = 0x080000f4;
       static constexpr code_type bad_compress     = 0x08000104;
+      static constexpr code_type bad_checksum     = 0x08000114;
+      static constexpr code_type bad_pattern      = 0x08000124;
+      static constexpr code_type bad_header       = 0x08000134;
+      static constexpr code_type bad_byte_order   = 0x08000144;
     };
   };
 
@@ -100,17 +111,17 @@ namespace accio {
     typedef types::version_type      version_type;
 
     /// Encode major and minor version in a single version variable
-    static inline version_type encode(version_type maj, version_type min) noexcept {
+    static constexpr version_type encode(version_type maj, version_type min) noexcept {
       return (((maj) << 16) + (min));
     }
 
     /// Decode the major version from the full version variable
-    static inline version_type decode_major(version_type version) noexcept {
+    static constexpr version_type decode_major(version_type version) noexcept {
       return (((version) & 0xffff0000) >> 16);
     }
 
     /// Decode the minor version from the full version variable
-    static inline version_type decode_minor(version_type version) noexcept {
+    static constexpr version_type decode_minor(version_type version) noexcept {
       return ((version) & 0x0000ffff);
     }
   };
@@ -121,6 +132,149 @@ namespace accio {
       static constexpr types::marker_type align  = 0x00000003;
       static constexpr types::marker_type record = 0xabadcafe;
       static constexpr types::marker_type block  = 0xdeadbeef;
+      static constexpr types::marker_type file   = 0xacc10f11;
+      /// Written as is to detect the byte order of a file
+      static constexpr types::marker_type byte_order = 0x01020304;
+    };
+
+    /// The version of the file format written by this library
+    static constexpr types::version_type format_version = version::encode(1, 0);
+
+    /// Reverse the byte order of a 32 bit word
+    static constexpr std::uint32_t byte_swap(std::uint32_t word) noexcept {
+      return (word >> 24) | ((word >> 8) & 0x0000ff00) | ((word << 8) & 0x00ff0000) | (word << 24);
+    }
+
+    /// Reverse the byte order of a 64 bit word
+    static constexpr std::uint64_t byte_swap(std::uint64_t word) noexcept {
+      return (static_cast<std::uint64_t>(byte_swap(static_cast<std::uint32_t>(word))) << 32) |
+        byte_swap(static_cast<std::uint32_t>(word >> 32));
+    }
+
+    /// Record option word flags
+    struct option {
+      /// The record compression level mask
+      static constexpr types::option_word compression = 0x0000000f;
+      /// The record holds a CRC32C checksum of its summary and payload
+      static constexpr types::option_word checksum    = 0x00000010;
+      /// The record and block sizes are stored on 64 bits
+      static constexpr types::option_word size64      = 0x00000020;
+      /// The block filter words are stored after the block summaries
+      static constexpr types::option_word filters     = 0x00000040;
+      /// The record holds a preset compression dictionary
+      static constexpr types::option_word dictionary_record = 0x00000080;
+      /// The id (1-255) of the preset dictionary the record is compressed
+      /// with, or of the dictionary it holds (see dictionary_id())
+      static constexpr types::option_word dictionary  = 0x0000ff00;
+      /// The record holds a group of records, compressed together
+      static constexpr types::option_word group       = 0x00010000;
+    };
+
+    /// File feature flags: the features used by the records of a file
+    struct feature {
+      /// Some records hold a checksum
+      static constexpr types::option_word checksum    = 0x00000001;
+      /// Some records use 64 bit sizes
+      static constexpr types::option_word size64      = 0x00000002;
+      /// Some records are compressed
+      static constexpr types::option_word compression = 0x00000004;
+      /// Some blocks are filtered before the record compression
+      static constexpr types::option_word filters     = 0x00000008;
+      /// Some records are compressed with a preset dictionary
+      static constexpr types::option_word dictionary  = 0x00000010;
+      /// Some records are written in record groups
+      static constexpr types::option_word groups      = 0x00000020;
+    };
+
+    /// Get the preset dictionary id from a record option word
+    static constexpr types::option_word dictionary_id(types::option_word options) noexcept {
+      return (options & option::dictionary) >> 8;
+    }
+
+    /// The name of the records holding a preset dictionary. These records
+    /// are read by the stream and not returned to the caller
+    static inline const string32 &dictionary_name() {
+      static const string32 name("accio::dictionary");
+      return name;
+    }
+
+    /// The name of the records holding a group of records. The group
+    /// summary has a single block of type "accio::group", named "records",
+    /// spanning the group payload: the grouped record entries one after the
+    /// other. An entry is made of a disk_record_header (32 bit sizes), the
+    /// number of blocks, the disk block summaries and the payload padded
+    /// to 4 bytes
+    static inline const string32 &group_name() {
+      static const string32 name("accio::group");
+      return name;
+    }
+
+    /// The group offset of the records written on their own
+    static constexpr types::size64_type ungrouped = 0xffffffffffffffffULL;
+
+    /// The position of a record in a file (see stream::build_index())
+    struct record_position {
+      /// The offset of the record header in the file, or of the
+      /// header of the group holding the record
+      types::offset_type      m_offset{0};
+      /// The offset of the record entry in the uncompressed group
+      /// payload, ungrouped for records written on their own
+      types::size64_type      m_group_offset{ungrouped};
+    };
+
+    /// Block filter word: a reversible transform applied to the block
+    /// payload before the record compression (see shuffle), with the
+    /// size in bytes of the array elements the block is made of
+    struct filter {
+      /// The block is compressed as is
+      static constexpr types::option_word none         = 0x00000000;
+      /// The bytes of the elements are grouped by significance
+      static constexpr types::option_word byte_shuffle = 0x00000001;
+      /// The bits of the elements are grouped by significance
+      static constexpr types::option_word bit_shuffle  = 0x00000002;
+      /// The filter type mask
+      static constexpr types::option_word type_mask    = 0x000000ff;
+
+      /// Build a filter word from a filter type and an element size
+      static constexpr types::option_word encode(types::option_word type, types::option_word element) noexcept {
+        return type | (element << 8);
+      }
+
+      /// Decode the filter type from a filter word
+      static constexpr types::option_word type(types::option_word word) noexcept {
+        return word & type_mask;
+      }
+
+      /// Decode the element size from a filter word
+      static constexpr types::option_word element(types::option_word word) noexcept {
+        return word >> 8;
+      }
+    };
+
+    /// Get the file features used by a record from its option word
+    static inline types::option_word record_features(types::option_word options) noexcept {
+      return ((0 != (options & option::checksum)) ? feature::checksum : 0) |
+        ((0 != (options & option::size64)) ? feature::size64 : 0) |
+        ((0 != (options & option::compression)) ? feature::compression : 0) |
+        ((0 != (options & option::filters)) ? feature::filters : 0) |
+        ((0 != (options & option::dictionary)) ? feature::dictionary : 0) |
+        ((0 != (options & option::group)) ? feature::groups : 0);
+    }
+
+    /// How record checksums are verified on read
+    enum class verify_mode {
+      none,     ///< checksums are not verified
+      sync,     ///< checksums are verified when reading the record
+      async     ///< checksums are verified on a worker thread
+    };
+
+    /// How a file opened in read mode is accessed. The kernel is told
+    /// so, to tune its readahead and page cache usage
+    enum class access_mode {
+      normal,       ///< no hint given
+      sequential,   ///< the records are read in order: the next records are read ahead
+      streaming,    ///< sequential, and the pages read are dropped from the page cache
+      random        ///< the records are read in random order (see stream::seek_record()): no readahead
     };
 
     enum class open_state {
@@ -148,8 +302,10 @@ namespace accio {
       return modestr;
     }
 
-    static inline types::size_type padded_size(types::size_type size, types::size_type count) noexcept {
-      return (size*count + 3) & 0xfffffffc;
+    /// The size of 'count' values of 'size' bytes, padded to 4 bytes.
+    /// Computed on std::size_t: arrays of 4 GB and more don't wrap
+    static inline std::size_t padded_size(std::size_t size, std::size_t count) noexcept {
+      return (size*count + 3) & ~static_cast<std::size_t>(3);
     }
 
     struct file {
@@ -158,12 +314,20 @@ namespace accio {
         return fopen(filename, mode);
       }
 
-      static inline long tell(FILE *stream) {
-        return ftell(stream);
+      static inline types::offset_type tell(FILE *stream) {
+#if defined(_WIN32)
+        return _ftelli64(stream);
+#else
+        return ftello(stream);
+#endif
       }
 
-      static inline int seek(FILE *stream, long offset, int origin) {
-        return fseek(stream, offset, origin);
+      static inline int seek(FILE *stream, types::offset_type offset, int origin) {
+#if defined(_WIN32)
+        return _fseeki64(stream, offset, origin);
+#else
+        return fseeko(stream, static_cast<off_t>(offset), origin);
+#endif
       }
 
       static inline int close(FILE *stream) {
@@ -185,17 +349,81 @@ namespace accio {
       static inline int stat(const char *path, struct stat *buf) {
         return ::stat(path, buf);
       }
+
+      /// The size of an open file, -1 on failure
+      static inline types::offset_type size(FILE *stream) {
+#if defined(_WIN32)
+        struct _stat64 st;
+        if(0 != _fstat64(_fileno(stream), &st)) {
+          return -1;
+        }
+#else
+        struct stat st;
+        if(0 != fstat(fileno(stream), &st)) {
+          return -1;
+        }
+#endif
+        return static_cast<types::offset_type>(st.st_size);
+      }
+
+      /// Page cache hints on a byte range of a file ('len' 0: up to the end)
+      enum class advice {
+        normal,
+        sequential,
+        random,
+        will_need,
+        dont_need
+      };
+
+      /// Give a page cache hint to the kernel. No-op where
+      /// posix_fadvise is not available
+      static inline int advise(FILE *stream, types::offset_type offset, types::offset_type len, advice adv) {
+#if defined(POSIX_FADV_NORMAL)
+        int flag = POSIX_FADV_NORMAL;
+        switch(adv) {
+          case advice::sequential: flag = POSIX_FADV_SEQUENTIAL; break;
+          case advice::random:     flag = POSIX_FADV_RANDOM; break;
+          case advice::will_need:  flag = POSIX_FADV_WILLNEED; break;
+          case advice::dont_need:  flag = POSIX_FADV_DONTNEED; break;
+          default: break;
+        }
+        return posix_fadvise(fileno(stream), static_cast<off_t>(offset), static_cast<off_t>(len), flag);
+#else
+        (void)stream; (void)offset; (void)len; (void)adv;
+        return 0;
+#endif
+      }
+    };
+
+    /// The file header, written as is at the beginning of a file.
+    /// Files written by older versions start directly with a record
+    struct file_header {
+      /// The file marker
+      types::marker_type      m_marker;
+      /// The format version (see version::encode)
+      types::version_type     m_version;
+      /// The size of this header in the file
+      types::size_type        m_size;
+      /// marker::byte_order, in the byte order of the record headers
+      types::marker_type      m_byte_order;
+      /// marker::byte_order, in the byte order of the record payloads
+      /// (i.e copied with the copy policy of the writer)
+      types::marker_type      m_data_order;
+      /// The features used by the records (see feature), set when a
+      /// file opened with open_mode::write_new is closed
+      types::option_word      m_features;
     };
 
+    /// The record header
     struct record_header {
       /// The record marker
       types::marker_type      m_marker;
-      /// The record option word (compression level)
+      /// The record option word (compression level and flags, see option)
       types::option_word      m_options;
       /// The total record compressed size
-      types::size_type        m_compsize;
+      types::size64_type      m_compsize;
       /// The total record un-compressed size
-      types::size_type        m_uncompsize;
+      types::size64_type      m_uncompsize;
       /// The record name
       string32                m_name;
     };
@@ -204,14 +432,79 @@ namespace accio {
       /// The block version
       types::version_type     m_version;
       /// The block size
-      types::size_type        m_size;
+      types::size64_type      m_size;
       /// The block type
       string64                m_type;
       /// The block name
       string64                m_name;
+      /// The block filter (see filter), applied if the record is compressed
+      types::option_word      m_filter{filter::none};
     };
 
     typedef std::vector<block_summary>      record_summary;
+
+    /// The record header as written in files, with 32 bit sizes.
+    /// A record is made of:
+    ///  - the record header
+    ///  - option::size64: the 64 bit compressed and uncompressed sizes
+    ///  - the number of blocks and the block summaries
+    ///  - option::size64: the 64 bit block sizes
+    ///  - option::filters: the block filter words
+    ///  - the record payload, compressed at the option::compression
+    ///    level (raw deflate), padded to 4 bytes
+    ///  - option::checksum: the record checksum (4 bytes)
+    /// With option::size64, the 32 bit sizes are set to size32_max
+    struct disk_record_header {
+      types::marker_type      m_marker;
+      types::option_word      m_options;
+      types::size_type        m_compsize;
+      types::size_type        m_uncompsize;
+      string32                m_name;
+    };
+
+    /// The block summary as written in files, with 32 bit size
+    struct disk_block_summary {
+      types::version_type     m_version;
+      types::size_type        m_size;
+      string64                m_type;
+      string64                m_name;
+    };
+
+    /// The maximum size stored in the 32 bit layout
+    static constexpr types::size64_type size32_max = 0xffffffff;
+
+    /// Whether the record sizes must be stored on 64 bits
+    static inline bool is_size64(const record_header &header) noexcept {
+      return (0 != (header.m_options & option::size64)) or
+        (header.m_compsize >= size32_max) or (header.m_uncompsize >= size32_max);
+    }
+
+    /// The size in files of the record header, with the 64 bit sizes
+    static inline types::size64_type header_size(const record_header &header) noexcept {
+      return sizeof(disk_record_header) + (is_size64(header) ? 2*sizeof(types::size64_type) : 0);
+    }
+
+    /// The size in files of 'nblocks' block summaries
+    static inline types::size64_type summary_size(const record_header &header, types::size_type nblocks) noexcept {
+      return static_cast<types::size64_type>(nblocks)*(sizeof(disk_block_summary) +
+        (is_size64(header) ? sizeof(types::size64_type) : 0) +
+        ((0 != (header.m_options & option::filters)) ? sizeof(types::option_word) : 0));
+    }
+
+    /// The size in files of the padded record payload and the checksum
+    static inline types::size64_type payload_size(const record_header &header) noexcept {
+      types::size64_type size = (header.m_compsize + 3) & ~static_cast<types::size64_type>(3);
+      if(0 != (header.m_options & option::checksum)) {
+        size += sizeof(std::uint32_t);
+      }
+      return size;
+    }
+
+    /// The total size of a record in a file: header, summary,
+    /// padded payload and optional checksum
+    static inline types::size64_type record_size(const record_header &header, types::size_type nblocks) noexcept {
+      return header_size(header) + sizeof(types::size_type) + summary_size(header, nblocks) + payload_size(header);
+    }
   };
 
 
@@ -0,0 +1,126 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_DESCRIPTOR_H
+#define ACCIO_DESCRIPTOR_H 1
+
+// -- std headers
+#include <tuple>
+#include <type_traits>
+
+#include <accio/definitions.h>
+#include <accio/buffer.h>
+#include <accio/writer.h>
+#include <accio/reader.h>
+
+namespace accio {
+
+  /// The field descriptor of a struct. Specialize it to declare the
+  /// fields of a struct once, in the order they are stored:
+  ///   template <> struct descriptor<hit> {
+  ///     static constexpr auto fields() {
+  ///       return make_fields(&hit::m_x, &hit::m_y, &hit::m_energies);
+  ///     }
+  ///   };
+  /// The fields can be trivially copyable types, vectors of trivially
+  /// copyable types or described structs
+  template <typename T>
+  struct descriptor {};
+
+  /// Build the field list of a descriptor from member pointers
+  template <typename T, typename... F>
+  constexpr std::tuple<F T::*...> make_fields(F T::*... fields) {
+    return std::tuple<F T::*...>(fields...);
+  }
+
+  /// Whether a type has a field descriptor
+  template <typename T, typename = void>
+  struct has_descriptor : std::false_type {};
+
+  template <typename T>
+  struct has_descriptor<T, decltype(void(descriptor<T>::fields()))> : std::true_type {};
+
+  /// Write the fields of a described struct. Adjacent trivially copyable
+  /// fields are merged into a single copy when it doesn't change the data
+  /// layout: no padding between the fields, 4 bytes multiple sizes and
+  /// the same copy unit size, unless the copy policy is native.
+  /// Returns the number of bytes written, 0 on failure
+  template <typename buffer_type, typename T>
+  typename buffer_type::size_type write_fields(buffer_type &outbuf, const T &object);
+
+  /// Read the fields of a described struct, written with write_fields().
+  /// Returns the number of bytes read, 0 on failure
+  template <typename buffer_type, typename T>
+  typename buffer_type::size_type read_fields(buffer_type &inbuf, T &object);
+
+  /// field_block_writer class
+  ///
+  /// A block writer generated from the field descriptor of T
+  template <typename config, typename T>
+  class field_block_writer : public block_writer<config> {
+  public:
+    typedef typename block_writer<config>::buffer_type     buffer_type;
+    typedef typename block_writer<config>::string_type     string_type;
+    typedef typename block_writer<config>::version_type    version_type;
+
+  public:
+    /// Constructor with the block description and the object to write
+    field_block_writer(const string_type &t, const string_type &n, version_type vers, const T &object) :
+      block_writer<config>(t, n, vers),
+      m_object(object) {
+      /* nop */
+    }
+
+    /// Write the object fields
+    error_codes::code_type write(buffer_type &outbuf) const {
+      return (0 != write_fields(outbuf, m_object)) ? error_codes::block::success : error_codes::block::bad_fields;
+    }
+
+  private:
+    /// The object to write
+    const T                &m_object;
+  };
+
+  /// field_block_reader class
+  ///
+  /// A block reader generated from the field descriptor of T.
+  /// The object to fill is get from the record with an accessor
+  template <typename config, typename T>
+  class field_block_reader : public block_reader<config> {
+  public:
+    typedef typename block_reader<config>::record_type     record_type;
+    typedef typename block_reader<config>::buffer_type     buffer_type;
+    typedef typename block_reader<config>::string_type     string_type;
+    typedef typename block_reader<config>::version_type    version_type;
+    typedef T &(*accessor_type)(record_type &);
+
+  public:
+    /// Constructor with the block type, major version and object accessor, e.g:
+    ///   [](event &evt) -> hit& { return evt.m_hit; }
+    field_block_reader(const string_type &t, version_type maj, accessor_type accessor) :
+      block_reader<config>(t, maj),
+      m_accessor(accessor) {
+      /* nop */
+    }
+
+    /// Read the object fields
+    error_codes::code_type read(buffer_type &inbuf, const io::block_summary &, record_type &record) const {
+      return (0 != read_fields(inbuf, m_accessor(record))) ? error_codes::block::success : error_codes::block::bad_fields;
+    }
+
+  private:
+    /// The object accessor
+    const accessor_type     m_accessor;
+  };
+}
+
+#include <accio/details/descriptor_impl.h>
+
+#endif  //  ACCIO_DESCRIPTOR_H
@@ -0,0 +1,111 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_ARENA_IMPL_H
+#define ACCIO_ARENA_IMPL_H 1
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace accio {
+
+  inline arena::arena(size_type chunk_size) :
+    m_chunk_size(std::max<size_type>(chunk_size, 64)) {
+    /* nop */
+  }
+
+  inline arena::~arena() {
+    reset();
+    for(auto &chk : m_chunks) {
+      ::operator delete(chk.m_data);
+    }
+    m_chunks.clear();
+  }
+
+  inline void *arena::allocate(size_type size, size_type align) {
+    auto addr = reinterpret_cast<std::uintptr_t>(m_current);
+    auto aligned = (addr + (align - 1)) & ~static_cast<std::uintptr_t>(align - 1);
+    // fast path: enough space in the current chunk
+    if((nullptr != m_current) and (aligned + size <= reinterpret_cast<std::uintptr_t>(m_end))) {
+      m_allocated += (aligned - addr) + size;
+      m_current = reinterpret_cast<char*>(aligned + size);
+      return reinterpret_cast<void*>(aligned);
+    }
+    next_chunk(size, align);
+    return allocate(size, align);
+  }
+
+  template <typename T, typename ...Args>
+  inline T *arena::create(Args&& ...args) {
+    // allocate the destructor first: the object is never left without it
+    destructor *dtor = nullptr;
+    if(not std::is_trivially_destructible<T>::value) {
+      void *dptr = allocate(sizeof(destructor), alignof(destructor));
+      dtor = new (dptr) destructor();
+    }
+    void *ptr = allocate(sizeof(T), alignof(T));
+    T *object = new (ptr) T(std::forward<Args>(args)...);
+    if(nullptr != dtor) {
+      dtor->m_function = [](void *obj) { static_cast<T*>(obj)->~T(); };
+      dtor->m_object = object;
+      dtor->m_next = m_destructors;
+      m_destructors = dtor;
+    }
+    return object;
+  }
+
+  template <typename T>
+  inline T *arena::create_array(size_type count) {
+    static_assert(std::is_trivially_destructible<T>::value, "accio::arena::create_array: T must be trivially destructible");
+    if(count > std::numeric_limits<size_type>::max() / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    void *ptr = allocate(count*sizeof(T), alignof(T));
+    return new (ptr) T[count];
+  }
+
+  inline void arena::reset() noexcept {
+    while(nullptr != m_destructors) {
+      m_destructors->m_function(m_destructors->m_object);
+      m_destructors = m_destructors->m_next;
+    }
+    m_index = 0;
+    m_allocated = 0;
+    if(not m_chunks.empty()) {
+      m_current = m_chunks[0].m_data;
+      m_end = m_current + m_chunks[0].m_size;
+    }
+  }
+
+  inline void arena::next_chunk(size_type size, size_type align) {
+    auto needed = size + align;
+    // re-use the next chunks, kept from a previous record
+    size_type index = m_chunks.empty() ? 0 : m_index + 1;
+    if((index < m_chunks.size()) and (m_chunks[index].m_size < needed)) {
+      // too small for this allocation. Insert a new chunk in place
+      chunk chk{static_cast<char*>(::operator new(needed)), needed};
+      m_chunks.insert(m_chunks.begin() + index, chk);
+      m_capacity += needed;
+    }
+    else if(index == m_chunks.size()) {
+      auto chunk_size = std::max(needed, m_chunk_size);
+      chunk chk{static_cast<char*>(::operator new(chunk_size)), chunk_size};
+      m_chunks.push_back(chk);
+      m_capacity += chunk_size;
+    }
+    m_index = index;
+    m_current = m_chunks[m_index].m_data;
+    m_end = m_current + m_chunks[m_index].m_size;
+  }
+
+}
+
+#endif  //  ACCIO_ARENA_IMPL_H
@@ -0,0 +1,163 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_BITPACK_IMPL_H
+#define ACCIO_BITPACK_IMPL_H 1
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace accio {
+
+  namespace details {
+
+    /// The mask of the 'bits' (<= 32) low bits of a word
+    inline std::uint32_t bit_mask(unsigned int bits) noexcept {
+      return (bits >= 32) ? 0xffffffff : ((static_cast<std::uint32_t>(1) << bits) - 1);
+    }
+
+    /// Store the 'bits' (<= 32) low bits of a value at a bit offset in zeroed words
+    inline void put_bits(bitpack::word_type *words, std::size_t offset, std::uint32_t value, unsigned int bits) noexcept {
+      const std::size_t w = offset >> 5;
+      const unsigned int s = offset & 31;
+      value &= bit_mask(bits);
+      words[w] |= value << s;
+      if(s + bits > 32) {
+        words[w+1] |= value >> (32 - s);
+      }
+    }
+
+    /// Load 'bits' (<= 32) bits stored at a bit offset
+    inline std::uint32_t get_bits(const bitpack::word_type *words, std::size_t offset, unsigned int bits) noexcept {
+      const std::size_t w = offset >> 5;
+      const unsigned int s = offset & 31;
+      std::uint32_t value = words[w] >> s;
+      if(s + bits > 32) {
+        value |= words[w+1] << (32 - s);
+      }
+      return value & bit_mask(bits);
+    }
+
+    /// Whether a block is packed in interleaved lanes
+    inline bool interleaved(std::size_t count, unsigned int bits) noexcept {
+      return (bitpack::block_size == count) and (bits <= 32);
+    }
+  }
+
+  inline unsigned int bitpack::width(std::uint64_t value) noexcept {
+    unsigned int bits = 0;
+    while(0 != value) {
+      value >>= 1;
+      bits++;
+    }
+    return bits;
+  }
+
+  inline void bitpack::pack(const std::uint32_t *values, size_type count, unsigned int bits, word_type *words) noexcept {
+    std::fill(words, words + bitpack::words(count, bits), 0);
+    if(0 == bits) {
+      return;
+    }
+    if(details::interleaved(count, bits)) {
+      for(size_type k = 0 ; k < count ; k++) {
+        // value k is in lane k % 4, the next word of a lane is 4 words ahead
+        const size_type offset = (k >> 2)*bits;
+        const size_type w = ((offset >> 5) << 2) + (k & 3);
+        const unsigned int s = offset & 31;
+        const std::uint32_t value = values[k] & details::bit_mask(bits);
+        words[w] |= value << s;
+        if(s + bits > 32) {
+          words[w+4] |= value >> (32 - s);
+        }
+      }
+      return;
+    }
+    for(size_type k = 0 ; k < count ; k++) {
+      details::put_bits(words, k*bits, values[k], bits);
+    }
+  }
+
+  inline void bitpack::pack(const std::uint64_t *values, size_type count, unsigned int bits, word_type *words) noexcept {
+    if(bits <= 32) {
+      std::uint32_t narrow[block_size];
+      std::copy(values, values + count, narrow);
+      pack(narrow, count, bits, words);
+      return;
+    }
+    std::fill(words, words + bitpack::words(count, bits), 0);
+    for(size_type k = 0 ; k < count ; k++) {
+      details::put_bits(words, k*bits, static_cast<std::uint32_t>(values[k]), 32);
+      details::put_bits(words, k*bits + 32, static_cast<std::uint32_t>(values[k] >> 32), bits - 32);
+    }
+  }
+
+  inline void bitpack::unpack(const word_type *words, size_type count, unsigned int bits, std::uint32_t *values) noexcept {
+#ifdef __SSE2__
+    if((0 != bits) and details::interleaved(count, bits)) {
+      // one value per lane at each step, all lanes at the same bit offset
+      const __m128i mask = _mm_set1_epi32(static_cast<int>(details::bit_mask(bits)));
+      auto in = reinterpret_cast<const __m128i*>(words);
+      auto out = reinterpret_cast<__m128i*>(values);
+      for(size_type p = 0 ; p < block_size/4 ; p++) {
+        const size_type offset = p*bits;
+        const unsigned int s = offset & 31;
+        __m128i value = _mm_srl_epi32(_mm_loadu_si128(in + (offset >> 5)), _mm_cvtsi32_si128(static_cast<int>(s)));
+        if(s + bits > 32) {
+          value = _mm_or_si128(value, _mm_sll_epi32(_mm_loadu_si128(in + (offset >> 5) + 1), _mm_cvtsi32_si128(static_cast<int>(32 - s))));
+        }
+        _mm_storeu_si128(out + p, _mm_and_si128(value, mask));
+      }
+      return;
+    }
+#endif
+    unpack_scalar(words, count, bits, values);
+  }
+
+  inline void bitpack::unpack_scalar(const word_type *words, size_type count, unsigned int bits, std::uint32_t *values) noexcept {
+    if(0 == bits) {
+      std::fill(values, values + count, 0);
+      return;
+    }
+    if(details::interleaved(count, bits)) {
+      for(size_type k = 0 ; k < count ; k++) {
+        const size_type offset = (k >> 2)*bits;
+        const size_type w = ((offset >> 5) << 2) + (k & 3);
+        const unsigned int s = offset & 31;
+        std::uint32_t value = words[w] >> s;
+        if(s + bits > 32) {
+          value |= words[w+4] << (32 - s);
+        }
+        values[k] = value & details::bit_mask(bits);
+      }
+      return;
+    }
+    for(size_type k = 0 ; k < count ; k++) {
+      values[k] = details::get_bits(words, k*bits, bits);
+    }
+  }
+
+  inline void bitpack::unpack(const word_type *words, size_type count, unsigned int bits, std::uint64_t *values) noexcept {
+    if(bits <= 32) {
+      std::uint32_t narrow[block_size];
+      unpack(words, count, bits, narrow);
+      std::copy(narrow, narrow + count, values);
+      return;
+    }
+    for(size_type k = 0 ; k < count ; k++) {
+      values[k] = details::get_bits(words, k*bits, 32) |
+        (static_cast<std::uint64_t>(details::get_bits(words, k*bits + 32, bits - 32)) << 32);
+    }
+  }
+}
+
+#endif  //  ACCIO_BITPACK_IMPL_H
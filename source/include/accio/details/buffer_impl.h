@@ -19,9 +19,9 @@ namespace accio {
   template <class charT, class copy, class alloc>
   template <class>
   inline buffer<charT, copy, alloc>::
-  buffer(size_type size) {
-    allocator_type allocator;
-    m_buffer = allocator.allocate(size);
+  buffer(size_type size, const allocator_type &allocator) :
+    m_allocator(allocator) {
+    m_buffer = m_allocator.allocate(size);
     m_size = size;
     m_memsize = size;
     std::memset(m_buffer, 0, m_size);
@@ -32,14 +32,14 @@ namespace accio {
   template <class charT, class copy, class alloc>
   template <class>
   inline buffer<charT, copy, alloc>::
-  buffer(char_type *bytes, size_type size, bool cpy) {
+  buffer(char_type *bytes, size_type size, bool cpy, const allocator_type &allocator) :
+    m_allocator(allocator) {
     if(nullptr == bytes) {
       setstate(std::ios_base::badbit);
       return;
     }
     if(cpy) {
-      allocator_type allocator;
-      m_buffer = allocator.allocate(size);
+      m_buffer = m_allocator.allocate(size);
       std::memcpy(m_buffer, bytes, size);
     }
     else {
@@ -54,9 +54,9 @@ namespace accio {
   template <class charT, class copy, class alloc>
   template <class>
   inline buffer<charT, copy, alloc>::
-  buffer(FILE *file, size_type size) {
-    allocator_type allocator;
-    m_buffer = allocator.allocate(size);
+  buffer(FILE *file, size_type size, const allocator_type &allocator) :
+    m_allocator(allocator) {
+    m_buffer = m_allocator.allocate(size);
     m_current = m_buffer;
     m_size = size;
     m_memsize = size;
@@ -74,7 +74,8 @@ namespace accio {
 
   template <class charT, class copy, class alloc>
   buffer<charT, copy, alloc>::
-  buffer(buffer<charT, copy, alloc> &&rhs) {
+  buffer(buffer<charT, copy, alloc> &&rhs) :
+    m_allocator(rhs.m_allocator) {
     // these are not really movable
     m_mode = rhs.m_mode; rhs.m_mode = std::ios_base::out;
     m_iostate = rhs.m_iostate; rhs.m_iostate = std::ios_base::goodbit;
@@ -83,6 +84,10 @@ namespace accio {
     // take the buffer
     m_buffer = rhs.m_buffer; rhs.m_buffer = nullptr;
     m_current = rhs.m_current; rhs.m_current = nullptr;
+    m_swap = rhs.m_swap; rhs.m_swap = false;
+    m_float_truncation = rhs.m_float_truncation; rhs.m_float_truncation = 0;
+    m_double_truncation = rhs.m_double_truncation; rhs.m_double_truncation = 0;
+    m_truncation_error = rhs.m_truncation_error; rhs.m_truncation_error = 0.;
     // move the maps
     m_pointed_at = std::move(rhs.m_pointed_at);
     m_pointer_to = std::move(rhs.m_pointer_to);
@@ -92,7 +97,7 @@ namespace accio {
   inline buffer<charT, copy, alloc>::
   ~buffer() {
     if(nullptr != m_buffer) {
-      delete [] m_buffer;
+      m_allocator.deallocate(m_buffer, m_memsize);
     }
     m_buffer = nullptr;
     m_current = nullptr;
@@ -101,6 +106,10 @@ namespace accio {
   template <class charT, class copy, class alloc>
   buffer<charT, copy, alloc> &&buffer<charT, copy, alloc>::
   operator=(buffer<charT, copy, alloc> &&rhs) {
+    if(nullptr != m_buffer) {
+      m_allocator.deallocate(m_buffer, m_memsize);
+    }
+    m_allocator = rhs.m_allocator;
     // these are not really movable
     m_mode = rhs.m_mode; rhs.m_mode = std::ios_base::out;
     m_iostate = rhs.m_iostate; rhs.m_iostate = std::ios_base::goodbit;
@@ -109,12 +118,36 @@ namespace accio {
     // take the buffer
     m_buffer = rhs.m_buffer; rhs.m_buffer = nullptr;
     m_current = rhs.m_current; rhs.m_current = nullptr;
+    m_swap = rhs.m_swap; rhs.m_swap = false;
+    m_float_truncation = rhs.m_float_truncation; rhs.m_float_truncation = 0;
+    m_double_truncation = rhs.m_double_truncation; rhs.m_double_truncation = 0;
+    m_truncation_error = rhs.m_truncation_error; rhs.m_truncation_error = 0.;
     // move the maps
     m_pointed_at = std::move(rhs.m_pointed_at);
     m_pointer_to = std::move(rhs.m_pointer_to);
     return *this;
   }
 
+  template <class charT, class copy, class alloc>
+  inline void buffer<charT, copy, alloc>::
+  reset(size_type size, open_mode md) {
+    if(size > m_memsize) {
+      if(nullptr != m_buffer) {
+        m_allocator.deallocate(m_buffer, m_memsize);
+        m_buffer = nullptr;
+        m_memsize = 0;
+      }
+      m_buffer = m_allocator.allocate(size);
+      m_memsize = size;
+    }
+    m_size = size;
+    m_current = m_buffer;
+    m_mode = md | std::ios_base::binary;
+    m_pointed_at.clear();
+    m_pointer_to.clear();
+    clear_state();
+  }
+
   template <class charT, class copy, class alloc>
   inline typename buffer<charT, copy, alloc>::size_type buffer<charT, copy, alloc>::
   bufcpy(char_type *data, size_type size) {
@@ -126,11 +159,11 @@ namespace accio {
     // buffer size in memory is bigger
     if(size > m_memsize) {
       if(nullptr != m_buffer) {
-        delete [] m_buffer;
+        m_allocator.deallocate(m_buffer, m_memsize);
         m_buffer = nullptr;
       }
-      allocator_type allocator;
-      m_buffer = allocator.allocate(size);
+      m_buffer = m_allocator.allocate(size);
+      m_memsize = size;
     }
     std::memcpy(m_buffer, data, size);
     m_size = size;
@@ -144,7 +177,7 @@ namespace accio {
   seekoff(off_type off, seek_dir way) {
     // from beginning
     if(std::ios_base::beg == way) {
-      if(off > m_size) {
+      if((off < 0) or (static_cast<size_type>(off) > m_size)) {
         setstate(std::ios_base::failbit);
       }
       else {
@@ -153,7 +186,7 @@ namespace accio {
     }
     // from end of buffer
     else if(std::ios_base::end == way) {
-      if(off > m_size) {
+      if((off < 0) or (static_cast<size_type>(off) > m_size)) {
         setstate(std::ios_base::failbit);
       }
       else {
@@ -178,49 +211,55 @@ namespace accio {
     if(0 == len) {
       return 0;
     }
-    allocator_type allocator;
+    auto pos = tell();
     size_type newlen = m_size + len;
-    char_type* bytes = allocator.allocate(newlen);
+    char_type* bytes = m_allocator.allocate(newlen);
     if(nullptr != m_buffer) {
       std::memcpy(bytes, m_buffer, m_size);
       std::memset(bytes + m_size, 0, len);
-      delete [] m_buffer;
+      m_allocator.deallocate(m_buffer, m_memsize);
     }
     else {
       std::memset(bytes, 0, newlen);
     }
     m_buffer = bytes;
+    m_current = m_buffer + pos;
+    m_size = newlen;
+    m_memsize = newlen;
     clear_state();
     return len;
   }
 
+  template <class charT, class copy, class alloc>
+  inline bool buffer<charT, copy, alloc>::
+  reserve(size_type len) {
+    auto rem = remaining();
+    if(len <= rem) {
+      return true;
+    }
+    auto explen = (((len - rem) / default_expand) + 1)*default_expand;
+    if(explen != expand(explen)) {
+      setstate(std::ios_base::failbit);
+      return false;
+    }
+    return true;
+  }
+
   template <class charT, class copy, class alloc>
   inline typename buffer<charT, copy, alloc>::size_type buffer<charT, copy, alloc>::
   read(char_type *data, size_type memlen, size_type count) {
     if((nullptr == data) or (0 == memlen) or (0 == count)) {
       return 0;
     }
-    if(nullptr == m_buffer) {
-      setstate(std::ios_base::badbit);
-      return 0;
-    }
-    // check read mode
-    if(not (mode() & std::ios_base::in)) {
-      setstate(std::ios_base::failbit);
+    if(not check_mode(std::ios_base::in)) {
       return 0;
     }
-    // check remaining size
-    auto rem = remaining();
-    auto total = memlen*count;
-    auto total_padded = (total + 3) & 0xfffffffc;
     // reach end of buffer ?
-    if(total > rem) {
-      total = rem;
+    if(memlen*count > remaining()) {
       setstate(std::ios_base::eofbit);
+      return 0;
     }
-    copy_type::memcpy(data, m_current, memlen, count);
-    m_current += total_padded;
-    return total_padded;
+    return read_unchecked(data, memlen, count);
   }
 
   template <class charT, class copy, class alloc>
@@ -229,31 +268,124 @@ namespace accio {
     if((nullptr == data) or (0 == memlen) or (0 == count)) {
       return 0;
     }
-    if(nullptr == m_buffer) {
-      setstate(std::ios_base::badbit);
+    if(not check_mode(std::ios_base::out)) {
       return 0;
     }
-    // check write mode
-    if(not (mode() & std::ios_base::out)) {
+    // expand the buffer if not enough space
+    if(not reserve(io::padded_size(memlen, count))) {
+      return 0;
+    }
+    return write_unchecked(data, memlen, count);
+  }
+
+  template <class charT, class copy, class alloc>
+  template <typename T, typename A>
+  inline typename buffer<charT, copy, alloc>::size_type buffer<charT, copy, alloc>::
+  write_data(const std::vector<T, A> &data) {
+    static_assert(std::is_trivially_copyable<T>::value, "accio::buffer::write_data: T must be trivially copyable");
+    typedef typename copy_unit<T>::type unit_type;
+    static_assert(0 == (sizeof(T) % sizeof(unit_type)), "accio::buffer::write_data: invalid copy unit");
+    if(not check_mode(std::ios_base::out)) {
+      return 0;
+    }
+    // the length prefix is stored on 32 bits
+    if(data.size() > io::size32_max) {
       setstate(std::ios_base::failbit);
       return 0;
     }
-    // expand the buffer if not enough space
+    // length prefix + data, with a single capacity check
+    types::size_type count = static_cast<types::size_type>(data.size());
+    auto total = sizeof(count) + io::padded_size(sizeof(T), count);
+    if(not reserve(total)) {
+      return 0;
+    }
+    write_unchecked(reinterpret_cast<const char_type*>(&count), sizeof(count), 1);
+    if(0 != count) {
+      write_units(reinterpret_cast<const unit_type*>(data.data()), count*(sizeof(T)/sizeof(unit_type)));
+    }
+    return total;
+  }
+
+  template <class charT, class copy, class alloc>
+  template <typename T, typename A>
+  inline typename buffer<charT, copy, alloc>::size_type buffer<charT, copy, alloc>::
+  read_data(std::vector<T, A> &data) {
+    static_assert(std::is_trivially_copyable<T>::value, "accio::buffer::read_data: T must be trivially copyable");
+    typedef typename copy_unit<T>::type unit_type;
+    static_assert(0 == (sizeof(T) % sizeof(unit_type)), "accio::buffer::read_data: invalid copy unit");
+    types::size_type count = 0;
+    auto prefix = read(reinterpret_cast<char_type*>(&count), sizeof(count), 1);
+    if(0 == prefix) {
+      return 0;
+    }
+    if(sizeof(T)*count > remaining()) {
+      m_current -= prefix;
+      setstate(std::ios_base::eofbit);
+      return 0;
+    }
+    data.resize(count);
+    if(0 != count) {
+      read_unchecked(reinterpret_cast<char_type*>(data.data()), sizeof(unit_type), count*(sizeof(T)/sizeof(unit_type)));
+    }
+    return prefix + io::padded_size(sizeof(T), count);
+  }
+
+  template <class charT, class copy, class alloc>
+  template <typename T>
+  inline typename buffer<charT, copy, alloc>::size_type buffer<charT, copy, alloc>::
+  read_view(array_view<T> &view, size_type count) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value, "accio::buffer::read_view: T must be trivially copyable");
+    // only data in the plateform byte ordering can be viewed
+    if(copy_type::native == m_swap) {
+      return 0;
+    }
+    if(0 == count) {
+      return 0;
+    }
+    if(not check_mode(std::ios_base::in)) {
+      return 0;
+    }
+    // the view must point to correctly aligned memory
+    if(0 != (reinterpret_cast<std::uintptr_t>(m_current) % alignof(T))) {
+      return 0;
+    }
+    // check remaining size
     auto rem = remaining();
-    auto total = memlen*count;
-    auto total_padded = (total + 3) & 0xfffffffc;
-    if(total_padded > rem) {
-      auto expfac = ((total_padded / rem) + 1)*default_expand;
-      if(expfac != expand(expfac)) {
-        setstate(std::ios_base::failbit);
-        return 0;
-      }
+    auto total = sizeof(T)*count;
+    auto total_padded = io::padded_size(sizeof(T), count);
+    if(total > rem) {
+      setstate(std::ios_base::eofbit);
+      return 0;
     }
-    copy_type::memcpy(m_current, data, memlen, count);
-    m_current += total_padded;
+    view = array_view<T>(reinterpret_cast<const T*>(m_current), count);
+    m_current += std::min<size_type>(total_padded, rem);
     return total_padded;
   }
 
+  template <class charT, class copy, class alloc>
+  template <typename T>
+  inline typename buffer<charT, copy, alloc>::size_type buffer<charT, copy, alloc>::
+  read_view(array_view<T> &view) noexcept {
+    if(copy_type::native == m_swap) {
+      return 0;
+    }
+    types::size_type count = 0;
+    auto prefix = read(reinterpret_cast<char_type*>(&count), sizeof(count), 1);
+    if(0 == prefix) {
+      return 0;
+    }
+    if(0 == count) {
+      view = array_view<T>();
+      return prefix;
+    }
+    auto len = read_view(view, count);
+    if(0 == len) {
+      m_current -= prefix;
+      return 0;
+    }
+    return prefix + len;
+  }
+
   template <class charT, class copy, class alloc>
   inline typename buffer<charT, copy, alloc>::size_type buffer<charT, copy, alloc>::
   write_pointer(const address_type *addr) {
@@ -301,6 +433,79 @@ namespace accio {
     return true;
   }
 
+  template <class charT, class copy, class alloc>
+  inline bool buffer<charT, copy, alloc>::
+  check_mode(open_mode md) noexcept {
+    if(nullptr == m_buffer) {
+      setstate(std::ios_base::badbit);
+      return false;
+    }
+    if(not (mode() & md)) {
+      setstate(std::ios_base::failbit);
+      return false;
+    }
+    return true;
+  }
+
+  template <class charT, class copy, class alloc>
+  inline typename buffer<charT, copy, alloc>::size_type buffer<charT, copy, alloc>::
+  read_unchecked(char_type *data, size_type memlen, size_type count) noexcept {
+    auto total_padded = io::padded_size(memlen, count);
+    if(not m_swap) {
+      copy_type::memcpy(data, m_current, memlen, count);
+    }
+    else if(copy_type::native) {
+      accio::copy::swap(data, m_current, memlen, count);
+    }
+    else {
+      // the two conversions cancel each other
+      std::memcpy(data, m_current, memlen*count);
+    }
+    m_current += std::min<size_type>(total_padded, remaining());
+    return total_padded;
+  }
+
+  template <class charT, class copy, class alloc>
+  inline void buffer<charT, copy, alloc>::
+  set_truncation(unsigned int float_bits, unsigned int double_bits) noexcept {
+    m_float_truncation = (float_bits < mantissa::float_bits) ? float_bits : mantissa::float_bits;
+    m_double_truncation = (double_bits < mantissa::double_bits) ? double_bits : mantissa::double_bits;
+    m_truncation_error = 0.;
+  }
+
+  template <class charT, class copy, class alloc>
+  template <typename F>
+  inline typename buffer<charT, copy, alloc>::size_type buffer<charT, copy, alloc>::
+  write_units(const F *data, size_type count, std::true_type) noexcept {
+    const unsigned int bits = truncation(data);
+    if(0 == bits) {
+      return write_unchecked(reinterpret_cast<const char_type*>(data), sizeof(F), count);
+    }
+    // truncate by chunks on the stack, the copy policy runs on the truncated values
+    F chunk[256];
+    for(size_type i = 0 ; i < count ; ) {
+      const size_type n = std::min<size_type>(count - i, sizeof(chunk)/sizeof(F));
+      m_truncation_error = std::max(m_truncation_error, mantissa::truncate(data + i, n, bits, chunk));
+      write_unchecked(reinterpret_cast<const char_type*>(chunk), sizeof(F), n);
+      i += n;
+    }
+    return io::padded_size(sizeof(F), count);
+  }
+
+  template <class charT, class copy, class alloc>
+  inline typename buffer<charT, copy, alloc>::size_type buffer<charT, copy, alloc>::
+  write_unchecked(const char_type *data, size_type memlen, size_type count) noexcept {
+    auto total = memlen*count;
+    auto total_padded = io::padded_size(memlen, count);
+    copy_type::memcpy(m_current, data, memlen, count);
+    // keep the padding bytes clean, the buffer memory may be re-used
+    if(total_padded > total) {
+      std::memset(m_current + total, 0, total_padded - total);
+    }
+    m_current += total_padded;
+    return total_padded;
+  }
+
 }
 
 #endif  //  ACCIO_BUFFER_IMPL_H
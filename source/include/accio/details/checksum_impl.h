@@ -0,0 +1,290 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_CHECKSUM_IMPL_H
+#define ACCIO_CHECKSUM_IMPL_H 1
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ACCIO_CRC32C_HARDWARE 1
+#include <nmmintrin.h>
+#endif
+
+namespace accio {
+
+  namespace details {
+
+    /// The CRC32C lookup tables for slicing by 8 (reflected polynomial 0x82f63b78)
+    struct crc32c_tables {
+      crc32c_tables() {
+        for(std::uint32_t i = 0 ; i < 256 ; i++) {
+          std::uint32_t crc = i;
+          for(int j = 0 ; j < 8 ; j++) {
+            crc = (crc >> 1) ^ (0x82f63b78 & (0 - (crc & 1)));
+          }
+          m_table[0][i] = crc;
+        }
+        for(std::uint32_t i = 0 ; i < 256 ; i++) {
+          for(int k = 1 ; k < 8 ; k++) {
+            m_table[k][i] = (m_table[k-1][i] >> 8) ^ m_table[0][m_table[k-1][i] & 0xff];
+          }
+        }
+      }
+      std::uint32_t m_table[8][256];
+    };
+  }
+
+  inline checksum::value_type checksum::crc32c_software(const void *data, size_type len, value_type crc) noexcept {
+    static const details::crc32c_tables tables;
+    auto &table = tables.m_table;
+    auto ptr = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    while(len >= 8) {
+      crc ^= static_cast<value_type>(ptr[0]) | (static_cast<value_type>(ptr[1]) << 8) |
+        (static_cast<value_type>(ptr[2]) << 16) | (static_cast<value_type>(ptr[3]) << 24);
+      crc = table[7][crc & 0xff] ^ table[6][(crc >> 8) & 0xff] ^
+        table[5][(crc >> 16) & 0xff] ^ table[4][crc >> 24] ^
+        table[3][ptr[4]] ^ table[2][ptr[5]] ^ table[1][ptr[6]] ^ table[0][ptr[7]];
+      ptr += 8;
+      len -= 8;
+    }
+    while(len-- > 0) {
+      crc = (crc >> 8) ^ table[0][(crc ^ *ptr++) & 0xff];
+    }
+    return ~crc;
+  }
+
+#ifdef ACCIO_CRC32C_HARDWARE
+  namespace details {
+
+    /// Lookup tables to shift a crc by a fixed number of zero bytes.
+    /// Used to combine crcs computed in parallel on adjacent blocks
+    struct crc32c_shift_tables {
+      /// Block size of the long and short parallel loops
+      static constexpr std::size_t long_block = 8192;
+      static constexpr std::size_t short_block = 256;
+
+      crc32c_shift_tables() {
+        zeros(m_long, long_block);
+        zeros(m_short, short_block);
+      }
+
+      /// Multiply a GF(2) 32x32 matrix by a vector
+      static std::uint32_t matrix_times(const std::uint32_t *mat, std::uint32_t vec) {
+        std::uint32_t sum = 0;
+        while(vec) {
+          if(vec & 1) {
+            sum ^= *mat;
+          }
+          vec >>= 1;
+          mat++;
+        }
+        return sum;
+      }
+
+      /// Square a GF(2) 32x32 matrix
+      static void matrix_square(std::uint32_t *square, const std::uint32_t *mat) {
+        for(int n = 0 ; n < 32 ; n++) {
+          square[n] = matrix_times(mat, mat[n]);
+        }
+      }
+
+      /// Build the tables applying 'len' zero bytes (a power of 2) to a crc
+      static void zeros(std::uint32_t table[4][256], std::size_t len) {
+        std::uint32_t even[32], odd[32];
+        // operator for one zero bit
+        odd[0] = 0x82f63b78;
+        std::uint32_t row = 1;
+        for(int n = 1 ; n < 32 ; n++) {
+          odd[n] = row;
+          row <<= 1;
+        }
+        matrix_square(even, odd); // 2 zero bits
+        matrix_square(odd, even); // 4 zero bits
+        // square until the operator for len zero bytes is in 'even'
+        while(true) {
+          matrix_square(even, odd);
+          len >>= 1;
+          if(0 == len) {
+            break;
+          }
+          matrix_square(odd, even);
+          len >>= 1;
+          if(0 == len) {
+            std::memcpy(even, odd, sizeof(even));
+            break;
+          }
+        }
+        for(std::uint32_t n = 0 ; n < 256 ; n++) {
+          table[0][n] = matrix_times(even, n);
+          table[1][n] = matrix_times(even, n << 8);
+          table[2][n] = matrix_times(even, n << 16);
+          table[3][n] = matrix_times(even, n << 24);
+        }
+      }
+
+      /// Apply a zeros operator table to a crc
+      static inline std::uint32_t shift(const std::uint32_t table[4][256], std::uint32_t crc) {
+        return table[0][crc & 0xff] ^ table[1][(crc >> 8) & 0xff] ^
+          table[2][(crc >> 16) & 0xff] ^ table[3][crc >> 24];
+      }
+
+      std::uint32_t m_long[4][256];
+      std::uint32_t m_short[4][256];
+    };
+  }
+
+  __attribute__((target("sse4.2")))
+  inline checksum::value_type checksum::crc32c_hardware(const void *data, size_type len, value_type crc) noexcept {
+    auto ptr = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    // align on 8 bytes
+    while((len > 0) and (0 != (reinterpret_cast<std::uintptr_t>(ptr) & 7))) {
+      crc = _mm_crc32_u8(crc, *ptr++);
+      len--;
+    }
+#ifdef __x86_64__
+    typedef details::crc32c_shift_tables shift_tables;
+    static const shift_tables tables;
+    // The crc32 instruction has a latency of 3 cycles and a throughput of
+    // 1 per cycle: compute the crc of 3 adjacent blocks in parallel and
+    // combine them by shifting the crcs by the block size
+    std::uint64_t crc0 = crc;
+    for(auto block : {shift_tables::long_block, shift_tables::short_block}) {
+      auto &table = (shift_tables::long_block == block) ? tables.m_long : tables.m_short;
+      while(len >= 3*block) {
+        std::uint64_t crc1 = 0, crc2 = 0;
+        auto end = ptr + block;
+        do {
+          std::uint64_t word0, word1, word2;
+          std::memcpy(&word0, ptr, 8);
+          std::memcpy(&word1, ptr + block, 8);
+          std::memcpy(&word2, ptr + 2*block, 8);
+          crc0 = _mm_crc32_u64(crc0, word0);
+          crc1 = _mm_crc32_u64(crc1, word1);
+          crc2 = _mm_crc32_u64(crc2, word2);
+          ptr += 8;
+        } while(ptr < end);
+        crc0 = shift_tables::shift(table, static_cast<std::uint32_t>(crc0)) ^ crc1;
+        crc0 = shift_tables::shift(table, static_cast<std::uint32_t>(crc0)) ^ crc2;
+        ptr += 2*block;
+        len -= 3*block;
+      }
+    }
+    while(len >= 8) {
+      std::uint64_t word;
+      std::memcpy(&word, ptr, 8);
+      crc0 = _mm_crc32_u64(crc0, word);
+      ptr += 8;
+      len -= 8;
+    }
+    crc = static_cast<value_type>(crc0);
+#else
+    while(len >= 4) {
+      std::uint32_t word;
+      std::memcpy(&word, ptr, 4);
+      crc = _mm_crc32_u32(crc, word);
+      ptr += 4;
+      len -= 4;
+    }
+#endif
+    while(len-- > 0) {
+      crc = _mm_crc32_u8(crc, *ptr++);
+    }
+    return ~crc;
+  }
+
+  inline bool checksum::hardware_available() noexcept {
+    static const bool available = __builtin_cpu_supports("sse4.2");
+    return available;
+  }
+#else
+  inline checksum::value_type checksum::crc32c_hardware(const void *data, size_type len, value_type crc) noexcept {
+    return crc32c_software(data, len, crc);
+  }
+
+  inline bool checksum::hardware_available() noexcept {
+    return false;
+  }
+#endif
+
+  inline checksum::value_type checksum::crc32c(const void *data, size_type len, value_type crc) noexcept {
+    static const bool hardware = hardware_available();
+    return hardware ? crc32c_hardware(data, len, crc) : crc32c_software(data, len, crc);
+  }
+
+  //--------------------------------------------------------------------------
+
+  inline checksum_worker::~checksum_worker() {
+    if(m_thread.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+      }
+      m_condition.notify_all();
+      m_thread.join();
+    }
+  }
+
+  inline void checksum_worker::submit(const void *data, size_type len, value_type crc) {
+    wait();
+    // a worker thread would only add context switches
+    if(not concurrent()) {
+      m_crc = checksum::crc32c(data, len, crc);
+      m_submitted = true;
+      return;
+    }
+    if(not m_thread.joinable()) {
+      m_thread = std::thread(&checksum_worker::run, this);
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_data = data;
+      m_len = len;
+      m_crc = crc;
+      m_running = true;
+    }
+    m_submitted = true;
+    m_condition.notify_all();
+  }
+
+  inline checksum_worker::value_type checksum_worker::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]{ return not m_running; });
+    m_submitted = false;
+    return m_crc;
+  }
+
+  inline bool checksum_worker::concurrent() noexcept {
+    static const bool multi_threaded = (std::thread::hardware_concurrency() > 1);
+    return multi_threaded;
+  }
+
+  inline void checksum_worker::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(true) {
+      m_condition.wait(lock, [this]{ return m_running or m_stop; });
+      if(m_stop) {
+        return;
+      }
+      auto data = m_data;
+      auto len = m_len;
+      auto crc = m_crc;
+      lock.unlock();
+      crc = checksum::crc32c(data, len, crc);
+      lock.lock();
+      m_crc = crc;
+      m_running = false;
+      m_condition.notify_all();
+    }
+  }
+
+}
+
+#endif  //  ACCIO_CHECKSUM_IMPL_H
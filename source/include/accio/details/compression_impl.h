@@ -0,0 +1,239 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_COMPRESSION_IMPL_H
+#define ACCIO_COMPRESSION_IMPL_H 1
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace accio {
+
+  namespace details {
+
+    /// The largest part given to zlib at once (the zlib sizes are 32 bits)
+    inline uInt zlib_chunk(std::size_t len) noexcept {
+      return static_cast<uInt>((len > 0x40000000) ? 0x40000000 : len);
+    }
+  }
+
+  inline compressor::~compressor() {
+    if(m_init) {
+      deflateEnd(&m_stream);
+    }
+  }
+
+  inline bool compressor::begin(int level, size_type size, const dictionary_type *dictionary) {
+    level = (level > max_level) ? max_level : level;
+    if(m_init and (level != m_level)) {
+      deflateEnd(&m_stream);
+      m_init = false;
+    }
+    if(m_init) {
+      if(Z_OK != deflateReset(&m_stream)) {
+        return false;
+      }
+    }
+    else {
+      m_stream = z_stream();
+      if(Z_OK != deflateInit2(&m_stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY)) {
+        return false;
+      }
+      m_init = true;
+      m_level = level;
+    }
+    if((nullptr != dictionary) and not dictionary->empty() and
+      (Z_OK != deflateSetDictionary(&m_stream, dictionary->data(), static_cast<uInt>(dictionary->size())))) {
+      return false;
+    }
+    const size_type bound = deflateBound(&m_stream, static_cast<uLong>(size));
+    if(m_output.size() < bound) {
+      m_output.resize(bound);
+    }
+    m_stream.next_out = m_output.data();
+    m_stream.avail_out = details::zlib_chunk(m_output.size());
+    return true;
+  }
+
+  inline bool compressor::update(const void *data, size_type len) {
+    auto ptr = static_cast<const unsigned char*>(data);
+    while(len > 0) {
+      m_stream.next_in = const_cast<Bytef*>(ptr);
+      m_stream.avail_in = details::zlib_chunk(len);
+      ptr += m_stream.avail_in;
+      len -= m_stream.avail_in;
+      while(m_stream.avail_in > 0) {
+        if(0 == m_stream.avail_out) {
+          grow();
+        }
+        if(Z_OK != deflate(&m_stream, Z_NO_FLUSH)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  inline compressor::size_type compressor::finish() {
+    while(true) {
+      auto status = deflate(&m_stream, Z_FINISH);
+      if(Z_STREAM_END == status) {
+        break;
+      }
+      if((Z_OK != status) and (Z_BUF_ERROR != status)) {
+        return 0;
+      }
+      grow();
+    }
+    return m_stream.next_out - m_output.data();
+  }
+
+  inline void compressor::grow() {
+    const size_type offset = m_stream.next_out - m_output.data();
+    m_output.resize(2*m_output.size() + 64);
+    m_stream.next_out = m_output.data() + offset;
+    m_stream.avail_out = details::zlib_chunk(m_output.size() - offset);
+  }
+
+  inline compressor::dictionary_type compressor::train_dictionary(const std::vector<dictionary_type> &samples, size_type size) {
+    // the segments of 32 bytes at 4 byte aligned positions (the
+    // payloads are padded to 4 bytes) and in how many samples they are
+    const size_type segment = 32;
+    struct occurrence {
+      std::size_t     m_count;
+      std::size_t     m_last;
+      std::size_t     m_sample;
+      size_type       m_pos;
+    };
+    std::unordered_map<std::uint64_t, occurrence> segments;
+    for(std::size_t s = 0 ; s < samples.size() ; s++) {
+      auto &sample = samples[s];
+      for(size_type pos = 0 ; pos + segment <= sample.size() ; pos += 4) {
+        // FNV-1a
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+        for(size_type i = 0 ; i < segment ; i++) {
+          hash = (hash ^ sample[pos + i]) * 0x100000001b3ull;
+        }
+        auto iter = segments.find(hash);
+        if(segments.end() == iter) {
+          segments.emplace(hash, occurrence{1, s, s, pos});
+        }
+        else if(iter->second.m_last != s) {
+          iter->second.m_count++;
+          iter->second.m_last = s;
+        }
+      }
+    }
+    // score the bytes of the first occurrences of the common segments
+    std::vector<std::vector<std::size_t>> scores(samples.size());
+    for(auto &entry : segments) {
+      auto &occ = entry.second;
+      if(occ.m_count < 2) {
+        continue;
+      }
+      auto &score = scores[occ.m_sample];
+      score.resize(samples[occ.m_sample].size(), 0);
+      for(size_type i = occ.m_pos ; i < occ.m_pos + segment ; i++) {
+        score[i] = std::max(score[i], occ.m_count);
+      }
+    }
+    // the ranges of scored bytes, the most common first
+    struct range {
+      std::size_t     m_score;
+      std::size_t     m_sample;
+      size_type       m_begin;
+      size_type       m_end;
+    };
+    std::vector<range> ranges;
+    for(std::size_t s = 0 ; s < samples.size() ; s++) {
+      auto &score = scores[s];
+      for(size_type pos = 0 ; pos < score.size() ; ) {
+        if(0 == score[pos]) {
+          pos++;
+          continue;
+        }
+        range r{0, s, pos, pos};
+        while((r.m_end < score.size()) and (0 != score[r.m_end])) {
+          r.m_score = std::max(r.m_score, score[r.m_end]);
+          r.m_end++;
+        }
+        ranges.push_back(r);
+        pos = r.m_end;
+      }
+    }
+    std::stable_sort(ranges.begin(), ranges.end(), [](const range &lhs, const range &rhs) {
+      return lhs.m_score > rhs.m_score;
+    });
+    size = std::min(size, static_cast<size_type>(max_dictionary_size));
+    std::size_t nranges = 0;
+    size_type total = 0;
+    while((nranges < ranges.size()) and (total < size)) {
+      total += ranges[nranges].m_end - ranges[nranges].m_begin;
+      nranges++;
+    }
+    // the most common ranges at the end of the dictionary
+    dictionary_type dictionary;
+    dictionary.reserve(total);
+    for(std::size_t r = nranges ; r-- > 0 ; ) {
+      auto &sample = samples[ranges[r].m_sample];
+      dictionary.insert(dictionary.end(), sample.begin() + ranges[r].m_begin, sample.begin() + ranges[r].m_end);
+    }
+    // keep the end, the most common ranges
+    if(dictionary.size() > size) {
+      dictionary.erase(dictionary.begin(), dictionary.begin() + (dictionary.size() - size));
+    }
+    return dictionary;
+  }
+
+  inline decompressor::~decompressor() {
+    if(m_init) {
+      inflateEnd(&m_stream);
+    }
+  }
+
+  inline bool decompressor::uncompress(const void *input, size_type len, void *output, size_type size, const compressor::dictionary_type *dictionary) {
+    if(m_init) {
+      if(Z_OK != inflateReset(&m_stream)) {
+        return false;
+      }
+    }
+    else {
+      m_stream = z_stream();
+      if(Z_OK != inflateInit2(&m_stream, -MAX_WBITS)) {
+        return false;
+      }
+      m_init = true;
+    }
+    if((nullptr != dictionary) and not dictionary->empty() and
+      (Z_OK != inflateSetDictionary(&m_stream, dictionary->data(), static_cast<uInt>(dictionary->size())))) {
+      return false;
+    }
+    m_stream.next_in = const_cast<Bytef*>(static_cast<const Bytef*>(input));
+    m_stream.avail_in = 0;
+    m_stream.next_out = static_cast<Bytef*>(output);
+    m_stream.avail_out = 0;
+    auto status = Z_OK;
+    while(Z_OK == status) {
+      if(0 == m_stream.avail_in) {
+        m_stream.avail_in = details::zlib_chunk(len);
+        len -= m_stream.avail_in;
+      }
+      if(0 == m_stream.avail_out) {
+        m_stream.avail_out = details::zlib_chunk(size);
+        size -= m_stream.avail_out;
+      }
+      status = inflate(&m_stream, Z_NO_FLUSH);
+    }
+    return (Z_STREAM_END == status) and (0 == m_stream.avail_out) and (0 == size);
+  }
+
+}
+
+#endif  //  ACCIO_COMPRESSION_IMPL_H
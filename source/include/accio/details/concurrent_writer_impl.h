@@ -0,0 +1,220 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_CONCURRENT_WRITER_IMPL_H
+#define ACCIO_CONCURRENT_WRITER_IMPL_H 1
+
+// -- std headers
+#include <algorithm>
+
+namespace accio {
+
+  template <class config>
+  inline buffer_pool<config>::buffer_pool(std::size_t capacity) :
+    m_capacity(std::max<std::size_t>(capacity, 1)) {
+    m_values.reserve(m_capacity);
+    m_free.reserve(m_capacity);
+  }
+
+  template <class config>
+  inline typename buffer_pool<config>::value_type *buffer_pool<config>::acquire() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if(m_free.empty() and (m_values.size() < m_capacity)) {
+      m_values.emplace_back(new value_type());
+      return m_values.back().get();
+    }
+    m_waiting++;
+    m_condition.wait(lock, [this]{ return not m_free.empty(); });
+    m_waiting--;
+    auto value = m_free.back();
+    m_free.pop_back();
+    return value;
+  }
+
+  template <class config>
+  inline void buffer_pool<config>::release(value_type *value) {
+    bool notify = false;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_free.push_back(value);
+      notify = (m_waiting > 0);
+    }
+    if(notify) {
+      m_condition.notify_one();
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <class config>
+  inline concurrent_writer<config>::concurrent_writer(std::size_t max_pending) :
+    m_pool(max_pending) {
+    /* nop */
+  }
+
+  template <class config>
+  inline concurrent_writer<config>::~concurrent_writer() {
+    if(m_open) {
+      close();
+    }
+  }
+
+  template <class config>
+  inline error_codes::code_type concurrent_writer<config>::open(const std::string &fname) {
+    return open(std::vector<std::string>{fname});
+  }
+
+  template <class config>
+  inline error_codes::code_type concurrent_writer<config>::open(const std::vector<std::string> &patterns) {
+    if(m_open) {
+      return error_codes::stream::already_open;
+    }
+    auto status = m_writer.open(patterns);
+    if(error_codes::stream::success != status) {
+      return status;
+    }
+    start();
+    return error_codes::stream::success;
+  }
+
+  template <class config>
+  inline error_codes::code_type concurrent_writer<config>::close() {
+    if(not m_open.exchange(false)) {
+      return error_codes::stream::not_open;
+    }
+    // let the producers already past the open check push their record
+    while(0 != m_submitting.load()) {
+      std::this_thread::yield();
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_condition.notify_one();
+    m_committer.join();
+    auto status = m_writer.close();
+    auto write_status = m_status.load();
+    return (error_codes::stream::success != write_status) ? write_status : status;
+  }
+
+  template <class config>
+  inline void concurrent_writer<config>::start() {
+    m_stop = false;
+    m_status = error_codes::stream::success;
+    m_committer = std::thread(&concurrent_writer<config>::commit, this);
+    m_open = true;
+  }
+
+  template <class config>
+  error_codes::code_type concurrent_writer<config>::write_record(
+    const string32 &name,
+    const record_io &io_config,
+    const record_type &rec) {
+    return submit([&](pending_type &pending) {
+      return m_writer.serialize_record(name, io_config, rec, pending.m_header, pending.m_summary, pending.m_buffer, pending.m_writers);
+    });
+  }
+
+  template <class config>
+  template <typename... blocks>
+  error_codes::code_type concurrent_writer<config>::write_record(
+    const string32 &name,
+    const record_schema<config, blocks...> &schema,
+    const record_type &rec) {
+    return submit([&](pending_type &pending) {
+      return m_writer.serialize_record(name, schema, rec, pending.m_header, pending.m_summary, pending.m_buffer);
+    });
+  }
+
+  template <class config>
+  template <typename serializer>
+  error_codes::code_type concurrent_writer<config>::submit(serializer serialize) {
+    // counted before the open check: close() waits for the
+    // submissions seeing the writer open before stopping the committer
+    m_submitting++;
+    if(not m_open) {
+      m_submitting--;
+      return error_codes::stream::not_open;
+    }
+    auto write_status = m_status.load(std::memory_order_relaxed);
+    if(error_codes::stream::success != write_status) {
+      m_submitting--;
+      return write_status;
+    }
+    // serialize in the calling thread
+    auto pending = m_pool.acquire();
+    auto status = serialize(*pending);
+    if(error_codes::record::success != status) {
+      m_pool.release(pending);
+      m_submitting--;
+      return status;
+    }
+    // submit to the committer, waking it up if it sleeps. The push and
+    // the m_sleeping accesses are sequentially consistent: either the
+    // committer sees the record before sleeping or this thread sees it sleeping
+    m_queue.push(pending);
+    if(m_sleeping.load(std::memory_order_seq_cst)) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_condition.notify_one();
+    }
+    m_submitting--;
+    return error_codes::stream::success;
+  }
+
+  template <class config>
+  void concurrent_writer<config>::commit() {
+    // spinning only helps if the producers run meanwhile on other cores
+    const unsigned int max_idle = (std::thread::hardware_concurrency() > 1) ? 64 : 0;
+    unsigned int idle = 0;
+    bool stopping = false;
+    while(true) {
+      auto pending = m_queue.pop();
+      if(nullptr != pending) {
+        idle = 0;
+        if(error_codes::stream::success == m_status.load(std::memory_order_relaxed)) {
+          auto status = m_writer.write_record(pending->m_header, pending->m_summary, pending->m_buffer);
+          if(error_codes::stream::success != status) {
+            m_status = status;
+          }
+        }
+        m_pool.release(pending);
+        continue;
+      }
+      // a producer is linking its record
+      if(not m_queue.empty()) {
+        std::this_thread::yield();
+        continue;
+      }
+      // the producers are done and the queue is drained
+      if(stopping) {
+        break;
+      }
+      // spin a bit before going to sleep
+      if(++idle < max_idle) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if(m_stop) {
+        stopping = true;
+        continue;
+      }
+      // a record pushed before m_sleeping is set is seen by the predicate,
+      // a producer pushing after it notifies once the lock is released by wait()
+      m_sleeping.store(true, std::memory_order_seq_cst);
+      m_condition.wait(lock, [this]{ return m_stop or not m_queue.empty(); });
+      m_sleeping.store(false, std::memory_order_relaxed);
+      idle = 0;
+    }
+  }
+
+}
+
+#endif  //  ACCIO_CONCURRENT_WRITER_IMPL_H
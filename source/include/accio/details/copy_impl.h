@@ -13,8 +13,23 @@
 
 namespace accio {
 
+  /// Reverse the bytes of each element
+  inline void copy::swap(
+    unsigned char*       destination,
+    const unsigned char* source,
+    std::size_t          size,
+    std::size_t          count) {
+    destination += size;
+    for(std::size_t icnt = 0 ; icnt<count ; icnt++) {
+      for(std::size_t ibyt = 0 ; ibyt<size ; ibyt++) {
+        *--destination = *source++;
+      }
+      destination += (size << 1);
+    }
+  }
+
   /// The standard std::memcpy call
-  void copy::standard::memcpy(
+  inline void copy::standard::memcpy(
     buffer_type*       destination,
     const buffer_type* source,
     size_type          size,
@@ -23,40 +38,28 @@ namespace accio {
   }
 
   /// Copy data to 'destination' in big endian
-  void copy::big_endian::memcpy(
+  inline void copy::big_endian::memcpy(
     buffer_type*       destination,
     const buffer_type* source,
     size_type          size,
     size_type          count) {
-#ifdef __LITTLE_ENDIAN__
-    destination += size;
-    for(size_type icnt = 0 ; icnt<count ; icnt++) {
-      for(size_type ibyt = 0 ; ibyt<size ; ibyt++) {
-        *--destination = *source++;
-      }
-      destination += (size << 1);
-    }
+#ifdef ACCIO_LITTLE_ENDIAN
+    copy::swap(destination, source, size, count);
 #else
-    memcpy(destination, source, size, count);
+    std::memcpy(destination, source, count*size);
 #endif
   }
 
   /// Copy data to 'destination' in little endian
-  void copy::little_endian::memcpy(
+  inline void copy::little_endian::memcpy(
     buffer_type*       destination,
     const buffer_type* source,
     size_type          size,
     size_type          count) {
-#ifdef __LITTLE_ENDIAN__
-    memcpy(destination, source, size, count);
+#ifdef ACCIO_LITTLE_ENDIAN
+    std::memcpy(destination, source, count*size);
 #else
-    destination += size;
-    for(size_type icnt = 0 ; icnt<count ; icnt++) {
-      for(size_type ibyt = 0 ; ibyt<size ; ibyt++) {
-        *--destination = *source++;
-      }
-      destination += (size << 1);
-    }
+    copy::swap(destination, source, size, count);
 #endif
   }
 }
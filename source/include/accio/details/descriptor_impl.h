@@ -0,0 +1,196 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_DESCRIPTOR_IMPL_H
+#define ACCIO_DESCRIPTOR_IMPL_H 1
+
+#include <utility>
+#include <vector>
+
+namespace accio {
+
+  /// Whether a field can be merged with its neighbours in a single copy
+  /// without changing the data layout: no padding after it, and it is
+  /// made of a whole number of copy units
+  template <typename F>
+  struct mergeable_field : std::integral_constant<bool,
+    std::is_trivially_copyable<F>::value and not has_descriptor<F>::value and
+    (0 == sizeof(F) % 4) and (0 == sizeof(F) % sizeof(typename copy_unit<F>::type))> {};
+
+  /// Whether a field can be copied on its own by the buffer
+  template <typename F>
+  struct copyable_field : std::is_trivially_copyable<F> {};
+
+  template <typename T, typename A>
+  struct copyable_field<std::vector<T, A>> : std::is_trivially_copyable<T> {};
+
+  /// field_copier class
+  ///
+  /// Walk through the fields of described structs and copy them to or
+  /// from a buffer. Contiguous mergeable fields are accumulated in a
+  /// run of bytes copied in one go
+  template <typename buffer_type, bool writing>
+  class field_copier {
+  public:
+    typedef typename buffer_type::size_type     size_type;
+    typedef typename buffer_type::char_type     char_type;
+    typedef typename buffer_type::copy_type     copy_type;
+    typedef typename std::conditional<writing, const char_type, char_type>::type   run_type;
+
+  public:
+    /// Constructor with the buffer to write to or read from
+    field_copier(buffer_type &buffer) :
+      m_buffer(buffer),
+      // merging fields of different unit sizes requires no conversion
+      m_mix_units(copy_type::native and (writing or not buffer.byte_swap())),
+      m_truncate(writing and ((0 != buffer.float_truncation()) or (0 != buffer.double_truncation()))) {
+      /* nop */
+    }
+
+    /// Copy the fields of a described struct
+    template <typename T>
+    void fields(T &object) {
+      typedef typename std::remove_const<T>::type type;
+      auto members = descriptor<type>::fields();
+      fields(object, members, std::make_index_sequence<std::tuple_size<decltype(members)>::value>());
+    }
+
+    /// Copy the last run. Returns the number of bytes copied, 0 on failure
+    size_type finish() {
+      flush();
+      return m_failed ? 0 : m_size;
+    }
+
+  private:
+    template <typename T, typename list, std::size_t... indices>
+    void fields(T &object, const list &members, std::index_sequence<indices...>) {
+      const int expand[] = {0, (field(object.*std::get<indices>(members)), 0)...};
+      (void)expand;
+    }
+
+    /// A described struct
+    template <typename F>
+    typename std::enable_if<has_descriptor<typename std::remove_const<F>::type>::value>::type field(F &value) {
+      fields(value);
+    }
+
+    /// A field merged with the current run if contiguous
+    template <typename F>
+    typename std::enable_if<mergeable_field<typename std::remove_const<F>::type>::value>::type field(F &value) {
+      typedef typename copy_unit<typename std::remove_const<F>::type>::type unit_type;
+      auto data = reinterpret_cast<run_type*>(&value);
+      const bool same_unit = (sizeof(unit_type) == m_unit);
+      const bool real = std::is_same<unit_type, float>::value or std::is_same<unit_type, double>::value;
+      // truncated values are only merged with values of the same type
+      const bool split = m_truncate and ((real != m_real) or (real and not same_unit));
+      if((nullptr == m_run) or (m_run + m_len != data) or not (same_unit or m_mix_units) or split) {
+        flush();
+        m_run = data;
+        m_unit = sizeof(unit_type);
+        m_real = real;
+      }
+      else if(not same_unit) {
+        // mixed units: copied as raw bytes
+        m_unit = 1;
+      }
+      m_len += sizeof(F);
+    }
+
+    /// Any other field, copied on its own
+    template <typename F>
+    typename std::enable_if<not has_descriptor<typename std::remove_const<F>::type>::value and
+      not mergeable_field<typename std::remove_const<F>::type>::value>::type field(F &value) {
+      static_assert(copyable_field<typename std::remove_const<F>::type>::value,
+        "accio::descriptor: fields must be trivially copyable, vectors of trivially copyable types or described structs");
+      flush();
+      add(copy(value));
+    }
+
+    template <typename F>
+    size_type copy(const F &value) {
+      return m_buffer.write_data(value);
+    }
+
+    template <typename F>
+    size_type copy(F &value) {
+      return m_buffer.read_data(value);
+    }
+
+    /// Copy the current run
+    void flush() {
+      if(nullptr == m_run) {
+        return;
+      }
+      add(copy_run());
+      m_run = nullptr;
+      m_len = 0;
+    }
+
+    template <bool w = writing>
+    typename std::enable_if<w, size_type>::type copy_run() {
+      // float and double runs go through the mantissa truncation
+      if(m_truncate and m_real) {
+        return (sizeof(float) == m_unit) ?
+          m_buffer.write_data(*reinterpret_cast<const float*>(m_run), m_len / m_unit) :
+          m_buffer.write_data(*reinterpret_cast<const double*>(m_run), m_len / m_unit);
+      }
+      return m_buffer.write(m_run, m_unit, m_len / m_unit);
+    }
+
+    template <bool w = writing>
+    typename std::enable_if<not w, size_type>::type copy_run() {
+      return m_buffer.read(m_run, m_unit, m_len / m_unit);
+    }
+
+    void add(size_type len) {
+      m_failed = m_failed or (0 == len);
+      m_size += len;
+    }
+
+  private:
+    /// The buffer
+    buffer_type            &m_buffer;
+    /// Whether fields of different copy unit sizes can be merged
+    const bool              m_mix_units;
+    /// Whether the float and double values are truncated when written
+    const bool              m_truncate;
+    /// The beginning of the current run
+    run_type               *m_run{nullptr};
+    /// The current run length
+    size_type               m_len{0};
+    /// The copy unit size of the current run
+    size_type               m_unit{0};
+    /// Whether the current run holds float or double values
+    bool                    m_real{false};
+    /// The number of bytes copied
+    size_type               m_size{0};
+    /// Whether a copy failed
+    bool                    m_failed{false};
+  };
+
+  template <typename buffer_type, typename T>
+  inline typename buffer_type::size_type write_fields(buffer_type &outbuf, const T &object) {
+    static_assert(has_descriptor<T>::value, "accio::write_fields: T has no descriptor");
+    field_copier<buffer_type, true> copier(outbuf);
+    copier.fields(object);
+    return copier.finish();
+  }
+
+  template <typename buffer_type, typename T>
+  inline typename buffer_type::size_type read_fields(buffer_type &inbuf, T &object) {
+    static_assert(has_descriptor<T>::value, "accio::read_fields: T has no descriptor");
+    field_copier<buffer_type, false> copier(inbuf);
+    copier.fields(object);
+    return copier.finish();
+  }
+
+}
+
+#endif  //  ACCIO_DESCRIPTOR_IMPL_H
@@ -0,0 +1,399 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_ENCODING_IMPL_H
+#define ACCIO_ENCODING_IMPL_H 1
+
+#include <algorithm>
+#include <cstdint>
+
+namespace accio {
+
+  namespace details {
+
+    /// The integer types used to encode an array of T
+    template <typename T>
+    struct encoded_types {
+      static_assert(std::is_integral<T>::value and not std::is_same<T, bool>::value, "accio::encoding: T must be an integer type");
+      typedef typename std::make_unsigned<T>::type    unsigned_type;
+      typedef typename std::make_signed<T>::type      signed_type;
+      /// The type of the bit packed values
+      typedef typename std::conditional<(sizeof(T) > 4), std::uint64_t, std::uint32_t>::type   residual_type;
+    };
+
+    /// The value of the order 0, 1 or 2 delta transform at index i (>= order).
+    /// The differences wrap around, so that any array can be encoded
+    template <typename U>
+    inline U delta_value(const U *values, std::size_t i, unsigned int order) noexcept {
+      switch(order) {
+        case 0:  return values[i];
+        case 1:  return static_cast<U>(values[i] - values[i-1]);
+        default: return static_cast<U>(static_cast<U>(values[i] - values[i-1]) - static_cast<U>(values[i-1] - values[i-2]));
+      }
+    }
+
+    /// Get the minimum and the range of the delta transform of the values.
+    /// The values are compared as signed, so that small negative
+    /// differences give a small range
+    template <typename T>
+    inline typename encoded_types<T>::unsigned_type delta_range(const T *data, std::size_t count, unsigned int order,
+      typename encoded_types<T>::unsigned_type &minimum) noexcept {
+      typedef typename encoded_types<T>::unsigned_type   unsigned_type;
+      typedef typename encoded_types<T>::signed_type     signed_type;
+      minimum = 0;
+      if(count <= order) {
+        return 0;
+      }
+      auto values = reinterpret_cast<const unsigned_type*>(data);
+      signed_type lo = static_cast<signed_type>(delta_value(values, order, order));
+      signed_type hi = lo;
+      for(std::size_t i = order + 1 ; i < count ; i++) {
+        const signed_type value = static_cast<signed_type>(delta_value(values, i, order));
+        lo = std::min(lo, value);
+        hi = std::max(hi, value);
+      }
+      minimum = static_cast<unsigned_type>(lo);
+      return static_cast<unsigned_type>(static_cast<unsigned_type>(hi) - static_cast<unsigned_type>(lo));
+    }
+
+    /// The bits of a value differing from its sign bit
+    template <typename T>
+    inline T magnitude_bits(T value, std::true_type) noexcept {
+      return static_cast<T>((value < 0) ? ~value : value);
+    }
+
+    template <typename T>
+    inline T magnitude_bits(T value, std::false_type) noexcept {
+      return value;
+    }
+
+    /// The number of bits needed to store the values as is, in two's
+    /// complement for signed types
+    template <typename T>
+    inline unsigned int value_width(const T *data, std::size_t count) noexcept {
+      typedef typename encoded_types<T>::unsigned_type   unsigned_type;
+      unsigned_type bits = 0;
+      for(std::size_t i = 0 ; i < count ; i++) {
+        bits |= static_cast<unsigned_type>(magnitude_bits(data[i], std::is_signed<T>()));
+      }
+      const unsigned int width = bitpack::width(bits);
+      return (std::is_signed<T>::value and (0 != width)) ? width + 1 : width;
+    }
+
+    /// The number of 32 bit words of 'count' bit packed values
+    inline std::size_t packed_words(std::size_t count, unsigned int bits) noexcept {
+      return (count / bitpack::block_size)*bitpack::words(bitpack::block_size, bits) +
+        bitpack::words(count % bitpack::block_size, bits);
+    }
+
+    /// The encoded array layout: references and packed values
+    struct encoded_layout {
+      encoded_layout(std::size_t count, encoding enc) :
+        m_order(referenced(enc) ? order(enc) : 0),
+        m_seeds(referenced(enc) ? std::min<std::size_t>(m_order, count) : 0),
+        m_references(referenced(enc) ? m_seeds + 1 : 0),
+        m_packed(count - m_seeds) {
+        /* nop */
+      }
+      /// The maximum order of the delta transform
+      static constexpr unsigned int max_order = 2;
+      /// Whether the encoding stores references (first values and minimum)
+      static bool referenced(encoding enc) noexcept {
+        return (encoding::frame_of_reference == enc) or (encoding::delta == enc) or (encoding::delta_of_delta == enc);
+      }
+      /// The order of the delta transform of a referenced encoding
+      static unsigned int order(encoding enc) noexcept {
+        const unsigned int value = static_cast<unsigned int>(enc) - 1;
+        return (value < max_order) ? value : max_order;
+      }
+      /// The order of the delta transform
+      unsigned int      m_order{0};
+      /// The number of first values stored as is
+      std::size_t       m_seeds{0};
+      /// The number of references: the first values and the minimum
+      std::size_t       m_references{0};
+      /// The number of bit packed values
+      std::size_t       m_packed{0};
+    };
+
+    /// The size of an encoded array of 'size' bytes values,
+    /// following its count and encoding word
+    inline std::size_t encoded_size(std::size_t size, std::size_t count, encoding enc, unsigned int bits) noexcept {
+      if(encoding::raw == enc) {
+        return io::padded_size(size, count);
+      }
+      const encoded_layout layout(count, enc);
+      return io::padded_size(size, layout.m_references) + sizeof(bitpack::word_type)*packed_words(layout.m_packed, bits);
+    }
+
+    /// The maximum number of values packed with a zero bit width, i.e
+    /// decoded without reading any input. Longer constant arrays are packed
+    /// on one bit, so that a corrupted count doesn't allocate more than
+    /// a few MB before being checked against the encoded bytes
+    constexpr std::size_t max_zero_width = 1024*1024;
+
+    /// Read and check the count and the encoding word of an encoded array of 'size'
+    /// bytes values. Returns the size of the encoded array, 0 on failure
+    template <typename buffer_type>
+    inline std::size_t read_encoded_header(buffer_type &inbuf, std::size_t size, types::size_type &count, encoding &enc, unsigned int &bits) {
+      const auto start_pos = inbuf.tell();
+      types::option_word word = 0;
+      if((0 == inbuf.read_data(count)) or (0 == inbuf.read_data(word))) {
+        inbuf.seekpos(start_pos);
+        return 0;
+      }
+      enc = static_cast<encoding>(word & 0xff);
+      bits = (word >> 8) & 0xff;
+      if((static_cast<types::option_word>(enc) > static_cast<types::option_word>(encoding::packed)) or
+        ((word >> 16) != size) or (bits > 8*size)) {
+        inbuf.seekpos(start_pos);
+        return 0;
+      }
+      // zero bit values take no input: a corrupted count
+      // must not allocate a huge decoded array
+      const encoded_layout layout(count, enc);
+      if((encoding::raw != enc) and (0 == bits) and (layout.m_packed > max_zero_width)) {
+        inbuf.seekpos(start_pos);
+        return 0;
+      }
+      const std::size_t total = encoded_size(size, count, enc, bits);
+      if(total > inbuf.remaining()) {
+        inbuf.seekpos(start_pos);
+        inbuf.setstate(std::ios_base::eofbit);
+        return 0;
+      }
+      return sizeof(count) + sizeof(word) + total;
+    }
+
+    /// Write an array of integers with an encoding and a bit width. The
+    /// minimum is the minimum of the delta transform of the values
+    template <typename buffer_type, typename T>
+    inline typename buffer_type::size_type write_encoded(buffer_type &outbuf, const T *data, std::size_t size,
+      encoding enc, unsigned int bits, typename encoded_types<T>::unsigned_type minimum) {
+      typedef typename buffer_type::char_type                    char_type;
+      typedef typename encoded_types<T>::unsigned_type          unsigned_type;
+      typedef typename encoded_types<T>::residual_type          residual_type;
+      // the count is stored on 32 bits
+      if(size > io::size32_max) {
+        return 0;
+      }
+      const types::size_type count = static_cast<types::size_type>(size);
+      const encoded_layout layout(count, enc);
+      // see read_encoded_header()
+      if((encoding::raw != enc) and (0 == bits) and (layout.m_packed > max_zero_width)) {
+        bits = 1;
+      }
+      const types::option_word word = static_cast<types::option_word>(enc) | (bits << 8) | (sizeof(T) << 16);
+      const std::size_t total = sizeof(count) + sizeof(word) + encoded_size(sizeof(T), count, enc, bits);
+      if(not outbuf.reserve(total)) {
+        return 0;
+      }
+      outbuf.write_data(count);
+      outbuf.write_data(word);
+      auto values = reinterpret_cast<const unsigned_type*>(data);
+      if(encoding::raw == enc) {
+        if(0 != count) {
+          outbuf.write(reinterpret_cast<const char_type*>(values), sizeof(T), count);
+        }
+        return total;
+      }
+      if(0 != layout.m_references) {
+        unsigned_type references[encoded_layout::max_order + 1];
+        std::copy(values, values + layout.m_seeds, references);
+        references[layout.m_seeds] = minimum;
+        outbuf.write(reinterpret_cast<const char_type*>(references), sizeof(T), layout.m_references);
+      }
+      if(0 == bits) {
+        return total;
+      }
+      residual_type residuals[bitpack::block_size];
+      bitpack::word_type words[bitpack::words(bitpack::block_size, 64)];
+      for(std::size_t start = layout.m_seeds ; start < count ; start += bitpack::block_size) {
+        const std::size_t n = (count - start < bitpack::block_size) ? count - start : bitpack::block_size;
+        for(std::size_t k = 0 ; k < n ; k++) {
+          residuals[k] = static_cast<unsigned_type>(delta_value(values, start + k, layout.m_order) - minimum);
+        }
+        bitpack::pack(residuals, n, bits, words);
+        outbuf.write(reinterpret_cast<const char_type*>(words), sizeof(bitpack::word_type), bitpack::words(n, bits));
+      }
+      return total;
+    }
+  }
+
+  template <typename T, typename A>
+  inline encoding best_encoding(const std::vector<T, A> &data) {
+    typename details::encoded_types<T>::unsigned_type minimum = 0;
+    encoding best = encoding::raw;
+    unsigned int best_bits = 8*sizeof(T);
+    // on equal widths, prefer the cheapest transform
+    for(auto enc : {encoding::frame_of_reference, encoding::delta, encoding::delta_of_delta}) {
+      const unsigned int bits = bitpack::width(details::delta_range(data.data(), data.size(), static_cast<unsigned int>(enc) - 1, minimum));
+      if(bits < best_bits) {
+        best = enc;
+        best_bits = bits;
+      }
+    }
+    return best;
+  }
+
+  template <typename buffer_type, typename T, typename A>
+  inline typename buffer_type::size_type write_encoded(buffer_type &outbuf, const std::vector<T, A> &data, encoding enc) {
+    typename details::encoded_types<T>::unsigned_type minimum = 0;
+    if(encoding::automatic == enc) {
+      enc = best_encoding(data);
+    }
+    unsigned int bits = 8*sizeof(T);
+    if(details::encoded_layout::referenced(enc)) {
+      bits = bitpack::width(details::delta_range(data.data(), data.size(), details::encoded_layout::order(enc), minimum));
+    }
+    else if(encoding::packed == enc) {
+      bits = details::value_width(data.data(), data.size());
+    }
+    else if(encoding::raw != enc) {
+      return 0;
+    }
+    return details::write_encoded(outbuf, data.data(), data.size(), enc, bits, minimum);
+  }
+
+  template <typename buffer_type, typename T, typename A>
+  inline typename buffer_type::size_type write_packed(buffer_type &outbuf, const std::vector<T, A> &data, unsigned int bits) {
+    if((bits > 8*sizeof(T)) or (details::value_width(data.data(), data.size()) > bits)) {
+      return 0;
+    }
+    return details::write_encoded(outbuf, data.data(), data.size(), encoding::packed, bits, 0);
+  }
+
+  template <typename buffer_type, typename A>
+  inline typename buffer_type::size_type write_packed(buffer_type &outbuf, const std::vector<bool, A> &data) {
+    typedef typename buffer_type::char_type        char_type;
+    if(data.size() > io::size32_max) {
+      return 0;
+    }
+    const types::size_type count = static_cast<types::size_type>(data.size());
+    const types::option_word word = static_cast<types::option_word>(encoding::packed) | (1 << 8) | (sizeof(bool) << 16);
+    const std::size_t total = sizeof(count) + sizeof(word) + details::encoded_size(sizeof(bool), count, encoding::packed, 1);
+    if(not outbuf.reserve(total)) {
+      return 0;
+    }
+    outbuf.write_data(count);
+    outbuf.write_data(word);
+    std::uint32_t flags[bitpack::block_size];
+    bitpack::word_type words[bitpack::words(bitpack::block_size, 1)];
+    for(std::size_t start = 0 ; start < count ; start += bitpack::block_size) {
+      const std::size_t n = (count - start < bitpack::block_size) ? count - start : bitpack::block_size;
+      for(std::size_t k = 0 ; k < n ; k++) {
+        flags[k] = data[start + k] ? 1 : 0;
+      }
+      bitpack::pack(flags, n, 1, words);
+      outbuf.write(reinterpret_cast<const char_type*>(words), sizeof(bitpack::word_type), bitpack::words(n, 1));
+    }
+    return total;
+  }
+
+  template <typename buffer_type, typename T, typename A>
+  inline typename buffer_type::size_type read_encoded(buffer_type &inbuf, std::vector<T, A> &data) {
+    typedef typename buffer_type::char_type                           char_type;
+    typedef typename details::encoded_types<T>::unsigned_type        unsigned_type;
+    typedef typename details::encoded_types<T>::residual_type        residual_type;
+    types::size_type count = 0;
+    encoding enc = encoding::raw;
+    unsigned int bits = 0;
+    const std::size_t total = details::read_encoded_header(inbuf, sizeof(T), count, enc, bits);
+    if(0 == total) {
+      return 0;
+    }
+    data.resize(count);
+    auto values = reinterpret_cast<unsigned_type*>(data.data());
+    if(encoding::raw == enc) {
+      if(0 != count) {
+        inbuf.read(reinterpret_cast<char_type*>(values), sizeof(T), count);
+      }
+      return total;
+    }
+    const details::encoded_layout layout(count, enc);
+    unsigned_type references[details::encoded_layout::max_order + 1] = {};
+    if(0 != layout.m_references) {
+      inbuf.read(reinterpret_cast<char_type*>(references), sizeof(T), layout.m_references);
+    }
+    std::copy(references, references + layout.m_seeds, values);
+    const unsigned_type minimum = references[layout.m_seeds];
+    residual_type residuals[bitpack::block_size];
+    bitpack::word_type words[bitpack::words(bitpack::block_size, 64)];
+    for(std::size_t start = layout.m_seeds ; start < count ; start += bitpack::block_size) {
+      const std::size_t n = (count - start < bitpack::block_size) ? count - start : bitpack::block_size;
+      if(0 != bits) {
+        inbuf.read(reinterpret_cast<char_type*>(words), sizeof(bitpack::word_type), bitpack::words(n, bits));
+      }
+      bitpack::unpack(words, n, bits, residuals);
+      // undo the delta transform, the first values being the references
+      switch(layout.m_order) {
+        case 0:
+          for(std::size_t k = 0 ; k < n ; k++) {
+            values[start+k] = static_cast<unsigned_type>(minimum + residuals[k]);
+          }
+          break;
+        case 1:
+          for(std::size_t i = start ; i < start + n ; i++) {
+            values[i] = static_cast<unsigned_type>(values[i-1] + minimum + residuals[i-start]);
+          }
+          break;
+        default:
+          for(std::size_t i = start ; i < start + n ; i++) {
+            values[i] = static_cast<unsigned_type>(2*values[i-1] - values[i-2] + minimum + residuals[i-start]);
+          }
+          break;
+      }
+    }
+    // extend the sign of the packed signed values
+    if(std::is_signed<T>::value and (encoding::packed == enc) and (0 != bits) and (bits < 8*sizeof(T))) {
+      const unsigned_type sign = static_cast<unsigned_type>(static_cast<unsigned_type>(1) << (bits - 1));
+      for(std::size_t i = 0 ; i < count ; i++) {
+        values[i] = static_cast<unsigned_type>((values[i] ^ sign) - sign);
+      }
+    }
+    return total;
+  }
+
+  template <typename buffer_type, typename T, typename A>
+  inline typename buffer_type::size_type read_packed(buffer_type &inbuf, std::vector<T, A> &data) {
+    return read_encoded(inbuf, data);
+  }
+
+  template <typename buffer_type, typename A>
+  inline typename buffer_type::size_type read_packed(buffer_type &inbuf, std::vector<bool, A> &data) {
+    typedef typename buffer_type::char_type        char_type;
+    const auto start_pos = inbuf.tell();
+    types::size_type count = 0;
+    encoding enc = encoding::raw;
+    unsigned int bits = 0;
+    const std::size_t total = details::read_encoded_header(inbuf, sizeof(bool), count, enc, bits);
+    if(0 == total) {
+      return 0;
+    }
+    if((encoding::packed != enc) or (1 != bits)) {
+      inbuf.seekpos(start_pos);
+      return 0;
+    }
+    data.resize(count);
+    std::uint32_t flags[bitpack::block_size];
+    bitpack::word_type words[bitpack::words(bitpack::block_size, 1)];
+    for(std::size_t start = 0 ; start < count ; start += bitpack::block_size) {
+      const std::size_t n = (count - start < bitpack::block_size) ? count - start : bitpack::block_size;
+      inbuf.read(reinterpret_cast<char_type*>(words), sizeof(bitpack::word_type), bitpack::words(n, 1));
+      bitpack::unpack(words, n, 1, flags);
+      for(std::size_t k = 0 ; k < n ; k++) {
+        data[start + k] = (0 != flags[k]);
+      }
+    }
+    return total;
+  }
+}
+
+#endif  //  ACCIO_ENCODING_IMPL_H
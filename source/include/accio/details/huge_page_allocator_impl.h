@@ -0,0 +1,143 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_HUGE_PAGE_ALLOCATOR_IMPL_H
+#define ACCIO_HUGE_PAGE_ALLOCATOR_IMPL_H 1
+
+// -- std headers
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <string>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif
+
+namespace accio {
+
+  namespace details {
+
+    /// Round a size up to the huge page size
+    inline std::size_t huge_page_round(std::size_t size) noexcept {
+      return (size + huge_page_size - 1) & ~(huge_page_size - 1);
+    }
+
+    inline void *huge_page_map(std::size_t size) noexcept {
+#if !defined(_WIN32) && defined(MAP_ANONYMOUS)
+      const std::size_t len = huge_page_round(size);
+      if(len < size) {
+        return nullptr;
+      }
+      // map one more huge page to align the memory, then trim the ends
+      void *addr = ::mmap(nullptr, len + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if(MAP_FAILED == addr) {
+        return nullptr;
+      }
+      const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(addr);
+      const std::uintptr_t aligned = (start + huge_page_size - 1) & ~static_cast<std::uintptr_t>(huge_page_size - 1);
+      if(aligned > start) {
+        ::munmap(addr, aligned - start);
+      }
+      const std::uintptr_t end = start + len + huge_page_size;
+      if(end > aligned + len) {
+        ::munmap(reinterpret_cast<void*>(aligned + len), end - aligned - len);
+      }
+#if defined(MADV_HUGEPAGE)
+      // fails if huge pages are not supported: normal pages are used then
+      ::madvise(reinterpret_cast<void*>(aligned), len, MADV_HUGEPAGE);
+#endif
+      return reinterpret_cast<void*>(aligned);
+#else
+      (void)size;
+      return nullptr;
+#endif
+    }
+
+    inline void *page_map(std::size_t size) noexcept {
+#if !defined(_WIN32) && defined(MAP_ANONYMOUS)
+      const std::size_t len = huge_page_round(size);
+      if(len < size) {
+        return nullptr;
+      }
+      void *addr = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      return (MAP_FAILED == addr) ? nullptr : addr;
+#else
+      (void)size;
+      return nullptr;
+#endif
+    }
+
+    inline void huge_page_unmap(void *ptr, std::size_t size) noexcept {
+#if !defined(_WIN32) && defined(MAP_ANONYMOUS)
+      ::munmap(ptr, huge_page_round(size));
+#else
+      (void)ptr; (void)size;
+#endif
+    }
+
+    inline bool huge_page_mapping() noexcept {
+#if !defined(_WIN32) && defined(MAP_ANONYMOUS)
+      return true;
+#else
+      return false;
+#endif
+    }
+  }
+
+  inline bool huge_pages_enabled() {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string setting;
+    if(not std::getline(file, setting)) {
+      return false;
+    }
+    // the selected setting is in brackets
+    return (std::string::npos != setting.find("[always]")) or (std::string::npos != setting.find("[madvise]"));
+#else
+    return false;
+#endif
+  }
+
+  template <typename T, std::size_t threshold>
+  inline typename huge_page_allocator<T, threshold>::value_type *huge_page_allocator<T, threshold>::allocate(size_type n) {
+    if(not is_huge(n)) {
+      return std::allocator<value_type>().allocate(n);
+    }
+    if(n > std::numeric_limits<size_type>::max() / sizeof(value_type)) {
+      throw std::bad_alloc();
+    }
+    void *ptr = details::huge_page_map(n*sizeof(value_type));
+    if(nullptr == ptr) {
+      ptr = details::page_map(n*sizeof(value_type));
+    }
+    if(nullptr == ptr) {
+      throw std::bad_alloc();
+    }
+    return static_cast<value_type*>(ptr);
+  }
+
+  template <typename T, std::size_t threshold>
+  inline void huge_page_allocator<T, threshold>::deallocate(value_type *ptr, size_type n) noexcept {
+    if(not is_huge(n)) {
+      std::allocator<value_type>().deallocate(ptr, n);
+      return;
+    }
+    details::huge_page_unmap(ptr, n*sizeof(value_type));
+  }
+
+  template <typename T, std::size_t threshold>
+  inline bool huge_page_allocator<T, threshold>::is_huge(size_type n) noexcept {
+    return details::huge_page_mapping() and (n > 0) and (n >= (threshold + sizeof(value_type) - 1) / sizeof(value_type));
+  }
+
+}
+
+#endif  //  ACCIO_HUGE_PAGE_ALLOCATOR_IMPL_H
@@ -0,0 +1,102 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_MANTISSA_IMPL_H
+#define ACCIO_MANTISSA_IMPL_H 1
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace accio {
+
+  namespace details {
+
+    /// Truncate the mantissas in software, with the mask of the bits kept
+    template <typename F, typename U>
+    inline double truncate_scalar(const F *input, std::size_t count, U mask, F *output, double error) noexcept {
+      static_assert(sizeof(F) == sizeof(U), "accio::mantissa: invalid mask type");
+      for(std::size_t i = 0 ; i < count ; i++) {
+        const F value = input[i];
+        if(not std::isfinite(value)) {
+          output[i] = value;
+          continue;
+        }
+        U word;
+        std::memcpy(&word, &value, sizeof(word));
+        word &= mask;
+        F truncated;
+        std::memcpy(&truncated, &word, sizeof(word));
+        output[i] = truncated;
+        if(0 != value) {
+          error = std::max(error, (static_cast<double>(value) - static_cast<double>(truncated)) / static_cast<double>(value));
+        }
+      }
+      return error;
+    }
+  }
+
+  inline double mantissa::truncate(const float *input, size_type count, unsigned int bits, float *output) noexcept {
+    bits = (bits < float_bits) ? bits : float_bits;
+    const std::uint32_t mask = ~((static_cast<std::uint32_t>(1) << bits) - 1);
+    size_type i = 0;
+    double error = 0.;
+#ifdef __SSE2__
+    // the error of zeros and non finite values is a NaN, ignored by max
+    const __m128 vmask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(mask)));
+    const __m128 zero = _mm_setzero_ps();
+    __m128 verror = zero;
+    for( ; i + 4 <= count ; i += 4) {
+      const __m128 value = _mm_loadu_ps(input + i);
+      const __m128 finite = _mm_cmpeq_ps(_mm_sub_ps(value, value), zero);
+      const __m128 truncated = _mm_or_ps(_mm_and_ps(finite, _mm_and_ps(value, vmask)), _mm_andnot_ps(finite, value));
+      _mm_storeu_ps(output + i, truncated);
+      verror = _mm_max_ps(_mm_div_ps(_mm_sub_ps(value, truncated), value), verror);
+    }
+    float errors[4];
+    _mm_storeu_ps(errors, verror);
+    error = *std::max_element(errors, errors + 4);
+#endif
+    return details::truncate_scalar(input + i, count - i, mask, output + i, error);
+  }
+
+  inline double mantissa::truncate(const double *input, size_type count, unsigned int bits, double *output) noexcept {
+    bits = (bits < double_bits) ? bits : double_bits;
+    const std::uint64_t mask = ~((static_cast<std::uint64_t>(1) << bits) - 1);
+    size_type i = 0;
+    double error = 0.;
+#ifdef __SSE2__
+    const __m128d vmask = _mm_castsi128_pd(_mm_set1_epi64x(static_cast<long long>(mask)));
+    const __m128d zero = _mm_setzero_pd();
+    __m128d verror = zero;
+    for( ; i + 2 <= count ; i += 2) {
+      const __m128d value = _mm_loadu_pd(input + i);
+      const __m128d finite = _mm_cmpeq_pd(_mm_sub_pd(value, value), zero);
+      const __m128d truncated = _mm_or_pd(_mm_and_pd(finite, _mm_and_pd(value, vmask)), _mm_andnot_pd(finite, value));
+      _mm_storeu_pd(output + i, truncated);
+      verror = _mm_max_pd(_mm_div_pd(_mm_sub_pd(value, truncated), value), verror);
+    }
+    double errors[2];
+    _mm_storeu_pd(errors, verror);
+    error = std::max(errors[0], errors[1]);
+#endif
+    return details::truncate_scalar(input + i, count - i, mask, output + i, error);
+  }
+
+  inline double mantissa::error_bound(unsigned int bits, unsigned int mantissa_bits) noexcept {
+    return std::ldexp(1., static_cast<int>((bits < mantissa_bits) ? bits : mantissa_bits) - static_cast<int>(mantissa_bits));
+  }
+}
+
+#endif  //  ACCIO_MANTISSA_IMPL_H
@@ -0,0 +1,79 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_MPSC_QUEUE_IMPL_H
+#define ACCIO_MPSC_QUEUE_IMPL_H 1
+
+namespace accio {
+
+  template <typename T>
+  inline mpsc_queue<T>::mpsc_queue() :
+    m_head(&m_stub),
+    m_tail(&m_stub) {
+    /* nop */
+  }
+
+  template <typename T>
+  inline void mpsc_queue<T>::push(value_type *value) noexcept {
+    push_node(static_cast<mpsc_node*>(value));
+  }
+
+  template <typename T>
+  inline void mpsc_queue<T>::push_node(mpsc_node *node) noexcept {
+    node->m_next.store(nullptr, std::memory_order_relaxed);
+    // sequentially consistent: a consumer going to sleep when empty()
+    // and a producer checking it after push() see each other
+    mpsc_node *prev = m_head.exchange(node, std::memory_order_seq_cst);
+    // between the exchange and this store, the consumer
+    // can't reach the node: pop() returns nullptr
+    prev->m_next.store(node, std::memory_order_release);
+  }
+
+  template <typename T>
+  inline typename mpsc_queue<T>::value_type *mpsc_queue<T>::pop() noexcept {
+    mpsc_node *tail = m_tail;
+    mpsc_node *next = tail->m_next.load(std::memory_order_acquire);
+    // skip the stub node
+    if(&m_stub == tail) {
+      if(nullptr == next) {
+        return nullptr;
+      }
+      m_tail = next;
+      tail = next;
+      next = next->m_next.load(std::memory_order_acquire);
+    }
+    if(nullptr != next) {
+      m_tail = next;
+      return static_cast<value_type*>(tail);
+    }
+    // the tail is the last node, unless a producer is linking a new one
+    if(tail != m_head.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    // put the stub back behind the last node to pop it
+    push_node(&m_stub);
+    next = tail->m_next.load(std::memory_order_acquire);
+    if(nullptr != next) {
+      m_tail = next;
+      return static_cast<value_type*>(tail);
+    }
+    return nullptr;
+  }
+
+  template <typename T>
+  inline bool mpsc_queue<T>::empty() const noexcept {
+    // a tail other than the stub is a node not popped yet,
+    // a head other than the stub a node pushed behind it
+    return (&m_stub == m_tail) and (&m_stub == m_head.load(std::memory_order_seq_cst));
+  }
+
+}
+
+#endif  //  ACCIO_MPSC_QUEUE_IMPL_H
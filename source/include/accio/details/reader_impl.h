@@ -0,0 +1,75 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_READER_IMPL_H
+#define ACCIO_READER_IMPL_H 1
+
+namespace accio {
+
+  template <typename config>
+  inline error_codes::code_type block_reader_registry<config>::add(block_reader_ptr reader) {
+    if(nullptr == reader) {
+      return error_codes::record::bad_argument;
+    }
+    const auto maj = reader->major_version();
+    const auto k = key(reader->type().hash(), maj);
+    auto range = m_readers.equal_range(k);
+    for(auto iter = range.first ; range.second != iter ; ++iter) {
+      // a true duplicate, not a hash collision
+      if((iter->second->type() == reader->type()) and (iter->second->major_version() == maj)) {
+        return error_codes::block::dup_reader;
+      }
+    }
+    m_readers.insert(typename decltype(m_readers)::value_type(k, reader));
+    return error_codes::block::success;
+  }
+
+  template <typename config>
+  inline const typename block_reader_registry<config>::block_reader *block_reader_registry<config>::find(
+    const string_type &type,
+    version_type vers) const {
+    const auto maj = version::decode_major(vers);
+    auto range = m_readers.equal_range(key(type.hash(), maj));
+    for(auto iter = range.first ; range.second != iter ; ++iter) {
+      // protect against hash collisions
+      if((iter->second->type() == type) and (iter->second->major_version() == maj)) {
+        return iter->second.get();
+      }
+    }
+    return nullptr;
+  }
+
+  template <typename config>
+  inline error_codes::code_type block_reader_registry<config>::read_blocks(
+    buffer_type &inbuf,
+    const io::record_summary &summary,
+    record_type &record) const {
+    auto block_pos = inbuf.tell();
+    for(auto &blk_summary : summary) {
+      auto reader = find(blk_summary);
+      if(nullptr != reader) {
+        auto status = reader->read(inbuf, blk_summary, record);
+        if(error_codes::block::success != status) {
+          return status;
+        }
+      }
+      // whatever the reader did, move to the next block
+      block_pos += blk_summary.m_size;
+      inbuf.seekpos(block_pos);
+      if(not inbuf.good()) {
+        return error_codes::record::no_block_marker;
+      }
+    }
+    return error_codes::record::success;
+  }
+
+}
+
+#endif  //  ACCIO_READER_IMPL_H
@@ -0,0 +1,163 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_RECORD_CACHE_IMPL_H
+#define ACCIO_RECORD_CACHE_IMPL_H 1
+
+// -- std headers
+#include <cstring>
+
+namespace accio {
+
+  template <class T>
+  inline record_cache<T>::record_cache(std::size_t budget) :
+    m_budget(budget) {
+    /* nop */
+  }
+
+  template <class T>
+  inline typename record_cache<T>::value_ptr record_cache<T>::find(const io::record_position &position) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = m_map.find(position);
+    if(m_map.end() == iter) {
+      m_statistics.m_misses++;
+      return nullptr;
+    }
+    m_statistics.m_hits++;
+    m_nodes.splice(m_nodes.begin(), m_nodes, iter->second);
+    return iter->second->m_value;
+  }
+
+  template <class T>
+  inline typename record_cache<T>::value_ptr record_cache<T>::insert(const io::record_position &position, value_ptr value, std::size_t memory) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // loaded meanwhile by another thread
+    auto iter = m_map.find(position);
+    if(m_map.end() != iter) {
+      m_nodes.splice(m_nodes.begin(), m_nodes, iter->second);
+      return iter->second->m_value;
+    }
+    if((nullptr == value) or (memory > m_budget)) {
+      return value;
+    }
+    m_nodes.push_front(node{position, value, memory});
+    m_map.emplace(position, m_nodes.begin());
+    m_statistics.m_records++;
+    m_statistics.m_memory += memory;
+    evict();
+    return value;
+  }
+
+  template <class T>
+  template <typename F>
+  inline typename record_cache<T>::value_ptr record_cache<T>::get(const io::record_position &position, F &&load) {
+    auto value = find(position);
+    if(nullptr != value) {
+      return value;
+    }
+    // the record is loaded without holding the lock
+    value = load();
+    if(nullptr == value) {
+      return nullptr;
+    }
+    return insert(position, value, value->memory());
+  }
+
+  template <class T>
+  inline void record_cache<T>::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_map.clear();
+    m_nodes.clear();
+    m_statistics.m_records = 0;
+    m_statistics.m_memory = 0;
+  }
+
+  template <class T>
+  inline std::size_t record_cache<T>::budget() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budget;
+  }
+
+  template <class T>
+  inline void record_cache<T>::set_budget(std::size_t budget) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = budget;
+    evict();
+  }
+
+  template <class T>
+  inline cache_statistics record_cache<T>::statistics() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_statistics;
+  }
+
+  template <class T>
+  inline void record_cache<T>::reset_statistics() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_statistics.m_hits = 0;
+    m_statistics.m_misses = 0;
+    m_statistics.m_evictions = 0;
+  }
+
+  template <class T>
+  inline void record_cache<T>::evict() {
+    while(m_statistics.m_memory > m_budget) {
+      auto &last = m_nodes.back();
+      m_statistics.m_memory -= last.m_memory;
+      m_statistics.m_records--;
+      m_statistics.m_evictions++;
+      m_map.erase(last.m_position);
+      m_nodes.pop_back();
+    }
+  }
+
+  template <class charT, class copy, class alloc>
+  inline error_codes::code_type read_record(
+    stream<charT, copy> &stream,
+    record_cache<cached_record<charT, copy>> &cache,
+    const io::record_position &position,
+    io::record_header &header,
+    io::record_summary &summary,
+    buffer<charT, copy, alloc> &buffer) {
+    typedef cached_record<charT, copy> record_type;
+    auto status = error_codes::stream::success;
+    auto record = cache.get(position, [&]() -> std::shared_ptr<const record_type> {
+      std::shared_ptr<record_type> loaded = std::make_shared<record_type>();
+      status = stream.seek_record(position);
+      if(error_codes::stream::success == status) {
+        status = stream.read_record(loaded->m_header, loaded->m_summary, loaded->m_buffer);
+      }
+      // the cached records must be verified
+      if(error_codes::stream::success == status) {
+        status = stream.wait_checksum();
+      }
+      if(error_codes::stream::success != status) {
+        return nullptr;
+      }
+      loaded->m_byte_swap = loaded->m_buffer.byte_swap();
+      return loaded;
+    });
+    if(nullptr == record) {
+      return status;
+    }
+    header = record->m_header;
+    summary = record->m_summary;
+    const std::size_t len = record->m_buffer.size();
+    buffer.reset(len, std::ios_base::in);
+    buffer.set_byte_swap(record->m_byte_swap);
+    if(len > 0) {
+      std::memcpy(buffer.begin(), record->m_buffer.begin(), len);
+    }
+    return error_codes::stream::success;
+  }
+
+}
+
+#endif  //  ACCIO_RECORD_CACHE_IMPL_H
@@ -0,0 +1,234 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_RECOVERY_IMPL_H
+#define ACCIO_RECOVERY_IMPL_H 1
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace accio {
+
+  inline record_scanner::record_scanner(std::size_t chunk_size) :
+    m_chunk_size(std::max<std::size_t>((chunk_size + 3) & ~static_cast<std::size_t>(3), 1024)) {
+    /* nop */
+  }
+
+  inline error_codes::code_type record_scanner::scan(const std::string &fname, scan_report &report) {
+    report = scan_report();
+    struct stat st;
+    if(0 != io::file::stat(fname.c_str(), &st)) {
+      return error_codes::stream::not_found;
+    }
+    m_file = io::file::open(fname.c_str(), "rb");
+    if(nullptr == m_file) {
+      return error_codes::stream::open_fail;
+    }
+    m_file_size = st.st_size;
+    m_chunk_offset = 0;
+    m_chunk_len = 0;
+    report.m_file_size = m_file_size;
+    report.m_header_size = header_size();
+    report.m_safe_size = report.m_header_size;
+    offset_type offset = report.m_header_size;
+    offset_type valid_size = report.m_header_size;
+    bool contiguous = true;
+    while(offset + static_cast<offset_type>(sizeof(io::disk_record_header)) <= m_file_size) {
+      record_location location;
+      if(validate(offset, location)) {
+        report.m_records.push_back(location);
+        offset += location.m_size;
+        valid_size += location.m_size;
+        if(contiguous) {
+          report.m_safe_size = offset;
+        }
+        continue;
+      }
+      // broken record: look for the next marker
+      contiguous = false;
+      offset = next_marker(offset + sizeof(types::marker_type));
+    }
+    io::file::close(m_file);
+    m_file = nullptr;
+    offset_type last_end = report.m_records.empty() ? report.m_header_size : report.m_records.back().m_offset + report.m_records.back().m_size;
+    report.m_trailing_bytes = m_file_size - last_end;
+    report.m_corrupted_bytes = last_end - valid_size;
+    // That's all folks!
+    return error_codes::stream::success;
+  }
+
+  inline std::size_t record_scanner::find_marker(const unsigned char *data, std::size_t len) noexcept {
+    std::size_t pos = 0;
+#ifdef __SSE2__
+    // compare 4 x 16 bytes per iteration, only the 4 bytes aligned
+    // words are compared as records are 4 bytes aligned in files
+    const __m128i marker = _mm_set1_epi32(static_cast<int>(io::marker::record));
+    for( ; pos + 64 <= len ; pos += 64) {
+      auto ptr = reinterpret_cast<const __m128i*>(data + pos);
+      __m128i cmp0 = _mm_cmpeq_epi32(_mm_loadu_si128(ptr), marker);
+      __m128i cmp1 = _mm_cmpeq_epi32(_mm_loadu_si128(ptr + 1), marker);
+      __m128i cmp2 = _mm_cmpeq_epi32(_mm_loadu_si128(ptr + 2), marker);
+      __m128i cmp3 = _mm_cmpeq_epi32(_mm_loadu_si128(ptr + 3), marker);
+      __m128i any = _mm_or_si128(_mm_or_si128(cmp0, cmp1), _mm_or_si128(cmp2, cmp3));
+      if(0 != _mm_movemask_epi8(any)) {
+        break;
+      }
+    }
+#endif
+    for( ; pos + sizeof(types::marker_type) <= len ; pos += sizeof(types::marker_type)) {
+      types::marker_type word;
+      std::memcpy(&word, data + pos, sizeof(word));
+      if(io::marker::record == word) {
+        return pos;
+      }
+    }
+    return len;
+  }
+
+  inline bool record_scanner::load(offset_type offset, std::size_t min_len) {
+    if(m_chunk.size() < std::max(m_chunk_size, min_len)) {
+      m_chunk.resize(std::max(m_chunk_size, min_len));
+    }
+    std::size_t len = std::min<std::size_t>(m_chunk.size(), m_file_size - offset);
+    m_chunk_offset = offset;
+    m_chunk_len = 0;
+    if(0 != io::file::seek(m_file, offset, SEEK_SET)) {
+      return false;
+    }
+    m_chunk_len = io::file::read(m_chunk.data(), 1, len, m_file);
+    return (m_chunk_len >= min_len);
+  }
+
+  inline const unsigned char *record_scanner::fetch(offset_type offset, std::size_t len) {
+    if((offset < m_chunk_offset) or (offset + static_cast<offset_type>(len) > m_chunk_offset + static_cast<offset_type>(m_chunk_len))) {
+      if(not load(offset, len)) {
+        return nullptr;
+      }
+    }
+    return m_chunk.data() + (offset - m_chunk_offset);
+  }
+
+  inline bool record_scanner::validate(offset_type offset, record_location &location) {
+    // header, 64 bit sizes and summary size
+    auto ptr = fetch(offset, sizeof(io::disk_record_header));
+    if(nullptr == ptr) {
+      return false;
+    }
+    // decoded field by field: the header holds a string
+    io::record_header header;
+    std::memcpy(&header.m_marker, ptr + offsetof(io::disk_record_header, m_marker), sizeof(header.m_marker));
+    if(io::marker::record != header.m_marker) {
+      return false;
+    }
+    std::memcpy(&header.m_options, ptr + offsetof(io::disk_record_header, m_options), sizeof(header.m_options));
+    header.m_name.assign(reinterpret_cast<const char*>(ptr + offsetof(io::disk_record_header, m_name)), header.m_name.capacity());
+    const bool size64 = (0 != (header.m_options & io::option::size64));
+    std::size_t summary_offset = sizeof(io::disk_record_header);
+    ptr = fetch(offset, summary_offset + (size64 ? 2*sizeof(types::size64_type) : 0) + sizeof(types::size_type));
+    if(nullptr == ptr) {
+      return false;
+    }
+    if(size64) {
+      types::size64_type sizes[2];
+      std::memcpy(sizes, ptr + summary_offset, sizeof(sizes));
+      header.m_compsize = sizes[0];
+      header.m_uncompsize = sizes[1];
+      summary_offset += sizeof(sizes);
+    }
+    else {
+      types::size_type sizes[2];
+      std::memcpy(&sizes[0], ptr + offsetof(io::disk_record_header, m_compsize), sizeof(sizes[0]));
+      std::memcpy(&sizes[1], ptr + offsetof(io::disk_record_header, m_uncompsize), sizeof(sizes[1]));
+      header.m_compsize = sizes[0];
+      header.m_uncompsize = sizes[1];
+    }
+    types::size_type nblocks = 0;
+    std::memcpy(&nblocks, ptr + summary_offset, sizeof(nblocks));
+    summary_offset += sizeof(nblocks);
+    // the record must fit in the file
+    const types::size64_type remaining = m_file_size - offset;
+    if(nblocks > remaining / sizeof(io::disk_block_summary)) {
+      return false;
+    }
+    const types::size64_type size = io::record_size(header, nblocks);
+    if(size > remaining) {
+      return false;
+    }
+    // an uncompressed record has the same size on disk
+    if((0 == (header.m_options & io::option::compression)) and (header.m_compsize != header.m_uncompsize)) {
+      return false;
+    }
+    // the blocks must fill the record
+    ptr = fetch(offset, summary_offset + io::summary_size(header, nblocks));
+    if(nullptr == ptr) {
+      return false;
+    }
+    types::size64_type total_size = 0;
+    for(types::size_type b = 0 ; b < nblocks ; b++) {
+      if(size64) {
+        types::size64_type block_size = 0;
+        std::memcpy(&block_size, ptr + summary_offset + nblocks*sizeof(io::disk_block_summary) + b*sizeof(block_size), sizeof(block_size));
+        total_size += block_size;
+      }
+      else {
+        types::size_type block_size = 0;
+        std::memcpy(&block_size, ptr + summary_offset + b*sizeof(io::disk_block_summary) + offsetof(io::disk_block_summary, m_size), sizeof(block_size));
+        total_size += block_size;
+      }
+    }
+    if(total_size != header.m_uncompsize) {
+      return false;
+    }
+    location.m_offset = offset;
+    location.m_size = size;
+    location.m_header = header;
+    return true;
+  }
+
+  inline record_scanner::offset_type record_scanner::header_size() {
+    auto ptr = fetch(0, sizeof(io::file_header));
+    if(nullptr == ptr) {
+      return 0;
+    }
+    io::file_header header;
+    std::memcpy(&header, ptr, sizeof(header));
+    // the header size must keep the records 4 bytes aligned
+    if((io::marker::file != header.m_marker) or (header.m_size < sizeof(header)) or
+      (0 != (header.m_size & io::marker::align)) or (header.m_size > m_file_size)) {
+      return 0;
+    }
+    return header.m_size;
+  }
+
+  inline record_scanner::offset_type record_scanner::next_marker(offset_type offset) {
+    while(offset + static_cast<offset_type>(sizeof(types::marker_type)) <= m_file_size) {
+      auto ptr = fetch(offset, sizeof(types::marker_type));
+      if(nullptr == ptr) {
+        break;
+      }
+      std::size_t len = m_chunk_len - (offset - m_chunk_offset);
+      std::size_t pos = find_marker(ptr, len);
+      if(pos < len) {
+        return offset + pos;
+      }
+      // keep the search 4 bytes aligned
+      offset += len & ~static_cast<std::size_t>(3);
+    }
+    return m_file_size;
+  }
+
+}
+
+#endif  //  ACCIO_RECOVERY_IMPL_H
@@ -0,0 +1,76 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_SCHEMA_IMPL_H
+#define ACCIO_SCHEMA_IMPL_H 1
+
+#include <iostream>
+
+namespace accio {
+
+  template <typename config, typename... blocks>
+  inline record_schema<config, blocks...>::record_schema() :
+    m_summary{io::block_summary{blocks::version(), 0, blocks::type(), blocks::name(), schema_filter<blocks>::value()}...} {
+    /* nop */
+  }
+
+  template <typename config, typename... blocks>
+  inline void record_schema<config, blocks...>::write_blocks(
+    const record_type &rec,
+    buffer_type &outbuf,
+    io::record_summary &summary) const {
+    write_blocks(std::index_sequence_for<blocks...>(), rec, outbuf, summary);
+  }
+
+  template <typename config, typename... blocks>
+  template <std::size_t... indices>
+  inline void record_schema<config, blocks...>::write_blocks(
+    std::index_sequence<indices...>,
+    const record_type &rec,
+    buffer_type &outbuf,
+    io::record_summary &summary) const {
+    // the braced list guarantees the blocks are written in order
+    const bool written[] = {write_block<blocks>(indices, rec, outbuf, summary)...};
+    (void)written;
+  }
+
+  template <typename config, typename... blocks>
+  template <typename block>
+  inline bool record_schema<config, blocks...>::write_block(
+    std::size_t index,
+    const record_type &rec,
+    buffer_type &outbuf,
+    io::record_summary &summary) const {
+    auto begin_pos = outbuf.tell();
+    auto status = block::write(outbuf, rec);
+    const char *error = nullptr;
+    if(error_codes::block::success != status) {
+      error = "ERROR - Couldn't write block:";
+    }
+    else if(outbuf.tell() <= begin_pos) {
+      error = "ERROR - Invalid buffer pointer after block writing:";
+    }
+    if(nullptr != error) {
+      std::cout << error << std::endl;
+      std::cout << "  => type: " << m_summary[index].m_type.c_str() << std::endl;
+      std::cout << "  => name: " << m_summary[index].m_name.c_str() << std::endl;
+      std::cout << "  => version: " << m_summary[index].m_version << std::endl;
+      std::cout << "Skipping ..." << std::endl;
+      outbuf.seekpos(begin_pos);
+      return false;
+    }
+    summary.push_back(m_summary[index]);
+    summary.back().m_size = outbuf.tell() - begin_pos;
+    return true;
+  }
+
+}
+
+#endif  //  ACCIO_SCHEMA_IMPL_H
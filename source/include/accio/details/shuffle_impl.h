@@ -0,0 +1,336 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_SHUFFLE_IMPL_H
+#define ACCIO_SHUFFLE_IMPL_H 1
+
+#include <algorithm>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ACCIO_SHUFFLE_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace accio {
+
+  namespace details {
+
+    /// Byte shuffle the elements [begin, end) of an array of 'n' elements
+    inline void byte_shuffle_scalar(const unsigned char *input, std::size_t begin, std::size_t end, std::size_t n, std::size_t element, unsigned char *output) noexcept {
+      for(std::size_t i = begin ; i < end ; i++) {
+        for(std::size_t b = 0 ; b < element ; b++) {
+          output[b*n + i] = input[i*element + b];
+        }
+      }
+    }
+
+    /// Revert byte_shuffle_scalar()
+    inline void byte_unshuffle_scalar(const unsigned char *input, std::size_t begin, std::size_t end, std::size_t n, std::size_t element, unsigned char *output) noexcept {
+      for(std::size_t i = begin ; i < end ; i++) {
+        for(std::size_t b = 0 ; b < element ; b++) {
+          output[i*element + b] = input[b*n + i];
+        }
+      }
+    }
+
+    /// Transpose a 8x8 bit matrix stored by rows of one byte,
+    /// the row r being the byte r (Hacker's Delight, 7-3)
+    inline std::uint64_t transpose8(std::uint64_t x) noexcept {
+      std::uint64_t t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaull;
+      x = x ^ t ^ (t << 7);
+      t = (x ^ (x >> 14)) & 0x0000cccc0000ccccull;
+      x = x ^ t ^ (t << 14);
+      t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ull;
+      return x ^ t ^ (t << 28);
+    }
+
+    /// Bit shuffle the groups of 8 elements [begin, end) of an array of 'ngroups' groups
+    inline void bit_shuffle_scalar(const unsigned char *input, std::size_t begin, std::size_t end, std::size_t ngroups, std::size_t element, unsigned char *output) noexcept {
+      for(std::size_t g = begin ; g < end ; g++) {
+        const unsigned char *group = input + 8*g*element;
+        for(std::size_t b = 0 ; b < element ; b++) {
+          std::uint64_t x = 0;
+          for(std::size_t i = 0 ; i < 8 ; i++) {
+            x |= static_cast<std::uint64_t>(group[i*element + b]) << (8*i);
+          }
+          x = transpose8(x);
+          for(std::size_t j = 0 ; j < 8 ; j++) {
+            output[(8*b + j)*ngroups + g] = static_cast<unsigned char>(x >> (8*j));
+          }
+        }
+      }
+    }
+
+    /// Revert bit_shuffle_scalar()
+    inline void bit_unshuffle_scalar(const unsigned char *input, std::size_t begin, std::size_t end, std::size_t ngroups, std::size_t element, unsigned char *output) noexcept {
+      for(std::size_t g = begin ; g < end ; g++) {
+        unsigned char *group = output + 8*g*element;
+        for(std::size_t b = 0 ; b < element ; b++) {
+          std::uint64_t x = 0;
+          for(std::size_t j = 0 ; j < 8 ; j++) {
+            x |= static_cast<std::uint64_t>(input[(8*b + j)*ngroups + g]) << (8*j);
+          }
+          x = transpose8(x);
+          for(std::size_t i = 0 ; i < 8 ; i++) {
+            group[i*element + b] = static_cast<unsigned char>(x >> (8*i));
+          }
+        }
+      }
+    }
+
+#ifdef ACCIO_SHUFFLE_AVX2
+    /// Byte shuffle the first elements of an array of 'n' elements of 4 or 8
+    /// bytes, by 128 bytes. Returns the number of elements shuffled
+    __attribute__((target("avx2")))
+    inline std::size_t byte_shuffle_avx2(const unsigned char *input, std::size_t n, std::size_t element, unsigned char *output) noexcept {
+      std::size_t i = 0;
+      if(4 == element) {
+        // in each lane: the bytes b of 4 elements in the dword b,
+        // then across lanes: the bytes b of 8 elements in the qword b
+        const __m256i bytes = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,
+          0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+        const __m256i dwords = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        for( ; i + 32 <= n ; i += 32) {
+          const unsigned char *src = input + 4*i;
+          __m256i v0 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), bytes), dwords);
+          __m256i v1 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32)), bytes), dwords);
+          __m256i v2 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 64)), bytes), dwords);
+          __m256i v3 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 96)), bytes), dwords);
+          __m256i a = _mm256_unpacklo_epi64(v0, v1);
+          __m256i b = _mm256_unpackhi_epi64(v0, v1);
+          __m256i c = _mm256_unpacklo_epi64(v2, v3);
+          __m256i d = _mm256_unpackhi_epi64(v2, v3);
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm256_permute2x128_si256(a, c, 0x20));
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + n + i), _mm256_permute2x128_si256(b, d, 0x20));
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + 2*n + i), _mm256_permute2x128_si256(a, c, 0x31));
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + 3*n + i), _mm256_permute2x128_si256(b, d, 0x31));
+        }
+      }
+      else if(8 == element) {
+        // lanes holding the elements (0, 1), (2, 3), ... (6, 7) and (8, 9), ... (14, 15),
+        // then the bytes b of 2 elements in the word b, transposed by unpacking
+        const __m256i bytes = _mm256_setr_epi8(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15,
+          0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
+        for( ; i + 16 <= n ; i += 16) {
+          const unsigned char *src = input + 8*i;
+          __m256i l0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+          __m256i l1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+          __m256i l2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 64));
+          __m256i l3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 96));
+          __m256i v0 = _mm256_shuffle_epi8(_mm256_permute2x128_si256(l0, l2, 0x20), bytes);
+          __m256i v1 = _mm256_shuffle_epi8(_mm256_permute2x128_si256(l0, l2, 0x31), bytes);
+          __m256i v2 = _mm256_shuffle_epi8(_mm256_permute2x128_si256(l1, l3, 0x20), bytes);
+          __m256i v3 = _mm256_shuffle_epi8(_mm256_permute2x128_si256(l1, l3, 0x31), bytes);
+          __m256i t0 = _mm256_unpacklo_epi16(v0, v1);
+          __m256i t1 = _mm256_unpackhi_epi16(v0, v1);
+          __m256i t2 = _mm256_unpacklo_epi16(v2, v3);
+          __m256i t3 = _mm256_unpackhi_epi16(v2, v3);
+          // the bytes 2k and 2k+1 in the qwords of each lane
+          const __m256i planes[4] = {
+            _mm256_unpacklo_epi32(t0, t2), _mm256_unpackhi_epi32(t0, t2),
+            _mm256_unpacklo_epi32(t1, t3), _mm256_unpackhi_epi32(t1, t3)
+          };
+          for(std::size_t k = 0 ; k < 4 ; k++) {
+            __m256i u = _mm256_permute4x64_epi64(planes[k], 0xd8);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 2*k*n + i), _mm256_castsi256_si128(u));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + (2*k + 1)*n + i), _mm256_extracti128_si256(u, 1));
+          }
+        }
+      }
+      return i;
+    }
+
+    /// Revert byte_shuffle_avx2(). Returns the number of elements unshuffled
+    __attribute__((target("avx2")))
+    inline std::size_t byte_unshuffle_avx2(const unsigned char *input, std::size_t n, std::size_t element, unsigned char *output) noexcept {
+      std::size_t i = 0;
+      if(4 == element) {
+        const __m256i bytes = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,
+          0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+        const __m256i dwords = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+        for( ; i + 32 <= n ; i += 32) {
+          __m256i p0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+          __m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + n + i));
+          __m256i p2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + 2*n + i));
+          __m256i p3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + 3*n + i));
+          __m256i a = _mm256_permute2x128_si256(p0, p2, 0x20);
+          __m256i b = _mm256_permute2x128_si256(p1, p3, 0x20);
+          __m256i c = _mm256_permute2x128_si256(p0, p2, 0x31);
+          __m256i d = _mm256_permute2x128_si256(p1, p3, 0x31);
+          unsigned char *dst = output + 4*i;
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(_mm256_unpacklo_epi64(a, b), dwords), bytes));
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32), _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(_mm256_unpackhi_epi64(a, b), dwords), bytes));
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 64), _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(_mm256_unpacklo_epi64(c, d), dwords), bytes));
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 96), _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(_mm256_unpackhi_epi64(c, d), dwords), bytes));
+        }
+      }
+      else if(8 == element) {
+        const __m256i words = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15,
+          0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+        const __m256i bytes = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15,
+          0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+        for( ; i + 16 <= n ; i += 16) {
+          __m256i u[4];
+          for(std::size_t k = 0 ; k < 4 ; k++) {
+            __m256i planes = _mm256_inserti128_si256(
+              _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 2*k*n + i))),
+              _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + (2*k + 1)*n + i)), 1);
+            u[k] = _mm256_shuffle_epi32(_mm256_permute4x64_epi64(planes, 0xd8), _MM_SHUFFLE(3, 1, 2, 0));
+          }
+          __m256i t0 = _mm256_shuffle_epi8(_mm256_unpacklo_epi64(u[0], u[1]), words);
+          __m256i t2 = _mm256_shuffle_epi8(_mm256_unpackhi_epi64(u[0], u[1]), words);
+          __m256i t1 = _mm256_shuffle_epi8(_mm256_unpacklo_epi64(u[2], u[3]), words);
+          __m256i t3 = _mm256_shuffle_epi8(_mm256_unpackhi_epi64(u[2], u[3]), words);
+          __m256i v0 = _mm256_shuffle_epi8(_mm256_unpacklo_epi64(t0, t1), bytes);
+          __m256i v1 = _mm256_shuffle_epi8(_mm256_unpackhi_epi64(t0, t1), bytes);
+          __m256i v2 = _mm256_shuffle_epi8(_mm256_unpacklo_epi64(t2, t3), bytes);
+          __m256i v3 = _mm256_shuffle_epi8(_mm256_unpackhi_epi64(t2, t3), bytes);
+          unsigned char *dst = output + 8*i;
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_permute2x128_si256(v0, v1, 0x20));
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32), _mm256_permute2x128_si256(v2, v3, 0x20));
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 64), _mm256_permute2x128_si256(v0, v1, 0x31));
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 96), _mm256_permute2x128_si256(v2, v3, 0x31));
+        }
+      }
+      return i;
+    }
+
+    /// Bit shuffle the first groups of 8 elements of 4 or 8 bytes of an array
+    /// of 'ngroups' groups, by 32 elements: the elements are byte shuffled,
+    /// then the bits j of 32 bytes are gathered with a movemask.
+    /// Returns the number of groups shuffled
+    __attribute__((target("avx2")))
+    inline std::size_t bit_shuffle_avx2(const unsigned char *input, std::size_t ngroups, std::size_t element, unsigned char *output) noexcept {
+      alignas(32) unsigned char planes[8*32];
+      std::size_t g = 0;
+      for( ; g + 4 <= ngroups ; g += 4) {
+        byte_shuffle_avx2(input + 8*g*element, 32, element, planes);
+        for(std::size_t b = 0 ; b < element ; b++) {
+          __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(planes + 32*b));
+          for(std::size_t j = 8 ; j-- > 0 ; ) {
+            const std::uint32_t mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(v));
+            std::memcpy(output + (8*b + j)*ngroups + g, &mask, sizeof(mask));
+            v = _mm256_add_epi8(v, v);
+          }
+        }
+      }
+      return g;
+    }
+
+    /// Revert bit_shuffle_avx2(): the bits i of the masks are spread over
+    /// 32 bytes by comparison. Returns the number of groups unshuffled
+    __attribute__((target("avx2")))
+    inline std::size_t bit_unshuffle_avx2(const unsigned char *input, std::size_t ngroups, std::size_t element, unsigned char *output) noexcept {
+      alignas(32) unsigned char planes[8*32];
+      // the byte i selects the mask byte i/8 and tests its bit i%8
+      const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+        2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+      const __m256i bits = _mm256_set1_epi64x(static_cast<long long>(0x8040201008040201ull));
+      std::size_t g = 0;
+      for( ; g + 4 <= ngroups ; g += 4) {
+        for(std::size_t b = 0 ; b < element ; b++) {
+          __m256i v = _mm256_setzero_si256();
+          for(std::size_t j = 0 ; j < 8 ; j++) {
+            std::uint32_t mask;
+            std::memcpy(&mask, input + (8*b + j)*ngroups + g, sizeof(mask));
+            __m256i m = _mm256_and_si256(_mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int>(mask)), spread), bits);
+            __m256i set = _mm256_cmpeq_epi8(m, bits);
+            v = _mm256_or_si256(v, _mm256_and_si256(set, _mm256_set1_epi8(static_cast<char>(1 << j))));
+          }
+          _mm256_store_si256(reinterpret_cast<__m256i*>(planes + 32*b), v);
+        }
+        byte_unshuffle_avx2(planes, 32, element, output + 8*g*element);
+      }
+      return g;
+    }
+#endif
+  }
+
+  inline void shuffle::byte_shuffle(const unsigned char *input, size_type size, size_type element, unsigned char *output) noexcept {
+    const size_type n = (element > 1) ? size / element : 0;
+    size_type i = 0;
+#ifdef ACCIO_SHUFFLE_AVX2
+    if(((4 == element) or (8 == element)) and avx2_available()) {
+      i = details::byte_shuffle_avx2(input, n, element, output);
+    }
+#endif
+    details::byte_shuffle_scalar(input, i, n, n, element, output);
+    std::copy(input + n*element, input + size, output + n*element);
+  }
+
+  inline void shuffle::byte_unshuffle(const unsigned char *input, size_type size, size_type element, unsigned char *output) noexcept {
+    const size_type n = (element > 1) ? size / element : 0;
+    size_type i = 0;
+#ifdef ACCIO_SHUFFLE_AVX2
+    if(((4 == element) or (8 == element)) and avx2_available()) {
+      i = details::byte_unshuffle_avx2(input, n, element, output);
+    }
+#endif
+    details::byte_unshuffle_scalar(input, i, n, n, element, output);
+    std::copy(input + n*element, input + size, output + n*element);
+  }
+
+  inline void shuffle::bit_shuffle(const unsigned char *input, size_type size, size_type element, unsigned char *output) noexcept {
+    const size_type ngroups = (element > 0) ? size / (8*element) : 0;
+    size_type g = 0;
+#ifdef ACCIO_SHUFFLE_AVX2
+    if(((4 == element) or (8 == element)) and avx2_available()) {
+      g = details::bit_shuffle_avx2(input, ngroups, element, output);
+    }
+#endif
+    details::bit_shuffle_scalar(input, g, ngroups, ngroups, element, output);
+    std::copy(input + 8*ngroups*element, input + size, output + 8*ngroups*element);
+  }
+
+  inline void shuffle::bit_unshuffle(const unsigned char *input, size_type size, size_type element, unsigned char *output) noexcept {
+    const size_type ngroups = (element > 0) ? size / (8*element) : 0;
+    size_type g = 0;
+#ifdef ACCIO_SHUFFLE_AVX2
+    if(((4 == element) or (8 == element)) and avx2_available()) {
+      g = details::bit_unshuffle_avx2(input, ngroups, element, output);
+    }
+#endif
+    details::bit_unshuffle_scalar(input, g, ngroups, ngroups, element, output);
+    std::copy(input + 8*ngroups*element, input + size, output + 8*ngroups*element);
+  }
+
+  inline bool shuffle::encode(types::option_word filter, const unsigned char *input, size_type size, unsigned char *output) noexcept {
+    switch(io::filter::type(filter)) {
+      case io::filter::none: std::copy(input, input + size, output); return true;
+      case io::filter::byte_shuffle: byte_shuffle(input, size, io::filter::element(filter), output); return true;
+      case io::filter::bit_shuffle: bit_shuffle(input, size, io::filter::element(filter), output); return true;
+      default: return false;
+    }
+  }
+
+  inline bool shuffle::decode(types::option_word filter, const unsigned char *input, size_type size, unsigned char *output) noexcept {
+    switch(io::filter::type(filter)) {
+      case io::filter::none: std::copy(input, input + size, output); return true;
+      case io::filter::byte_shuffle: byte_unshuffle(input, size, io::filter::element(filter), output); return true;
+      case io::filter::bit_shuffle: bit_unshuffle(input, size, io::filter::element(filter), output); return true;
+      default: return false;
+    }
+  }
+
+#ifdef ACCIO_SHUFFLE_AVX2
+  inline bool shuffle::avx2_available() noexcept {
+    static const bool available = __builtin_cpu_supports("avx2");
+    return available;
+  }
+#else
+  inline bool shuffle::avx2_available() noexcept {
+    return false;
+  }
+#endif
+
+}
+
+#endif  //  ACCIO_SHUFFLE_IMPL_H
@@ -11,24 +11,81 @@
 #ifndef ACCIO_STREAM_IMPL_H
 #define ACCIO_STREAM_IMPL_H 1
 
+#include <cstddef>
+#include <cstring>
+#include <new>
 #include <vector>
 
 namespace accio {
 
   // open a file
+  template <class charT, class copy>
+  inline stream<charT, copy>::~stream() {
+    if(io::open_state::closed != m_openstate) {
+      close();
+    }
+  }
+
   template <class charT, class copy>
   inline error_codes::code_type stream<charT, copy>::open(const std::string& fn, io::open_mode mode) noexcept {
     if((io::open_state::opened == m_openstate) or (io::open_state::error == m_openstate)) {
       return error_codes::stream::already_open;
     }
+    m_file_header = io::file_header();
+    m_file_size = 0;
+    m_features = 0;
+    m_swap_headers = false;
+    m_swap_data = false;
+    m_dictionary_written = false;
+    m_dictionaries.clear();
+    m_group_output.clear();
+    m_group_size = m_group_offset = 0;
+    m_group_position = -1;
+    struct stat st;
+    const bool empty = (0 != io::file::stat(fn.c_str(), &st)) or (0 == st.st_size);
+    // check the header of the file we append to
+    if((io::open_mode::write_append == mode) and not empty) {
+      auto file = io::file::open(fn.c_str(), "rb");
+      if(nullptr == file) {
+        return error_codes::stream::open_fail;
+      }
+      auto status = read_file_header(file);
+      io::file::close(file);
+      if(error_codes::stream::success != status) {
+        return status;
+      }
+      // records are appended in the plateform byte order
+      if(m_swap_headers or m_swap_data) {
+        return error_codes::stream::bad_byte_order;
+      }
+    }
     std::string mode_str = io::open_mode_str(mode);
     m_file = io::file::open(fn.c_str(), mode_str.c_str());
     if(nullptr == m_file) {
       return error_codes::stream::open_fail;
     }
+    auto status = error_codes::stream::success;
+    if((io::open_mode::read == mode) or (io::open_mode::read_write == mode)) {
+      status = read_file_header(m_file);
+    }
+    if((error_codes::stream::success == status) and (io::open_mode::read != mode) and (m_swap_headers or m_swap_data)) {
+      status = error_codes::stream::bad_byte_order;
+    }
+    if((error_codes::stream::success == status) and (io::open_mode::read != mode) and
+      ((io::open_mode::write_new == mode) or empty)) {
+      status = write_file_header();
+    }
+    if(error_codes::stream::success != status) {
+      io::file::close(m_file);
+      m_file = nullptr;
+      return status;
+    }
     m_fname = fn;
     m_openmode = mode;
     m_openstate = io::open_state::opened;
+    if(io::open_mode::read == mode) {
+      advise_file();
+    }
     // That's all folks!
     return error_codes::stream::success;
   }
@@ -39,55 +96,469 @@ namespace accio {
     if(io::open_state::closed == m_openstate) {
       return error_codes::stream::not_open;
     }
+    // write the pending group. The file is closed anyway
+    auto status = error_codes::stream::success;
+    if((io::open_state::opened == m_openstate) and (io::open_mode::read != m_openmode)) {
+      try {
+        status = flush_group();
+      }
+      catch(const std::bad_alloc &) {
+        status = error_codes::stream::no_alloc;
+      }
+      catch(...) {
+        status = error_codes::stream::bad_write;
+      }
+    }
+    // don't leave a verification running on the caller memory
+    if(m_checksum.pending()) {
+      m_checksum.wait();
+    }
+    // drop the pages read in streaming mode
+    if((io::access_mode::streaming == m_accessmode) and (io::open_mode::read == m_openmode)) {
+      const types::offset_type offset = io::file::tell(m_file);
+      if(offset > m_dropped_end) {
+        io::file::advise(m_file, m_dropped_end, offset - m_dropped_end, io::file::advice::dont_need);
+      }
+    }
+    // record the new features in the file header. Files opened
+    // in append mode can't be rewritten and are opened again
+    const bool update = (io::marker::file == m_file_header.m_marker) and
+      ((m_file_header.m_features | m_features) != m_file_header.m_features);
+    if(update and (io::open_mode::write_append != m_openmode) and not write_features(m_file)) {
+      status = error_codes::stream::bad_write;
+    }
     if(EOF == io::file::close(m_file)) {
       return error_codes::stream::go_to_eof;
     }
+    if(update and (io::open_mode::write_append == m_openmode)) {
+      auto file = io::file::open(m_fname.c_str(), "r+b");
+      if((nullptr == file) or not write_features(file)) {
+        status = error_codes::stream::bad_write;
+      }
+      if(nullptr != file) {
+        io::file::close(file);
+      }
+    }
     m_fname.clear();
     m_file = nullptr;
     m_openmode = io::open_mode::read; // default one ...
     m_openstate = io::open_state::closed;
     // That's all folks!
+    return status;
+  }
+
+  template <class charT, class copy>
+  inline void stream<charT, copy>::set_access_mode(io::access_mode mode, size_type readahead) {
+    m_accessmode = mode;
+    m_readahead = readahead;
+    if((io::open_state::opened == m_openstate) and (io::open_mode::read == m_openmode)) {
+      advise_file();
+    }
+  }
+
+  template <class charT, class copy>
+  inline void stream<charT, copy>::advise_file() {
+    auto advice = io::file::advice::normal;
+    switch(m_accessmode) {
+      case io::access_mode::sequential:
+      case io::access_mode::streaming:  advice = io::file::advice::sequential; break;
+      case io::access_mode::random:     advice = io::file::advice::random; break;
+      default: break;
+    }
+    io::file::advise(m_file, 0, 0, advice);
+    m_advised_end = m_dropped_end = io::file::tell(m_file);
+  }
+
+  template <class charT, class copy>
+  inline void stream<charT, copy>::advise_read() {
+    const types::offset_type offset = io::file::tell(m_file);
+    const types::offset_type window = static_cast<types::offset_type>(m_readahead);
+    // moved backward (seek): start again from here
+    if(offset + window < m_advised_end) {
+      m_advised_end = offset;
+    }
+    if(offset < m_dropped_end) {
+      m_dropped_end = offset;
+    }
+    // read the next window ahead when half of the previous one is read
+    if((window > 0) and (offset + window/2 >= m_advised_end)) {
+      const types::offset_type begin = (offset > m_advised_end) ? offset : m_advised_end;
+      io::file::advise(m_file, begin, offset + window - begin, io::file::advice::will_need);
+      m_advised_end = offset + window;
+    }
+    // drop the pages read, by large ranges
+    const types::offset_type drop_size = 1024*1024;
+    if((io::access_mode::streaming == m_accessmode) and (offset - m_dropped_end >= drop_size)) {
+      const types::offset_type end = offset & ~static_cast<types::offset_type>(drop_size - 1);
+      io::file::advise(m_file, m_dropped_end, end - m_dropped_end, io::file::advice::dont_need);
+      m_dropped_end = end;
+    }
+  }
+
+  template <class charT, class copy>
+  inline void stream<charT, copy>::set_dictionary(const compressor::dictionary_type &dict) {
+    // only the end of the dictionary is in reach of the deflate window
+    const std::size_t max_size = compressor::max_dictionary_size;
+    const std::size_t skip = (dict.size() > max_size) ? dict.size() - max_size : 0;
+    m_dictionary.assign(dict.begin() + skip, dict.end());
+    m_dictionary_id = m_dictionary.empty() ? 0 : (m_dictionary_id % 255) + 1;
+    m_dictionary_written = false;
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::write_file_header() noexcept {
+    typedef typename copy_type::buffer_type copy_buffer;
+    const types::marker_type order = io::marker::byte_order;
+    m_file_header.m_marker = io::marker::file;
+    m_file_header.m_version = io::format_version;
+    m_file_header.m_size = sizeof(io::file_header);
+    m_file_header.m_byte_order = order;
+    copy_type::memcpy(
+      reinterpret_cast<copy_buffer*>(&m_file_header.m_data_order),
+      reinterpret_cast<const copy_buffer*>(&order),
+      sizeof(order), 1);
+    m_file_header.m_features = 0;
+    if(1 != io::file::write(&m_file_header, sizeof(m_file_header), 1, m_file)) {
+      return error_codes::stream::bad_write;
+    }
+    return error_codes::stream::success;
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::read_file_header(file_type *file) noexcept {
+    typedef typename copy_type::buffer_type copy_buffer;
+    m_file_header = io::file_header();
+    io::file_header header;
+    auto nread = io::file::read(&header.m_marker, 1, sizeof(header.m_marker), file);
+    // empty file
+    if(0 == nread) {
+      return error_codes::stream::success;
+    }
+    if(sizeof(header.m_marker) != nread) {
+      return error_codes::stream::bad_header;
+    }
+    // file written without header
+    if(io::marker::record == header.m_marker) {
+      return (0 == io::file::seek(file, 0, SEEK_SET)) ? error_codes::stream::success : error_codes::stream::off_end;
+    }
+    // the byte order of the payloads is unknown without header
+    if(io::byte_swap(io::marker::record) == header.m_marker) {
+      return error_codes::stream::bad_byte_order;
+    }
+    const bool swap_headers = (io::byte_swap(io::marker::file) == header.m_marker);
+    if((io::marker::file != header.m_marker) and not swap_headers) {
+      return error_codes::stream::bad_header;
+    }
+    const std::size_t remaining = sizeof(header) - sizeof(header.m_marker);
+    if(remaining != io::file::read(reinterpret_cast<char*>(&header) + sizeof(header.m_marker), 1, remaining, file)) {
+      return error_codes::stream::bad_header;
+    }
+    // the data order is kept as written
+    if(swap_headers) {
+      header.m_marker = io::marker::file;
+      header.m_version = io::byte_swap(header.m_version);
+      header.m_size = io::byte_swap(header.m_size);
+      header.m_byte_order = io::byte_swap(header.m_byte_order);
+      header.m_features = io::byte_swap(header.m_features);
+    }
+    if((version::decode_major(header.m_version) != version::decode_major(io::format_version)) or
+      (header.m_size < sizeof(header))) {
+      return error_codes::stream::bad_header;
+    }
+    // the payloads are swapped on read only if the copy
+    // policy doesn't decode them in the plateform byte order
+    types::marker_type data_order = 0;
+    copy_type::memcpy(
+      reinterpret_cast<copy_buffer*>(&data_order),
+      reinterpret_cast<const copy_buffer*>(&header.m_data_order),
+      sizeof(data_order), 1);
+    if((io::marker::byte_order != header.m_byte_order) or
+      ((io::marker::byte_order != data_order) and (io::byte_swap(io::marker::byte_order) != data_order))) {
+      return error_codes::stream::bad_byte_order;
+    }
+    // skip the fields added by newer minor versions
+    if((header.m_size > sizeof(header)) and (0 != io::file::seek(file, header.m_size - sizeof(header), SEEK_CUR))) {
+      return error_codes::stream::off_end;
+    }
+    m_file_header = header;
+    m_swap_headers = swap_headers;
+    m_swap_data = (io::marker::byte_order != data_order);
     return error_codes::stream::success;
   }
 
+  template <class charT, class copy>
+  inline bool stream<charT, copy>::write_features(file_type *file) noexcept {
+    const types::option_word features = m_file_header.m_features | m_features;
+    if(0 != io::file::seek(file, offsetof(io::file_header, m_features), SEEK_SET)) {
+      return false;
+    }
+    if(1 != io::file::write(&features, sizeof(features), 1, file)) {
+      return false;
+    }
+    m_file_header.m_features = features;
+    return true;
+  }
 
   template <class charT, class copy>
+  template <class alloc>
   error_codes::code_type stream<charT, copy>::write_record(
     const io::record_header &header,
     const io::record_summary &summary,
-    const buffer_type &buffer) {
+    const buffer<char_type, copy_type, alloc> &buffer) {
+    if(io::open_state::opened != m_openstate) {
+      return error_codes::stream::not_open;
+    }
+    if(io::open_mode::read == m_openmode) {
+      return error_codes::stream::read_only;
+    }
+    auto payload = reinterpret_cast<const unsigned char*>(buffer.begin());
+    const size_type len = buffer.tell();
+    // the small compressed records are grouped
+    const bool grouped = (0 != m_group_target) and (len < m_group_target) and
+      (0 != (header.m_options & io::option::compression));
+    const types::option_word group_options = header.m_options & (io::option::compression | io::option::checksum);
+    if(not m_group_output.empty() and (not grouped or (group_options != m_group_options))) {
+      auto status = flush_group();
+      if(error_codes::stream::success != status) {
+        return status;
+      }
+    }
+    if(not grouped) {
+      return write_payload(header, summary, payload, len);
+    }
+    m_group_options = group_options;
+    append_entry(header, summary, payload, len);
+    if(m_group_output.size() >= m_group_target) {
+      return flush_group();
+    }
+    return error_codes::stream::success;
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::write_payload(
+    const io::record_header &header,
+    const io::record_summary &summary,
+    const unsigned char *payload,
+    size_type len) {
+    // the record as stored: compressed if it shrinks the payload
+    io::record_header stored = header;
+    stored.m_options &= ~(io::option::compression | io::option::filters | io::option::dictionary_record | io::option::dictionary);
+    stored.m_compsize = stored.m_uncompsize = len;
+    const int level = static_cast<int>(header.m_options & io::option::compression);
+    if((0 != level) and (len > 0)) {
+      // the dictionary is written once, before the first record using it
+      const bool use_dictionary = not m_dictionary.empty();
+      if(use_dictionary and not m_dictionary_written) {
+        auto status = write_dictionary();
+        if(error_codes::stream::success != status) {
+          return status;
+        }
+      }
+      auto compressed_len = compress_payload(level, summary, payload, len);
+      if((0 != compressed_len) and (compressed_len < len)) {
+        payload = m_compressor.data();
+        stored.m_compsize = compressed_len;
+        stored.m_options |= (header.m_options & io::option::compression);
+        stored.m_options |= use_dictionary ? (m_dictionary_id << 8) : 0;
+        if(not m_block_filters.empty()) {
+          stored.m_options |= io::option::filters;
+        }
+      }
+      else {
+        m_block_filters.clear();
+      }
+    }
+    else {
+      m_block_filters.clear();
+    }
+    return write_stored(stored, summary, payload);
+  }
+
+  template <class charT, class copy>
+  inline void stream<charT, copy>::append_entry(
+    const io::record_header &header,
+    const io::record_summary &summary,
+    const unsigned char *payload,
+    size_type len) {
+    // the entry layout: record header, summary and padded payload
+    io::disk_record_header disk_header;
+    disk_header.m_marker = io::marker::record;
+    disk_header.m_options = header.m_options & ~(io::option::compression | io::option::checksum |
+      io::option::size64 | io::option::filters | io::option::dictionary_record | io::option::dictionary | io::option::group);
+    disk_header.m_compsize = disk_header.m_uncompsize = static_cast<types::size_type>(len);
+    disk_header.m_name = header.m_name;
+    const types::size_type nblocks = summary.size();
+    const size_type padding = (4 - (len & io::marker::align)) & io::marker::align;
+    std::size_t offset = m_group_output.size();
+    m_group_output.resize(offset + sizeof(disk_header) + sizeof(nblocks) + nblocks*sizeof(io::disk_block_summary) + len + padding, 0);
+    unsigned char *entry = m_group_output.data() + offset;
+    std::memcpy(entry, &disk_header, sizeof(disk_header));
+    entry += sizeof(disk_header);
+    std::memcpy(entry, &nblocks, sizeof(nblocks));
+    entry += sizeof(nblocks);
+    for(auto &blk_summary : summary) {
+      io::disk_block_summary disk_summary;
+      disk_summary.m_version = blk_summary.m_version;
+      disk_summary.m_size = static_cast<types::size_type>(blk_summary.m_size);
+      disk_summary.m_type = blk_summary.m_type;
+      disk_summary.m_name = blk_summary.m_name;
+      std::memcpy(entry, &disk_summary, sizeof(disk_summary));
+      entry += sizeof(disk_summary);
+    }
+    if(len > 0) {
+      std::memcpy(entry, payload, len);
+    }
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::flush_group() {
+    if(m_group_output.empty()) {
+      return error_codes::stream::success;
+    }
+    io::record_header header;
+    header.m_marker = io::marker::record;
+    header.m_options = m_group_options | io::option::group;
+    header.m_compsize = header.m_uncompsize = m_group_output.size();
+    header.m_name = io::group_name();
+    io::record_summary summary(1);
+    summary[0].m_version = version::encode(1, 0);
+    summary[0].m_size = m_group_output.size();
+    summary[0].m_type = "accio::group";
+    summary[0].m_name = "records";
+    auto status = write_payload(header, summary, m_group_output.data(), m_group_output.size());
+    m_group_output.clear();
+    return status;
+  }
+
+  template <class charT, class copy>
+  inline types::size64_type stream<charT, copy>::dictionary_record_size() const {
+    return m_dictionary.empty() ? 0 : io::record_size(dictionary_header(), 1);
+  }
+
+  template <class charT, class copy>
+  inline io::record_header stream<charT, copy>::dictionary_header() const {
+    io::record_header header;
+    header.m_marker = io::marker::record;
+    header.m_options = io::option::checksum | io::option::dictionary_record | (m_dictionary_id << 8);
+    header.m_compsize = header.m_uncompsize = m_dictionary.size();
+    header.m_name = io::dictionary_name();
+    return header;
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::write_dictionary() {
+    const io::record_header header = dictionary_header();
+    io::record_summary summary(1);
+    summary[0].m_version = version::encode(1, 0);
+    summary[0].m_size = m_dictionary.size();
+    summary[0].m_type = "dictionary";
+    summary[0].m_name = "dictionary";
+    m_block_filters.clear();
+    auto status = write_stored(header, summary, m_dictionary.data());
+    m_dictionary_written = (error_codes::stream::success == status);
+    return status;
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::write_stored(
+    const io::record_header &stored,
+    const io::record_summary &summary,
+    const unsigned char *payload) {
+    types::size_type summary_size = summary.size();
+    size_type buffer_len = static_cast<size_type>(stored.m_compsize);
+    const bool has_checksum = (0 != (stored.m_options & io::option::checksum));
+    const bool size64 = io::is_size64(stored);
+    // encode the record header and summary in their file layout
+    io::disk_record_header disk_header;
+    disk_header.m_marker = stored.m_marker;
+    disk_header.m_options = size64 ? (stored.m_options | io::option::size64) : stored.m_options;
+    disk_header.m_compsize = static_cast<types::size_type>(size64 ? io::size32_max : stored.m_compsize);
+    disk_header.m_uncompsize = static_cast<types::size_type>(size64 ? io::size32_max : stored.m_uncompsize);
+    disk_header.m_name = stored.m_name;
+    m_disk_summary.resize(summary_size);
+    m_block_sizes.clear();
+    for(types::size_type b = 0 ; b < summary_size ; b++) {
+      auto &disk_summary = m_disk_summary[b];
+      disk_summary.m_version = summary[b].m_version;
+      disk_summary.m_size = static_cast<types::size_type>(size64 ? io::size32_max : summary[b].m_size);
+      disk_summary.m_type = summary[b].m_type;
+      disk_summary.m_name = summary[b].m_name;
+      if(size64) {
+        m_block_sizes.push_back(summary[b].m_size);
+      }
+    }
+    m_features |= io::record_features(disk_header.m_options);
     // write the record header
     // this header has a fixed size and
     // is by definition 32 bit padded
-    if(1 != io::file::write(&header, sizeof(header), 1, m_file)) {
+    if(1 != io::file::write(&disk_header, sizeof(disk_header), 1, m_file)) {
       m_openstate = io::open_state::error;
       return error_codes::stream::bad_write;
     }
+    if(size64) {
+      types::size64_type sizes[2] = {stored.m_compsize, stored.m_uncompsize};
+      if(1 != io::file::write(sizes, sizeof(sizes), 1, m_file)) {
+        m_openstate = io::open_state::error;
+        return error_codes::stream::bad_write;
+      }
+    }
     // write the record summary
     // 1) size of the summary
-    size_type summary_size = summary.size();
-    if(1 != io::file::write(&summary_size, sizeof(size_type), 1, m_file)) {
+    if(1 != io::file::write(&summary_size, sizeof(summary_size), 1, m_file)) {
       m_openstate = io::open_state::error;
       return error_codes::stream::bad_write;
     }
     // 2) the summary
-    size_type blk_size = sizeof(io::record_summary::value_type);
-    if(summary_size != io::file::write(&summary[0], blk_size, summary_size, m_file)) {
+    if(summary_size != io::file::write(m_disk_summary.data(), sizeof(io::disk_block_summary), summary_size, m_file)) {
+      m_openstate = io::open_state::error;
+      return error_codes::stream::bad_write;
+    }
+    // 3) the 64 bit block sizes
+    if(m_block_sizes.size() != io::file::write(m_block_sizes.data(), sizeof(types::size64_type), m_block_sizes.size(), m_file)) {
       m_openstate = io::open_state::error;
       return error_codes::stream::bad_write;
     }
-    // write the buffer
-    size_type buffer_len = buffer.tell();
-    if(buffer_len != io::file::write(buffer.begin(), 1, buffer_len, m_file)) {
+    // 4) the block filters
+    if(not m_block_filters.empty() and
+      (m_block_filters.size() != io::file::write(m_block_filters.data(), sizeof(types::option_word), m_block_filters.size(), m_file))) {
+      m_openstate = io::open_state::error;
+      return error_codes::stream::bad_write;
+    }
+    // compute the record checksum (summary + payload).
+    // For large payloads, this is done while writing the buffer
+    checksum::value_type crc = 0;
+    if(has_checksum) {
+      crc = summary_checksum();
+      if((buffer_len >= async_checksum_size) and checksum_worker::concurrent()) {
+        m_checksum.submit(payload, buffer_len, crc);
+      }
+      else {
+        crc = checksum::crc32c(payload, buffer_len, crc);
+      }
+    }
+    // write the payload
+    if(buffer_len != io::file::write(payload, 1, buffer_len, m_file)) {
+      if(m_checksum.pending()) {
+        m_checksum.wait();
+      }
       m_openstate = io::open_state::error;
       return error_codes::stream::bad_write;
     }
+    if(m_checksum.pending()) {
+      crc = m_checksum.wait();
+    }
     // Insert any necessary padding to make the next record header start
     // on a four byte boundary in the file (to make it directly accessible
-    // for xdr read).
+    // for xdr read), followed by the checksum
     size_type padding = (4 - (buffer_len & io::marker::align)) & io::marker::align;
-    if(padding > 0) {
-      if(padding != io::file::write('\0', 1, padding, m_file)) {
+    size_type trailer_len = padding;
+    unsigned char trailer[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    if(has_checksum) {
+      std::memcpy(trailer + padding, &crc, sizeof(crc));
+      trailer_len += sizeof(crc);
+    }
+    if(trailer_len > 0) {
+      if(trailer_len != io::file::write(trailer, 1, trailer_len, m_file)) {
         m_openstate = io::open_state::error;
         return error_codes::stream::bad_write;
       }
@@ -96,6 +567,664 @@ namespace accio {
     return error_codes::stream::success;
   }
 
+  template <class charT, class copy>
+  template <class alloc>
+  error_codes::code_type stream<charT, copy>::read_record(
+    io::record_header &header,
+    io::record_summary &summary,
+    buffer<char_type, copy_type, alloc> &buffer) {
+    // collect the previous asynchronous verification
+    // before the caller buffer gets overwritten
+    if(error_codes::stream::success != wait_checksum()) {
+      return error_codes::stream::bad_checksum;
+    }
+    // read the records of the current group first
+    while(not group_pending()) {
+      auto status = next_record_header(header);
+      if(error_codes::stream::success != status) {
+        return status;
+      }
+      status = read_summary(header, summary);
+      if(error_codes::stream::success != status) {
+        return status;
+      }
+      if(0 == (header.m_options & io::option::group)) {
+        return read_payload(header, summary, buffer);
+      }
+      status = load_group(header, summary);
+      if(error_codes::stream::success != status) {
+        return status;
+      }
+    }
+    auto status = read_entry(header, summary);
+    if(error_codes::stream::success == status) {
+      copy_entry(header, buffer);
+    }
+    return status;
+  }
+
+  template <class charT, class copy>
+  template <class alloc>
+  error_codes::code_type stream<charT, copy>::find_record(
+    const string32 &name,
+    io::record_header &header,
+    io::record_summary &summary,
+    buffer<char_type, copy_type, alloc> &buffer) {
+    if(error_codes::stream::success != wait_checksum()) {
+      return error_codes::stream::bad_checksum;
+    }
+    while(true) {
+      if(group_pending()) {
+        auto status = read_entry(header, summary);
+        if(error_codes::stream::success != status) {
+          return status;
+        }
+        if(header.m_name == name) {
+          copy_entry(header, buffer);
+          return error_codes::stream::success;
+        }
+        continue;
+      }
+      auto status = next_record_header(header);
+      if(error_codes::stream::success != status) {
+        return status;
+      }
+      status = read_summary(header, summary);
+      if(error_codes::stream::success != status) {
+        return status;
+      }
+      if(0 != (header.m_options & io::option::group)) {
+        status = load_group(header, summary);
+        if(error_codes::stream::success != status) {
+          return status;
+        }
+        continue;
+      }
+      if(header.m_name == name) {
+        return read_payload(header, summary, buffer);
+      }
+      status = skip_payload(header, 0);
+      if(error_codes::stream::success != status) {
+        return status;
+      }
+    }
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::next_header(
+    io::record_header &header,
+    io::record_summary *summary) {
+    if(group_pending()) {
+      return read_entry(header, (nullptr != summary) ? *summary : m_entry_summary);
+    }
+    auto status = next_record_header(header);
+    if(error_codes::stream::success != status) {
+      return status;
+    }
+    // the group is uncompressed to get the headers of its records
+    if(0 != (header.m_options & io::option::group)) {
+      status = read_summary(header, m_entry_summary);
+      if(error_codes::stream::success != status) {
+        return status;
+      }
+      status = load_group(header, m_entry_summary);
+      if(error_codes::stream::success != status) {
+        return status;
+      }
+      return next_header(header, summary);
+    }
+    return skip_stored(header, summary);
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::next_stored_header(
+    io::record_header &header,
+    io::record_summary *summary) {
+    m_group_offset = m_group_size;
+    auto status = read_header(header);
+    if(error_codes::stream::success != status) {
+      return status;
+    }
+    return skip_stored(header, summary);
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::skip_stored(
+    const io::record_header &header,
+    io::record_summary *summary) {
+    auto status = error_codes::stream::success;
+    types::size_type nblocks = 0;
+    if(nullptr != summary) {
+      status = read_summary(header, *summary);
+    }
+    else if(1 != io::file::read(&nblocks, sizeof(nblocks), 1, m_file)) {
+      status = error_codes::stream::off_end;
+    }
+    nblocks = header_order(nblocks);
+    if(error_codes::stream::success != status) {
+      return status;
+    }
+    return skip_payload(header, nblocks);
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::skip_record() {
+    io::record_header header;
+    return next_header(header);
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::read_header(io::record_header &header) {
+    if(io::open_state::opened != m_openstate) {
+      return error_codes::stream::not_open;
+    }
+    if((io::open_mode::read != m_openmode) and (io::open_mode::read_write != m_openmode)) {
+      return error_codes::stream::write_only;
+    }
+    if((io::access_mode::sequential == m_accessmode) or (io::access_mode::streaming == m_accessmode)) {
+      advise_read();
+    }
+    io::disk_record_header disk_header;
+    auto nread = io::file::read(&disk_header, 1, sizeof(disk_header), m_file);
+    if(0 == nread) {
+      return error_codes::stream::eof;
+    }
+    if(sizeof(disk_header) != nread) {
+      return error_codes::stream::off_end;
+    }
+    if(io::marker::record != header_order(disk_header.m_marker)) {
+      return error_codes::stream::no_record_marker;
+    }
+    header.m_marker = io::marker::record;
+    header.m_options = header_order(disk_header.m_options);
+    header.m_name = disk_header.m_name;
+    if(0 == (header.m_options & io::option::size64)) {
+      header.m_compsize = header_order(disk_header.m_compsize);
+      header.m_uncompsize = header_order(disk_header.m_uncompsize);
+      return error_codes::stream::success;
+    }
+    types::size64_type sizes[2];
+    if(1 != io::file::read(sizes, sizeof(sizes), 1, m_file)) {
+      return error_codes::stream::off_end;
+    }
+    header.m_compsize = header_order(sizes[0]);
+    header.m_uncompsize = header_order(sizes[1]);
+    return error_codes::stream::success;
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::next_record_header(io::record_header &header) {
+    while(true) {
+      auto status = read_header(header);
+      if((error_codes::stream::success != status) or (0 == (header.m_options & io::option::dictionary_record))) {
+        return status;
+      }
+      status = read_dictionary(header);
+      if(error_codes::stream::success != status) {
+        return status;
+      }
+    }
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::read_dictionary(const io::record_header &header) {
+    io::record_summary summary;
+    auto status = read_summary(header, summary);
+    if(error_codes::stream::success != status) {
+      return status;
+    }
+    const auto id = io::dictionary_id(header.m_options);
+    if((0 != (header.m_options & io::option::compression)) or (0 == id) or (header.m_compsize > compressor::max_dictionary_size)) {
+      return error_codes::stream::bad_compress;
+    }
+    if(m_dictionaries.size() <= id) {
+      m_dictionaries.resize(id + 1);
+    }
+    auto &dictionary = m_dictionaries[id];
+    const size_type len = static_cast<size_type>(header.m_compsize);
+    dictionary.resize(len);
+    if(len != io::file::read(dictionary.data(), 1, len, m_file)) {
+      return error_codes::stream::off_end;
+    }
+    const bool has_checksum = (0 != (header.m_options & io::option::checksum));
+    size_type padding = (4 - (len & io::marker::align)) & io::marker::align;
+    size_type trailer_len = padding + (has_checksum ? sizeof(checksum::value_type) : 0);
+    unsigned char trailer[8];
+    if((trailer_len > 0) and (trailer_len != io::file::read(trailer, 1, trailer_len, m_file))) {
+      return error_codes::stream::off_end;
+    }
+    // the dictionary checksum is always verified synchronously
+    if(has_checksum and (io::verify_mode::none != m_verifymode)) {
+      checksum::value_type expected = 0;
+      std::memcpy(&expected, trailer + padding, sizeof(expected));
+      if(checksum::crc32c(dictionary.data(), len, summary_checksum()) != header_order(expected)) {
+        dictionary.clear();
+        return error_codes::stream::bad_checksum;
+      }
+    }
+    return error_codes::stream::success;
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::load_dictionary(types::option_word id) {
+    const types::offset_type position = io::file::tell(m_file);
+    const types::offset_type first = (io::marker::file == m_file_header.m_marker) ? m_file_header.m_size : 0;
+    if(0 != io::file::seek(m_file, first, SEEK_SET)) {
+      return error_codes::stream::off_end;
+    }
+    // the dictionary record precedes the first record using it
+    io::record_header header;
+    auto status = error_codes::stream::success;
+    while((error_codes::stream::success == status) and ((m_dictionaries.size() <= id) or m_dictionaries[id].empty())) {
+      status = read_header(header);
+      if(error_codes::stream::success != status) {
+        break;
+      }
+      if(0 != (header.m_options & io::option::dictionary_record)) {
+        status = read_dictionary(header);
+        continue;
+      }
+      status = skip_stored(header, nullptr);
+    }
+    if(0 != io::file::seek(m_file, position, SEEK_SET)) {
+      return error_codes::stream::off_end;
+    }
+    return (error_codes::stream::eof == status) ? error_codes::stream::bad_compress : status;
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::load_group(const io::record_header &header, const io::record_summary &summary) {
+    m_group_size = m_group_offset = 0;
+    m_group_position = -1;
+    auto status = read_payload(header, summary, m_group_buffer);
+    if(error_codes::stream::success != status) {
+      return status;
+    }
+    m_group_next = io::file::tell(m_file);
+    m_group_position = m_group_next - static_cast<types::offset_type>(io::record_size(header, summary.size()));
+    m_group_size = static_cast<size_type>(header.m_uncompsize);
+    return error_codes::stream::success;
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::read_entry(io::record_header &header, io::record_summary &summary) {
+    const unsigned char *entry = reinterpret_cast<const unsigned char*>(m_group_buffer.begin()) + m_group_offset;
+    const types::size64_type remaining = m_group_size - m_group_offset;
+    // a corrupted group is dropped
+    m_group_offset = m_group_size;
+    io::disk_record_header disk_header;
+    types::size_type nblocks = 0;
+    if(remaining < sizeof(disk_header) + sizeof(nblocks)) {
+      return error_codes::stream::off_end;
+    }
+    std::memcpy(static_cast<void*>(&disk_header), entry, sizeof(disk_header));
+    std::memcpy(&nblocks, entry + sizeof(disk_header), sizeof(nblocks));
+    if(io::marker::record != header_order(disk_header.m_marker)) {
+      return error_codes::stream::no_record_marker;
+    }
+    header.m_marker = io::marker::record;
+    header.m_options = header_order(disk_header.m_options);
+    header.m_compsize = header.m_uncompsize = header_order(disk_header.m_compsize);
+    header.m_name = disk_header.m_name;
+    nblocks = header_order(nblocks);
+    const types::size64_type summary_offset = sizeof(disk_header) + sizeof(nblocks);
+    const types::size64_type payload_offset = summary_offset + static_cast<types::size64_type>(nblocks)*sizeof(io::disk_block_summary);
+    const types::size64_type entry_len = payload_offset + ((header.m_compsize + 3) & ~static_cast<types::size64_type>(3));
+    if(entry_len > remaining) {
+      return error_codes::stream::off_end;
+    }
+    summary.resize(nblocks);
+    for(types::size_type b = 0 ; b < nblocks ; b++) {
+      io::disk_block_summary disk_summary;
+      std::memcpy(static_cast<void*>(&disk_summary), entry + summary_offset + b*sizeof(disk_summary), sizeof(disk_summary));
+      summary[b].m_version = header_order(disk_summary.m_version);
+      summary[b].m_size = header_order(disk_summary.m_size);
+      summary[b].m_type = disk_summary.m_type;
+      summary[b].m_name = disk_summary.m_name;
+      summary[b].m_filter = io::filter::none;
+    }
+    m_entry_payload = entry + payload_offset;
+    m_group_offset = static_cast<size_type>(m_group_size - remaining + entry_len);
+    return error_codes::stream::success;
+  }
+
+  template <class charT, class copy>
+  template <class alloc>
+  inline void stream<charT, copy>::copy_entry(const io::record_header &header, buffer<char_type, copy_type, alloc> &buffer) {
+    const size_type len = static_cast<size_type>(header.m_compsize);
+    buffer.reset(len, std::ios_base::in);
+    buffer.set_byte_swap(m_swap_data);
+    if(len > 0) {
+      std::memcpy(buffer.begin(), m_entry_payload, len);
+    }
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::build_index(std::vector<io::record_position> &index) {
+    if(io::open_state::opened != m_openstate) {
+      return error_codes::stream::not_open;
+    }
+    if(error_codes::stream::success != wait_checksum()) {
+      return error_codes::stream::bad_checksum;
+    }
+    const types::offset_type first = (io::marker::file == m_file_header.m_marker) ? m_file_header.m_size : 0;
+    if(0 != io::file::seek(m_file, first, SEEK_SET)) {
+      return error_codes::stream::off_end;
+    }
+    m_group_offset = m_group_size;
+    index.clear();
+    io::record_header header;
+    auto status = error_codes::stream::success;
+    while(error_codes::stream::success == status) {
+      const types::offset_type offset = io::file::tell(m_file);
+      status = read_header(header);
+      if(error_codes::stream::success != status) {
+        break;
+      }
+      if(0 != (header.m_options & io::option::dictionary_record)) {
+        status = read_dictionary(header);
+        continue;
+      }
+      if(0 == (header.m_options & io::option::group)) {
+        index.push_back({offset, io::ungrouped});
+        status = skip_stored(header, nullptr);
+        continue;
+      }
+      status = read_summary(header, m_entry_summary);
+      if(error_codes::stream::success == status) {
+        status = load_group(header, m_entry_summary);
+      }
+      if(error_codes::stream::success == status) {
+        status = wait_checksum();
+      }
+      while((error_codes::stream::success == status) and group_pending()) {
+        index.push_back({offset, m_group_offset});
+        status = read_entry(header, m_entry_summary);
+      }
+    }
+    if(error_codes::stream::eof != status) {
+      return status;
+    }
+    // rewind to the first record
+    m_group_offset = m_group_size;
+    return (0 == io::file::seek(m_file, first, SEEK_SET)) ? error_codes::stream::success : error_codes::stream::off_end;
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::seek_record(const io::record_position &position) {
+    if(io::open_state::opened != m_openstate) {
+      return error_codes::stream::not_open;
+    }
+    if(error_codes::stream::success != wait_checksum()) {
+      return error_codes::stream::bad_checksum;
+    }
+    m_group_offset = m_group_size;
+    if(io::ungrouped == position.m_group_offset) {
+      return (0 == io::file::seek(m_file, position.m_offset, SEEK_SET)) ? error_codes::stream::success : error_codes::stream::off_end;
+    }
+    // read the group if not the last one read
+    if(position.m_offset == m_group_position) {
+      if(0 != io::file::seek(m_file, m_group_next, SEEK_SET)) {
+        return error_codes::stream::off_end;
+      }
+    }
+    else {
+      if(0 != io::file::seek(m_file, position.m_offset, SEEK_SET)) {
+        return error_codes::stream::off_end;
+      }
+      io::record_header header;
+      auto status = read_header(header);
+      if(error_codes::stream::success != status) {
+        return status;
+      }
+      if(0 == (header.m_options & io::option::group)) {
+        return error_codes::stream::no_such_record;
+      }
+      status = read_summary(header, m_entry_summary);
+      if(error_codes::stream::success == status) {
+        status = load_group(header, m_entry_summary);
+      }
+      if(error_codes::stream::success != status) {
+        return status;
+      }
+    }
+    if(position.m_group_offset >= m_group_size) {
+      m_group_offset = m_group_size;
+      return error_codes::stream::no_such_record;
+    }
+    m_group_offset = static_cast<size_type>(position.m_group_offset);
+    return error_codes::stream::success;
+  }
+
+  template <class charT, class copy>
+  inline bool stream<charT, copy>::in_file(types::size64_type len) {
+    const types::offset_type offset = io::file::tell(m_file);
+    if((offset >= 0) and (offset <= m_file_size) and (len <= static_cast<types::size64_type>(m_file_size - offset))) {
+      return true;
+    }
+    m_file_size = io::file::size(m_file);
+    return (offset >= 0) and (offset <= m_file_size) and (len <= static_cast<types::size64_type>(m_file_size - offset));
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::read_summary(const io::record_header &header, io::record_summary &summary) {
+    types::size_type summary_size = 0;
+    if(1 != io::file::read(&summary_size, sizeof(summary_size), 1, m_file)) {
+      return error_codes::stream::off_end;
+    }
+    summary_size = header_order(summary_size);
+    const bool size64 = (0 != (header.m_options & io::option::size64));
+    const bool filters = (0 != (header.m_options & io::option::filters));
+    // don't trust a corrupted block count with the allocations below
+    const types::size64_type summary_len = static_cast<types::size64_type>(summary_size) *
+      (sizeof(io::disk_block_summary) + (size64 ? sizeof(types::size64_type) : 0) + (filters ? sizeof(types::option_word) : 0));
+    if((summary_len > checked_size) and not in_file(summary_len)) {
+      return error_codes::stream::off_end;
+    }
+    m_disk_summary.resize(summary_size);
+    if(summary_size != io::file::read(m_disk_summary.data(), sizeof(io::disk_block_summary), summary_size, m_file)) {
+      return error_codes::stream::off_end;
+    }
+    m_block_sizes.resize(size64 ? summary_size : 0);
+    if(m_block_sizes.size() != io::file::read(m_block_sizes.data(), sizeof(types::size64_type), m_block_sizes.size(), m_file)) {
+      return error_codes::stream::off_end;
+    }
+    m_block_filters.resize(filters ? summary_size : 0);
+    if(not m_block_filters.empty() and
+      (m_block_filters.size() != io::file::read(m_block_filters.data(), sizeof(types::option_word), m_block_filters.size(), m_file))) {
+      return error_codes::stream::off_end;
+    }
+    summary.resize(summary_size);
+    for(types::size_type b = 0 ; b < summary_size ; b++) {
+      auto &disk_summary = m_disk_summary[b];
+      summary[b].m_version = header_order(disk_summary.m_version);
+      summary[b].m_size = size64 ? header_order(m_block_sizes[b]) : header_order(disk_summary.m_size);
+      summary[b].m_type = disk_summary.m_type;
+      summary[b].m_name = disk_summary.m_name;
+      summary[b].m_filter = filters ? header_order(m_block_filters[b]) : io::filter::none;
+    }
+    return error_codes::stream::success;
+  }
+
+  template <class charT, class copy>
+  template <class alloc>
+  error_codes::code_type stream<charT, copy>::read_payload(
+    const io::record_header &header,
+    const io::record_summary &summary,
+    buffer<char_type, copy_type, alloc> &buffer) {
+    const bool has_checksum = (0 != (header.m_options & io::option::checksum));
+    const bool compressed = (0 != (header.m_options & io::option::compression));
+    // read the payload, in the buffer if not compressed
+    size_type buffer_len = static_cast<size_type>(header.m_compsize);
+    // don't trust corrupted sizes with the allocations below
+    if((buffer_len > checked_size) and not in_file(buffer_len)) {
+      return error_codes::stream::off_end;
+    }
+    if(compressed and (header.m_uncompsize > static_cast<types::size64_type>(buffer_len) * compressor::max_ratio)) {
+      return error_codes::stream::bad_compress;
+    }
+    unsigned char *payload = nullptr;
+    if(compressed) {
+      m_compressed.resize(buffer_len);
+      payload = m_compressed.data();
+    }
+    else {
+      buffer.reset(buffer_len, std::ios_base::in);
+      payload = reinterpret_cast<unsigned char*>(buffer.begin());
+    }
+    buffer.set_byte_swap(m_swap_data);
+    if(buffer_len != io::file::read(payload, 1, buffer_len, m_file)) {
+      return error_codes::stream::off_end;
+    }
+    // read the padding and the checksum
+    size_type padding = (4 - (buffer_len & io::marker::align)) & io::marker::align;
+    size_type trailer_len = padding + (has_checksum ? sizeof(checksum::value_type) : 0);
+    unsigned char trailer[8];
+    if((trailer_len > 0) and (trailer_len != io::file::read(trailer, 1, trailer_len, m_file))) {
+      return error_codes::stream::off_end;
+    }
+    // verify the checksum of the stored payload
+    if(has_checksum and (io::verify_mode::none != m_verifymode)) {
+      checksum::value_type crc = summary_checksum();
+      std::memcpy(&m_expected_checksum, trailer + padding, sizeof(m_expected_checksum));
+      m_expected_checksum = header_order(m_expected_checksum);
+      if(io::verify_mode::async == m_verifymode) {
+        m_checksum.submit(payload, buffer_len, crc);
+      }
+      else if(checksum::crc32c(payload, buffer_len, crc) != m_expected_checksum) {
+        return error_codes::stream::bad_checksum;
+      }
+    }
+    if(not compressed) {
+      return error_codes::stream::success;
+    }
+    // uncompress in the buffer and revert the block filters
+    const size_type uncompressed_len = static_cast<size_type>(header.m_uncompsize);
+    buffer.reset(uncompressed_len, std::ios_base::in);
+    auto data = reinterpret_cast<unsigned char*>(buffer.begin());
+    const compressor::dictionary_type *dictionary = nullptr;
+    const auto id = io::dictionary_id(header.m_options);
+    if(0 != id) {
+      // the dictionary record is not read yet after a seek
+      if((m_dictionaries.size() <= id) or m_dictionaries[id].empty()) {
+        auto status = load_dictionary(id);
+        if(error_codes::stream::success != status) {
+          return status;
+        }
+      }
+      dictionary = &m_dictionaries[id];
+    }
+    if(not m_decompressor.uncompress(payload, buffer_len, data, uncompressed_len, dictionary)) {
+      return error_codes::stream::bad_compress;
+    }
+    if((0 != (header.m_options & io::option::filters)) and not unfilter_payload(summary, data, uncompressed_len)) {
+      return error_codes::stream::bad_compress;
+    }
+    // That's all folks!
+    return error_codes::stream::success;
+  }
+
+  template <class charT, class copy>
+  inline typename stream<charT, copy>::size_type stream<charT, copy>::compress_payload(
+    int level,
+    const io::record_summary &summary,
+    const unsigned char *payload,
+    size_type len) {
+    if(not m_compressor.begin(level, len, m_dictionary.empty() ? nullptr : &m_dictionary)) {
+      return 0;
+    }
+    // the filtered blocks are compressed from a copy, the
+    // others directly from the record buffer
+    bool filtered = false;
+    m_block_filters.assign(summary.size(), types::option_word(io::filter::none));
+    size_type offset = 0;
+    for(std::size_t b = 0 ; b < summary.size() ; b++) {
+      const size_type block_len = static_cast<size_type>(summary[b].m_size);
+      if(offset + block_len > len) {
+        break;
+      }
+      const unsigned char *data = payload + offset;
+      if(io::filter::none != summary[b].m_filter) {
+        if(m_filtered.size() < block_len) {
+          m_filtered.resize(block_len);
+        }
+        // unknown filters are ignored
+        if(shuffle::encode(summary[b].m_filter, data, block_len, m_filtered.data())) {
+          data = m_filtered.data();
+          m_block_filters[b] = summary[b].m_filter;
+          filtered = true;
+        }
+      }
+      if(not m_compressor.update(data, block_len)) {
+        return 0;
+      }
+      offset += block_len;
+    }
+    if(not m_compressor.update(payload + offset, len - offset)) {
+      return 0;
+    }
+    if(not filtered) {
+      m_block_filters.clear();
+    }
+    return m_compressor.finish();
+  }
+
+  template <class charT, class copy>
+  inline bool stream<charT, copy>::unfilter_payload(const io::record_summary &summary, unsigned char *payload, size_type len) {
+    size_type offset = 0;
+    for(auto &blk_summary : summary) {
+      const size_type block_len = static_cast<size_type>(blk_summary.m_size);
+      if(offset + block_len > len) {
+        return false;
+      }
+      if(io::filter::none != blk_summary.m_filter) {
+        if(m_filtered.size() < block_len) {
+          m_filtered.resize(block_len);
+        }
+        std::memcpy(m_filtered.data(), payload + offset, block_len);
+        if(not shuffle::decode(blk_summary.m_filter, m_filtered.data(), block_len, payload + offset)) {
+          return false;
+        }
+      }
+      offset += block_len;
+    }
+    return true;
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::skip_payload(const io::record_header &header, types::size_type nblocks) {
+    // the remaining part of the record: the block summaries
+    // not read yet, the padded payload and the checksum
+    const types::size64_type remaining = io::summary_size(header, nblocks) + io::payload_size(header);
+    // seeking past the end succeeds: a truncated record must be caught here
+    if(not in_file(remaining)) {
+      return error_codes::stream::off_end;
+    }
+    if(0 != io::file::seek(m_file, static_cast<types::offset_type>(remaining), SEEK_CUR)) {
+      return error_codes::stream::off_end;
+    }
+    return error_codes::stream::success;
+  }
+
+  template <class charT, class copy>
+  inline checksum::value_type stream<charT, copy>::summary_checksum() const {
+    types::size_type summary_size = m_disk_summary.size();
+    // the summary size as written in the file
+    const types::size_type disk_summary_size = header_order(summary_size);
+    checksum::value_type crc = checksum::crc32c(&disk_summary_size, sizeof(disk_summary_size));
+    crc = checksum::crc32c(m_disk_summary.data(), sizeof(io::disk_block_summary)*summary_size, crc);
+    crc = checksum::crc32c(m_block_sizes.data(), sizeof(types::size64_type)*m_block_sizes.size(), crc);
+    return checksum::crc32c(m_block_filters.data(), sizeof(types::option_word)*m_block_filters.size(), crc);
+  }
+
+  template <class charT, class copy>
+  inline error_codes::code_type stream<charT, copy>::wait_checksum() {
+    if(m_checksum.pending() and (m_checksum.wait() != m_expected_checksum)) {
+      return error_codes::stream::bad_checksum;
+    }
+    return error_codes::stream::success;
+  }
+
 }
 
 #endif  //  ACCIO_STREAM_IMPL_H
@@ -13,10 +13,118 @@
 
 namespace accio {
 
+  template <typename config>
+  inline file_writer<config>::~file_writer() {
+    if(not m_shards.empty()) {
+      close();
+    }
+  }
+
   /// Open a file in write mode
   template <typename config>
   error_codes::code_type file_writer<config>::open(const std::string &fname) {
-    return m_stream.open(fname, io::open_mode::write_new);
+    return open(std::vector<std::string>{fname});
+  }
+
+  /// Open the shard files in write mode
+  template <typename config>
+  error_codes::code_type file_writer<config>::open(const std::vector<std::string> &patterns) {
+    if(not m_shards.empty()) {
+      return error_codes::stream::already_open;
+    }
+    if(patterns.empty()) {
+      return error_codes::stream::bad_pattern;
+    }
+    if((patterns.size() > 1) or rotation()) {
+      for(auto &pattern : patterns) {
+        if(std::string::npos == pattern.find("{}")) {
+          return error_codes::stream::bad_pattern;
+        }
+      }
+    }
+    m_files.clear();
+    m_next_shard = 0;
+    for(auto &pattern : patterns) {
+      m_shards.emplace_back(new shard());
+      m_shards.back()->m_pattern = pattern;
+      m_shards.back()->m_stream.set_dictionary(m_dictionary);
+      m_shards.back()->m_stream.set_grouping(m_grouping);
+      auto status = open_shard(*m_shards.back());
+      if(error_codes::stream::success != status) {
+        close();
+        return status;
+      }
+    }
+    return error_codes::stream::success;
+  }
+
+  /// Close the file(s)
+  template <typename config>
+  error_codes::code_type file_writer<config>::close() {
+    if(m_shards.empty()) {
+      return error_codes::stream::not_open;
+    }
+    auto status = error_codes::stream::success;
+    for(auto &output : m_shards) {
+      if(io::open_state::closed == output->m_stream.open_state()) {
+        continue;
+      }
+      auto shard_status = output->m_stream.close();
+      if(error_codes::stream::success != shard_status) {
+        status = shard_status;
+      }
+    }
+    m_shards.clear();
+    return status;
+  }
+
+  template <typename config>
+  inline void file_writer<config>::set_dictionary(const compressor::dictionary_type &dict) {
+    m_dictionary = dict;
+    for(auto &output : m_shards) {
+      output->m_stream.set_dictionary(m_dictionary);
+    }
+  }
+
+  template <typename config>
+  inline void file_writer<config>::set_grouping(std::size_t target) {
+    m_grouping = target;
+    for(auto &output : m_shards) {
+      output->m_stream.set_grouping(m_grouping);
+    }
+  }
+
+  template <typename config>
+  inline void file_writer<config>::train_dictionary(std::size_t nrecords, std::size_t size) {
+    m_training_records = nrecords;
+    m_training_size = size;
+    m_training_samples.clear();
+  }
+
+  template <typename config>
+  inline std::string file_writer<config>::file_name(const std::string &pattern, std::size_t index) {
+    auto pos = pattern.find("{}");
+    if(std::string::npos == pos) {
+      return pattern;
+    }
+    std::string idx = std::to_string(index);
+    if(idx.size() < 4) {
+      idx.insert(0, 4 - idx.size(), '0');
+    }
+    return pattern.substr(0, pos) + idx + pattern.substr(pos + 2);
+  }
+
+  template <typename config>
+  error_codes::code_type file_writer<config>::open_shard(shard &output) {
+    auto fname = file_name(output.m_pattern, output.m_index);
+    auto status = output.m_stream.open(fname, io::open_mode::write_new);
+    if(error_codes::stream::success != status) {
+      return status;
+    }
+    m_files.push_back(fname);
+    output.m_size = sizeof(io::file_header);
+    output.m_records = 0;
+    return error_codes::stream::success;
   }
 
   // write a record
@@ -25,31 +133,58 @@ namespace accio {
     const string32 &name,
     const record_io &io_config,
     const record_type &rec) {
-      // check stream state
-    if(m_stream.open_state() != io::open_state::opened) {
+    // check stream state
+    if(m_shards.empty()) {
       return error_codes::stream::not_open;
     }
-    // create block writers from user record config
+    io::record_header rec_header;
+    auto status = serialize_record(name, io_config, rec, rec_header, m_summary, m_buffer, m_writers);
+    if(error_codes::record::success != status) {
+      return status;
+    }
+    return write_record(rec_header, m_summary, m_buffer);
+  }
+
+  // serialize a record
+  template <typename config>
+  error_codes::code_type file_writer<config>::serialize_record(
+    const string32 &name,
+    const record_io &io_config,
+    const record_type &rec,
+    io::record_header &rec_header,
+    io::record_summary &rec_summary,
+    buffer_type &outbuf) const {
     block_writers writers;
+    return serialize_record(name, io_config, rec, rec_header, rec_summary, outbuf, writers);
+  }
+
+  // serialize a record, reusing the block writers list
+  template <typename config>
+  error_codes::code_type file_writer<config>::serialize_record(
+    const string32 &name,
+    const record_io &io_config,
+    const record_type &rec,
+    io::record_header &rec_header,
+    io::record_summary &rec_summary,
+    buffer_type &outbuf,
+    block_writers &writers) const {
+    // create block writers from user record config
+    writers.clear();
     auto status = io_config.create_writers(rec, writers);
-    // tools for writting
-    io::record_summary rec_summary;
-    io::record_header rec_header;
-    buffer<char_type, copy_type> outbuf;
-    // fill the record header
-    rec_header.m_marker = io::marker::record;
-    rec_header.m_options = 0; // TODO fill this !
-    rec_header.m_compsize = 0;
-    rec_header.m_uncompsize = 0; // TODO deal with compression !
-    rec_header.m_name = name;
+    if(error_codes::record::success != status) {
+      io_config.release_writers(writers);
+      writers.clear();
+      return status;
+    }
+    begin_record(name, rec_header, rec_summary, outbuf);
     // write blocks in the buffer
-    for(auto writer : writers) {
+    for(auto &writer : writers) {
       auto begin_pos = outbuf.tell();
       auto status = writer->write(outbuf);
       if(error_codes::block::success != status) {
         std::cout << "ERROR - Couldn't write block:" << std::endl;
-        std::cout << "  => type: " << writer->type() << std::endl;
-        std::cout << "  => name: " << writer->name() << std::endl;
+        std::cout << "  => type: " << writer->type().c_str() << std::endl;
+        std::cout << "  => name: " << writer->name().c_str() << std::endl;
         std::cout << "  => version: " << writer->version() << std::endl;
         std::cout << "Skipping ..." << std::endl;
         outbuf.seekpos(begin_pos);
@@ -58,26 +193,136 @@ namespace accio {
       auto new_pos = outbuf.tell();
       if(new_pos <= begin_pos) {
         std::cout << "ERROR - Invalid buffer pointer after block writing:" << std::endl;
-        std::cout << "  => type: " << writer->type() << std::endl;
-        std::cout << "  => name: " << writer->name() << std::endl;
+        std::cout << "  => type: " << writer->type().c_str() << std::endl;
+        std::cout << "  => name: " << writer->name().c_str() << std::endl;
         std::cout << "  => version: " << writer->version() << std::endl;
         std::cout << "Skipping ..." << std::endl;
         outbuf.seekpos(begin_pos);
         continue;
       }
-      // fill the block summary and add it to record summary
-      io::block_summary blk_summary;
-      blk_summary.m_version = writer->version();
-      blk_summary.m_type = writer->type();
-      blk_summary.m_name = writer->name();
-      blk_summary.m_size = (new_pos - begin_pos);
-      rec_summary.push_back(blk_summary);
-      // fill un-compressed total size
-      rec_header.m_uncompsize = new_pos;
-    }
-    // TODO deal with compression
+      // fill the block summary and add it to record summary.
+      // The strings are copied, not default constructed then assigned
+      rec_summary.push_back(io::block_summary{writer->version(), new_pos - begin_pos, writer->type(), writer->name(), writer->filter()});
+    }
+    end_record(rec_header, outbuf);
+    io_config.release_writers(writers);
+    writers.clear();
+    return error_codes::record::success;
+  }
+
+  // write a record with a static schema
+  template <typename config>
+  template <typename... blocks>
+  error_codes::code_type file_writer<config>::write_record(
+    const string32 &name,
+    const record_schema<config, blocks...> &schema,
+    const record_type &rec) {
+    // check stream state
+    if(m_shards.empty()) {
+      return error_codes::stream::not_open;
+    }
+    io::record_header rec_header;
+    serialize_record(name, schema, rec, rec_header, m_summary, m_buffer);
+    return write_record(rec_header, m_summary, m_buffer);
+  }
+
+  // serialize a record with a static schema
+  template <typename config>
+  template <typename... blocks>
+  error_codes::code_type file_writer<config>::serialize_record(
+    const string32 &name,
+    const record_schema<config, blocks...> &schema,
+    const record_type &rec,
+    io::record_header &rec_header,
+    io::record_summary &rec_summary,
+    buffer_type &outbuf) const {
+    begin_record(name, rec_header, rec_summary, outbuf);
+    schema.write_blocks(rec, outbuf, rec_summary);
+    end_record(rec_header, outbuf);
+    return error_codes::record::success;
+  }
+
+  template <typename config>
+  inline void file_writer<config>::begin_record(
+    const string32 &name,
+    io::record_header &rec_header,
+    io::record_summary &rec_summary,
+    buffer_type &outbuf) const {
+    rec_summary.clear();
+    outbuf.reset(outbuf.memsize(), std::ios_base::out);
+    // fill the record header
+    rec_header.m_marker = io::marker::record;
+    rec_header.m_options = (m_checksum ? io::option::checksum : 0) | (m_compression & io::option::compression);
+    rec_header.m_compsize = 0;
+    rec_header.m_uncompsize = 0;
+    rec_header.m_name = name;
+  }
+
+  template <typename config>
+  inline void file_writer<config>::end_record(io::record_header &rec_header, const buffer_type &outbuf) const {
+    // the skipped blocks are rewinded: the buffer ends with the last block
+    rec_header.m_uncompsize = outbuf.tell();
+    // the record is compressed by the stream when written
     rec_header.m_compsize = rec_header.m_uncompsize;
-    m_stream.write_record(rec_header, rec_summary, outbuf);
+  }
+
+  // write a serialized record
+  template <typename config>
+  error_codes::code_type file_writer<config>::write_record(
+    const io::record_header &rec_header,
+    const io::record_summary &rec_summary,
+    const buffer_type &outbuf) {
+    // check stream state
+    if(m_shards.empty()) {
+      return error_codes::stream::not_open;
+    }
+    shard &output = *m_shards[m_next_shard];
+    if(output.m_stream.open_state() != io::open_state::opened) {
+      return error_codes::stream::not_open;
+    }
+    error_codes::code_type status;
+    // rotate the file if the record doesn't fit
+    const std::size_t record_size = io::record_size(rec_header, rec_summary.size());
+    if(rotation() and (output.m_records > 0)) {
+      // the dictionary record precedes the first compressed record of each file
+      const bool with_dictionary = (0 != m_compression) and not output.m_stream.dictionary_written();
+      const std::size_t dictionary_size = with_dictionary ? output.m_stream.dictionary_record_size() : 0;
+      const bool size_limit = (0 != m_max_size) and (output.m_size + dictionary_size + record_size > m_max_size);
+      const bool records_limit = (0 != m_max_records) and (output.m_records >= m_max_records);
+      if(size_limit or records_limit) {
+        status = output.m_stream.close();
+        if(error_codes::stream::success != status) {
+          return status;
+        }
+        output.m_index++;
+        status = open_shard(output);
+        if(error_codes::stream::success != status) {
+          return status;
+        }
+      }
+    }
+    const bool dictionary_written = output.m_stream.dictionary_written();
+    status = output.m_stream.write_record(rec_header, rec_summary, outbuf);
+    if(error_codes::stream::success != status) {
+      return status;
+    }
+    if(not dictionary_written and output.m_stream.dictionary_written()) {
+      output.m_size += output.m_stream.dictionary_record_size();
+    }
+    // sample the payload to train the dictionary
+    if((0 != m_training_records) and (0 != m_compression)) {
+      auto payload = reinterpret_cast<const unsigned char*>(outbuf.begin());
+      m_training_samples.emplace_back(payload, payload + static_cast<std::size_t>(rec_header.m_uncompsize));
+      if(m_training_samples.size() >= m_training_records) {
+        set_dictionary(compressor::train_dictionary(m_training_samples, m_training_size));
+        m_training_samples.clear();
+        m_training_records = 0;
+      }
+    }
+    output.m_size += record_size;
+    output.m_records++;
+    m_next_shard = (m_next_shard + 1) % m_shards.size();
+    return error_codes::stream::success;
   }
 
 }
@@ -0,0 +1,84 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_ENCODING_H
+#define ACCIO_ENCODING_H 1
+
+// -- std headers
+#include <type_traits>
+#include <vector>
+
+#include <accio/definitions.h>
+#include <accio/bitpack.h>
+
+namespace accio {
+
+  /// Integer array encodings. The referenced encodings store the
+  /// difference of each value to the minimum of the array (frame of
+  /// reference), after an optional delta transform. Sorted arrays
+  /// (indices, timestamps) are stored in a few bits per value.
+  /// Small range values (flags, status codes) are packed as is
+  enum class encoding : types::option_word {
+    raw = 0,                  ///< the values are copied as is
+    frame_of_reference = 1,   ///< the values are bit packed
+    delta = 2,                ///< the differences of consecutive values are bit packed
+    delta_of_delta = 3,       ///< the differences of consecutive deltas are bit packed
+    packed = 4,               ///< the values are bit packed as is (see write_packed())
+    automatic = 0xff          ///< the encoding giving the smallest bit width
+  };
+
+  /// Write an array of integers with an encoding, chosen per array by the
+  /// block writer. The encoded array is made of the number of values, an
+  /// encoding word (encoding, bit width and value size), the references
+  /// (first values and minimum) and the bit packed values, stored as 32 bit
+  /// words converted by the copy policy (see bitpack).
+  /// Returns the number of bytes written, 0 on failure
+  template <typename buffer_type, typename T, typename A>
+  typename buffer_type::size_type write_encoded(buffer_type &outbuf, const std::vector<T, A> &data, encoding enc);
+
+  /// Write an array of small range integers (flags, status codes) bit packed
+  /// with a declared width, i.e 'bits' bits per value, in two's complement for
+  /// signed types. The array is read with read_encoded() or read_packed().
+  /// Returns the number of bytes written, 0 on failure or if a value
+  /// doesn't fit in 'bits' bits
+  template <typename buffer_type, typename T, typename A>
+  typename buffer_type::size_type write_packed(buffer_type &outbuf, const std::vector<T, A> &data, unsigned int bits);
+
+  /// Write an array of bools, one bit per value. As std::vector<bool> is
+  /// accessed bit by bit, arrays of 0/1 bytes packed with a width of one
+  /// bit are faster to read back, with the same layout.
+  /// Returns the number of bytes written, 0 on failure
+  template <typename buffer_type, typename A>
+  typename buffer_type::size_type write_packed(buffer_type &outbuf, const std::vector<bool, A> &data);
+
+  /// Read an array of integers written with write_encoded(). The values are
+  /// unpacked by blocks with SIMD shifts when available. The value type
+  /// must have the size of the written one.
+  /// Returns the number of bytes read, 0 on failure
+  template <typename buffer_type, typename T, typename A>
+  typename buffer_type::size_type read_encoded(buffer_type &inbuf, std::vector<T, A> &data);
+
+  /// Read an array of integers written with write_packed(), see read_encoded()
+  template <typename buffer_type, typename T, typename A>
+  typename buffer_type::size_type read_packed(buffer_type &inbuf, std::vector<T, A> &data);
+
+  /// Read an array of bools written with write_packed().
+  /// Returns the number of bytes read, 0 on failure
+  template <typename buffer_type, typename A>
+  typename buffer_type::size_type read_packed(buffer_type &inbuf, std::vector<bool, A> &data);
+
+  /// Get the encoding giving the smallest bit width for an array
+  template <typename T, typename A>
+  encoding best_encoding(const std::vector<T, A> &data);
+}
+
+#include <accio/details/encoding_impl.h>
+
+#endif  //  ACCIO_ENCODING_H
@@ -0,0 +1,111 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_HUGE_PAGE_ALLOCATOR_H
+#define ACCIO_HUGE_PAGE_ALLOCATOR_H 1
+
+// -- std headers
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace accio {
+
+  namespace details {
+
+    /// The transparent huge page size
+    constexpr std::size_t huge_page_size = 2*1024*1024;
+
+    /// Map 'size' bytes aligned on the huge page size and advise the
+    /// kernel to back them with huge pages. Returns nullptr if the
+    /// memory can't be mapped or if mapping is not supported
+    void *huge_page_map(std::size_t size) noexcept;
+
+    /// Map 'size' bytes rounded up to the huge page size, without
+    /// alignment nor advice: the fallback when huge_page_map() fails, e.g
+    /// on the extra huge page it maps for alignment. Returns nullptr if the
+    /// memory can't be mapped or if mapping is not supported
+    void *page_map(std::size_t size) noexcept;
+
+    /// Unmap memory mapped by huge_page_map() or page_map() with the same size
+    void huge_page_unmap(void *ptr, std::size_t size) noexcept;
+
+    /// Whether the memory is mapped by huge_page_map() on this platform
+    bool huge_page_mapping() noexcept;
+  }
+
+  /// Whether transparent huge pages are available: the kernel setting
+  /// is 'always' or 'madvise'. If not, the huge_page_allocator still maps
+  /// its large allocations but they are backed by normal pages
+  bool huge_pages_enabled();
+
+  /// huge_page_allocator class
+  ///
+  /// A standard allocator backing large allocations with transparent
+  /// huge pages, reducing the TLB misses when serializing or byte
+  /// swapping multi-MB record buffers. Allocations of at least
+  /// 'threshold' bytes are mapped anonymously, aligned on the huge page
+  /// size and advised with MADV_HUGEPAGE. Smaller allocations, and all
+  /// allocations on platforms without mmap, use std::allocator. The
+  /// allocator is stateless: the allocation size, given back on
+  /// deallocation, tells how the memory was obtained. Can be used as
+  /// buffer allocator, e.g. in the writer config to get the buffer pool
+  /// of the concurrent writer backed by huge pages.
+  template <typename T, std::size_t threshold = details::huge_page_size>
+  class huge_page_allocator {
+  public:
+    // traits
+    typedef T                       value_type;
+    typedef std::size_t             size_type;
+    typedef std::ptrdiff_t          difference_type;
+
+    template <typename U>
+    struct rebind {
+      typedef huge_page_allocator<U, threshold> other;
+    };
+
+  public:
+    /// Default constructor
+    huge_page_allocator() noexcept = default;
+
+    /// Converting constructor
+    template <typename U>
+    inline huge_page_allocator(const huge_page_allocator<U, threshold> &) noexcept {
+      /* nop */
+    }
+
+    /// Allocate 'n' objects, mapping huge pages if large enough. Falls
+    /// back to normal pages if the huge pages can't be mapped.
+    /// Throws std::bad_alloc on failure
+    value_type *allocate(size_type n);
+
+    /// Deallocate 'n' objects allocated by allocate(n)
+    void deallocate(value_type *ptr, size_type n) noexcept;
+
+    /// Whether an allocation of 'n' objects is mapped on huge pages
+    static bool is_huge(size_type n) noexcept;
+
+    /// Equality operator. All the instances are equal
+    template <typename U>
+    inline friend bool operator==(const huge_page_allocator<T, threshold> &, const huge_page_allocator<U, threshold> &) noexcept {
+      return true;
+    }
+
+    /// Inequality operator
+    template <typename U>
+    inline friend bool operator!=(const huge_page_allocator<T, threshold> &lhs, const huge_page_allocator<U, threshold> &rhs) noexcept {
+      return not (lhs == rhs);
+    }
+  };
+}
+
+#include <accio/details/huge_page_allocator_impl.h>
+
+#endif  //  ACCIO_HUGE_PAGE_ALLOCATOR_H
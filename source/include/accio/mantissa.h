@@ -0,0 +1,51 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_MANTISSA_H
+#define ACCIO_MANTISSA_H 1
+
+// -- std headers
+#include <cstddef>
+#include <cstdint>
+
+namespace accio {
+
+  /// Lossy truncation of floating point mantissas.
+  ///
+  /// Zeroing the low mantissa bits of values measured with a limited
+  /// precision doesn't change their meaning but makes them much more
+  /// compressible. The values are truncated toward zero. Infinities and
+  /// NaNs are left untouched. The relative error introduced on normal
+  /// numbers is below error_bound(), denormal numbers may get a larger one
+  struct mantissa {
+    typedef std::size_t             size_type;
+
+    /// The number of mantissa bits of float values
+    static constexpr unsigned int float_bits = 23;
+    /// The number of mantissa bits of double values
+    static constexpr unsigned int double_bits = 52;
+
+    /// Copy 'count' values, zeroing their 'bits' low mantissa bits.
+    /// Returns the maximum relative error introduced
+    static double truncate(const float *input, size_type count, unsigned int bits, float *output) noexcept;
+
+    /// Copy 'count' values, zeroing their 'bits' low mantissa bits.
+    /// Returns the maximum relative error introduced
+    static double truncate(const double *input, size_type count, unsigned int bits, double *output) noexcept;
+
+    /// The bound of the relative error introduced on normal numbers by
+    /// zeroing 'bits' low mantissa bits out of 'mantissa_bits'
+    static double error_bound(unsigned int bits, unsigned int mantissa_bits) noexcept;
+  };
+}
+
+#include <accio/details/mantissa_impl.h>
+
+#endif  //  ACCIO_MANTISSA_H
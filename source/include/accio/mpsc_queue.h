@@ -0,0 +1,70 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_MPSC_QUEUE_H
+#define ACCIO_MPSC_QUEUE_H 1
+
+// -- std headers
+#include <atomic>
+
+namespace accio {
+
+  /// The hook of the objects stored in a mpsc_queue
+  struct mpsc_node {
+    /// The next node in the queue
+    std::atomic<mpsc_node*>       m_next{nullptr};
+  };
+
+  /// mpsc_queue class
+  ///
+  /// An intrusive, unbounded, multiple producers single consumer queue
+  /// (D. Vyukov's algorithm). push() is wait-free: a single atomic exchange.
+  /// pop() is lock-free and may transiently return nullptr while a producer
+  /// is linking its node. The stored type must inherit from mpsc_node.
+  /// The queue doesn't own the nodes
+  template <typename T>
+  class mpsc_queue {
+  public:
+    typedef T              value_type;
+
+  public:
+    /// Constructor
+    mpsc_queue();
+    mpsc_queue(const mpsc_queue&) = delete;
+    mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+    /// Push a node. Can be called concurrently from any thread
+    void push(value_type *value) noexcept;
+
+    /// Pop a node or get nullptr if the queue is empty.
+    /// Must be called from the consumer thread only
+    value_type *pop() noexcept;
+
+    /// Whether the queue is empty. Unlike pop(), sees the nodes being
+    /// linked by a producer. Must be called from the consumer thread only
+    bool empty() const noexcept;
+
+  private:
+    /// Push a node, see push()
+    void push_node(mpsc_node *node) noexcept;
+
+  private:
+    /// The last pushed node, where producers link their nodes
+    alignas(64) std::atomic<mpsc_node*>     m_head{nullptr};
+    /// The next node to pop, accessed by the consumer only
+    alignas(64) mpsc_node*                  m_tail{nullptr};
+    /// The stub node, always present in the queue when empty
+    mpsc_node                               m_stub{};
+  };
+}
+
+#include <accio/details/mpsc_queue_impl.h>
+
+#endif  //  ACCIO_MPSC_QUEUE_H
@@ -0,0 +1,130 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_READER_H
+#define ACCIO_READER_H 1
+
+// -- std headers
+#include <memory>
+#include <unordered_map>
+
+#include <accio/definitions.h>
+#include <accio/buffer.h>
+
+namespace accio {
+
+  /// block_reader class
+  ///
+  /// Main interface for reading a block from a record.
+  /// A block reader handles all the versions of a block type
+  /// sharing the same major version. Minor version changes
+  /// can be handled in the read() method using the version
+  /// stored in the block summary
+  template <typename config>
+  class block_reader {
+  public:
+    typedef typename config::record_type                                   record_type;
+    typedef typename config::char_type                                     char_type;
+    typedef typename config::copy_type                                     copy_type;
+    typedef typename config::allocator_type                                allocator_type;
+    typedef typename accio::buffer<char_type, copy_type, allocator_type>   buffer_type;
+    typedef string64                                                       string_type;
+    typedef types::version_type                                            version_type;
+
+  public:
+    /// Constructor with block type and major version
+    block_reader(
+      const string_type &t,
+      version_type maj) :
+      m_major(maj),
+      m_type(t) {
+      /* nop */
+    }
+
+    /// Get the major version of blocks handled by this reader
+    inline version_type major_version() const {
+      return m_major;
+    }
+
+    /// Get the block type
+    inline const string_type &type() const {
+      return m_type;
+    }
+
+    /// Read a block from a buffer and fill the record.
+    /// The buffer is positioned at the beginning of the block
+    virtual error_codes::code_type read(buffer_type &inbuf, const io::block_summary &summary, record_type &record) const = 0;
+
+  private:
+    /// The block major version
+    const version_type                   m_major;
+    /// The block type
+    const string_type                    m_type;
+  };
+
+  /// block_reader_registry class
+  ///
+  /// Dispatch the blocks of a record to their readers.
+  /// The readers are looked up from the block type hash and the block
+  /// major version in O(1), without comparing strings per registered reader
+  template <typename config>
+  class block_reader_registry {
+  public:
+    typedef typename config::record_type                   record_type;
+    typedef typename accio::block_reader<config>           block_reader;
+    typedef typename block_reader::buffer_type             buffer_type;
+    typedef typename block_reader::string_type             string_type;
+    typedef typename block_reader::version_type            version_type;
+    typedef typename std::shared_ptr<const block_reader>   block_reader_ptr;
+
+  public:
+    /// Register a block reader.
+    /// Only one reader per block type and major version is allowed.
+    /// Readers of different types whose keys collide are all kept
+    error_codes::code_type add(block_reader_ptr reader);
+
+    /// Find the reader of a block type with the given (full) version.
+    /// Returns nullptr if not found
+    const block_reader *find(const string_type &type, version_type vers) const;
+
+    /// Find the reader of a block. Returns nullptr if not found
+    inline const block_reader *find(const io::block_summary &summary) const {
+      return find(summary.m_type, summary.m_version);
+    }
+
+    /// Read all the blocks of a record from the buffer.
+    /// Blocks without registered reader are skipped
+    error_codes::code_type read_blocks(
+      buffer_type &inbuf,                  // the record buffer, positioned at the first block
+      const io::record_summary &summary,   // the record summary, describing the blocks
+      record_type &record                  // the record to fill
+    ) const;
+
+    /// The number of registered readers
+    inline std::size_t size() const {
+      return m_readers.size();
+    }
+
+  private:
+    /// Compute the registry key from the block type hash and major version
+    static inline hash_type key(hash_type type_hash, version_type maj) noexcept {
+      return type_hash ^ (static_cast<hash_type>(maj) * 0x9e3779b97f4a7c15ULL);
+    }
+
+  private:
+    /// The registered block readers. Colliding keys share a bucket and are
+    /// told apart by their type and major version
+    std::unordered_multimap<hash_type, block_reader_ptr>     m_readers{};
+  };
+}
+
+#include <accio/details/reader_impl.h>
+
+#endif  //  ACCIO_READER_H
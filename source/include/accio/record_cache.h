@@ -0,0 +1,175 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_RECORD_CACHE_H
+#define ACCIO_RECORD_CACHE_H 1
+
+// -- std headers
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <accio/definitions.h>
+#include <accio/stream.h>
+
+namespace accio {
+
+  /// A record kept by a record cache: the record header,
+  /// summary and uncompressed payload, as read by a stream
+  template <class charT, class copy = copy::standard>
+  struct cached_record {
+    typedef buffer<charT, copy>       buffer_type;
+
+    /// The record header
+    io::record_header            m_header{};
+    /// The record summary
+    io::record_summary           m_summary{};
+    /// The uncompressed record payload
+    buffer_type                  m_buffer{0};
+    /// Whether the payload is in the opposite byte order
+    bool                         m_byte_swap{false};
+
+    /// The memory used by the record
+    inline std::size_t memory() const noexcept {
+      return sizeof(*this) + m_summary.size()*sizeof(io::block_summary) + m_buffer.memsize();
+    }
+  };
+
+  /// The statistics of a record cache
+  struct cache_statistics {
+    /// The number of lookups finding their record
+    std::size_t          m_hits{0};
+    /// The number of lookups not finding their record
+    std::size_t          m_misses{0};
+    /// The number of records evicted to stay in the memory budget
+    std::size_t          m_evictions{0};
+    /// The number of records in the cache
+    std::size_t          m_records{0};
+    /// The memory used by the records in the cache
+    std::size_t          m_memory{0};
+  };
+
+  /// record_cache class
+  ///
+  /// A least recently used cache of records, keyed by their position in a
+  /// file (see stream::build_index()), under a memory budget. Revisiting a
+  /// record doesn't read and uncompress it again. The values are shared and
+  /// read only: uncompressed record buffers (cached_record, see
+  /// read_record() below) or records already decoded and relocated by the
+  /// caller. The cache can be shared between reader threads: lookups and
+  /// insertions are serialized by a mutex, the values are loaded without
+  /// holding it. A cache holds the records of a single file
+  template <class T>
+  class record_cache {
+  public:
+    typedef T                                   value_type;
+    typedef std::shared_ptr<const value_type>   value_ptr;
+
+  public:
+    /// Constructor with the memory budget in bytes
+    record_cache(std::size_t budget);
+    record_cache(const record_cache&) = delete;
+    record_cache& operator=(const record_cache&) = delete;
+
+    /// Find a record and mark it as the most recently used.
+    /// Returns nullptr if not cached
+    value_ptr find(const io::record_position &position);
+
+    /// Insert a record using 'memory' bytes, evicting the least recently
+    /// used records to stay in the memory budget. A record bigger than
+    /// the budget is not cached. If the record is already cached, the
+    /// cached value is kept and returned, else the inserted one
+    value_ptr insert(const io::record_position &position, value_ptr value, std::size_t memory);
+
+    /// Find a record or, if not cached, load it with 'load' (returning a
+    /// value_ptr, nullptr on failure) and insert it. The memory used by
+    /// the record is given by its memory() method
+    template <typename F>
+    value_ptr get(const io::record_position &position, F &&load);
+
+    /// Remove all the records
+    void clear();
+
+    /// Get the memory budget
+    std::size_t budget() const;
+
+    /// Set the memory budget, evicting records if needed
+    void set_budget(std::size_t budget);
+
+    /// Get the statistics
+    cache_statistics statistics() const;
+
+    /// Reset the hit, miss and eviction counters
+    void reset_statistics();
+
+  private:
+    /// A cached record
+    struct node {
+      /// The record position
+      io::record_position    m_position{};
+      /// The record
+      value_ptr              m_value{};
+      /// The memory used by the record
+      std::size_t            m_memory{0};
+    };
+
+    /// Hash a record position
+    struct position_hash {
+      inline std::size_t operator()(const io::record_position &position) const noexcept {
+        return std::hash<types::size64_type>()(static_cast<types::size64_type>(position.m_offset) * 0x9e3779b97f4a7c15ULL ^ position.m_group_offset);
+      }
+    };
+
+    /// Compare record positions
+    struct position_equal {
+      inline bool operator()(const io::record_position &lhs, const io::record_position &rhs) const noexcept {
+        return (lhs.m_offset == rhs.m_offset) and (lhs.m_group_offset == rhs.m_group_offset);
+      }
+    };
+
+    typedef std::list<node>                                           node_list;
+    typedef std::unordered_map<io::record_position, typename node_list::iterator, position_hash, position_equal>   node_map;
+
+    /// Evict the least recently used records until the memory fits in the budget.
+    /// The mutex must be locked
+    void evict();
+
+  private:
+    /// The mutex protecting the fields below
+    mutable std::mutex           m_mutex{};
+    /// The records, most recently used first
+    node_list                    m_nodes{};
+    /// The records by position
+    node_map                     m_map{};
+    /// The memory budget
+    std::size_t                  m_budget;
+    /// The statistics
+    cache_statistics             m_statistics{};
+  };
+
+  /// Read a record through a cache of uncompressed records. On a miss, the
+  /// record is read from the stream at its position (see stream::seek_record())
+  /// and inserted. On a hit, the stream is not used. The buffer receives a
+  /// copy of the record payload in read mode
+  template <class charT, class copy, class alloc>
+  error_codes::code_type read_record(
+    stream<charT, copy> &stream,                               // the stream reading the file on a miss
+    record_cache<cached_record<charT, copy>> &cache,           // the cache of uncompressed records
+    const io::record_position &position,                       // the position of the record to read
+    io::record_header &header,                                 // the record header to fill
+    io::record_summary &summary,                               // the record summary to fill
+    buffer<charT, copy, alloc> &buffer                         // the buffer receiving the record payload
+  );
+}
+
+#include <accio/details/record_cache_impl.h>
+
+#endif  //  ACCIO_RECORD_CACHE_H
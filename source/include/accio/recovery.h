@@ -0,0 +1,114 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_RECOVERY_H
+#define ACCIO_RECOVERY_H 1
+
+// -- std headers
+#include <string>
+#include <vector>
+
+#include <accio/definitions.h>
+
+namespace accio {
+
+  /// The location of a record in a file
+  struct record_location {
+    /// The offset of the record header in the file
+    types::offset_type      m_offset{0};
+    /// The total size of the record in the file
+    types::offset_type      m_size{0};
+    /// The record header
+    io::record_header       m_header{};
+  };
+
+  /// A record index, sorted by offset
+  typedef std::vector<record_location>   record_index;
+
+  /// The result of a file scan
+  struct scan_report {
+    /// The valid records found in the file
+    record_index            m_records{};
+    /// The file size
+    types::offset_type      m_file_size{0};
+    /// The size of the file header (0 for files written without header)
+    types::offset_type      m_header_size{0};
+    /// The size to which the file can be safely truncated: the end of
+    /// the valid records sequence starting at the beginning of the file
+    types::offset_type      m_safe_size{0};
+    /// The number of bytes not belonging to any valid record,
+    /// before the last valid record
+    types::offset_type      m_corrupted_bytes{0};
+    /// The number of bytes after the last valid record (partial record)
+    types::offset_type      m_trailing_bytes{0};
+  };
+
+  /// record_scanner class
+  ///
+  /// Rebuild the record index of a truncated or damaged file.
+  /// The file is read by large chunks. Records are followed from header
+  /// to header without reading their payload, and on a broken header the
+  /// next record marker is searched with a vectorized scan. A candidate
+  /// record is accepted if it fits in the file and if its block summary
+  /// is consistent with its header. The record headers are expected
+  /// in the plateform byte order
+  class record_scanner {
+  public:
+    typedef types::offset_type      offset_type;
+
+    /// The default size of the chunks read from the file
+    static constexpr std::size_t default_chunk_size = 4*1024*1024;
+
+  public:
+    /// Constructor with the size of the chunks read from the file
+    record_scanner(std::size_t chunk_size = default_chunk_size);
+    record_scanner(const record_scanner&) = delete;
+    record_scanner& operator=(const record_scanner&) = delete;
+
+    /// Scan a file and build its record index
+    error_codes::code_type scan(const std::string &fname, scan_report &report);
+
+    /// Find the first record marker stored at a 4 bytes aligned offset in
+    /// the 'len' bytes of data. Returns the offset of the marker or 'len'
+    static std::size_t find_marker(const unsigned char *data, std::size_t len) noexcept;
+
+  private:
+    /// Load the chunk starting at the file offset (4 bytes aligned)
+    bool load(offset_type offset, std::size_t min_len);
+    /// Make sure the 'len' bytes at the file offset are loaded
+    const unsigned char *fetch(offset_type offset, std::size_t len);
+    /// Validate the record candidate at the file offset
+    bool validate(offset_type offset, record_location &location);
+    /// Get the size of the file header. Returns 0 if the
+    /// file doesn't start with a valid file header
+    offset_type header_size();
+    /// Find the offset of the next record marker, starting at the offset.
+    /// Returns the file size if not found
+    offset_type next_marker(offset_type offset);
+
+  private:
+    /// The current chunk
+    std::vector<unsigned char>    m_chunk{};
+    /// The chunk size
+    std::size_t                   m_chunk_size{default_chunk_size};
+    /// The offset of the current chunk in the file
+    offset_type                   m_chunk_offset{0};
+    /// The number of bytes loaded in the current chunk
+    std::size_t                   m_chunk_len{0};
+    /// The file being scanned
+    FILE                         *m_file{nullptr};
+    /// The size of the file being scanned
+    offset_type                   m_file_size{0};
+  };
+}
+
+#include <accio/details/recovery_impl.h>
+
+#endif  //  ACCIO_RECOVERY_H
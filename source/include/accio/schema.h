@@ -0,0 +1,99 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_SCHEMA_H
+#define ACCIO_SCHEMA_H 1
+
+// -- std headers
+#include <utility>
+
+#include <accio/definitions.h>
+#include <accio/buffer.h>
+
+namespace accio {
+
+  /// record_schema class
+  ///
+  /// A record layout known at compile time: the list of blocks written
+  /// for each record. It is the static alternative to record_io: the
+  /// blocks are written by direct calls, without creating block writers
+  /// nor calling virtual methods. A block type describes the block with
+  /// static methods and writes it from the record, e.g:
+  ///   struct hits_block {
+  ///     static const char *type() { return "hits"; }
+  ///     static const char *name() { return "hits"; }
+  ///     static constexpr types::version_type version() { return version::encode(1, 0); }
+  ///     template <typename buffer_type>
+  ///     static error_codes::code_type write(buffer_type &outbuf, const event &evt) {
+  ///       outbuf.write_data(evt.m_hits);
+  ///       return error_codes::block::success;
+  ///     }
+  ///   };
+  ///   record_schema<io_config, info_block, hits_block> schema;
+  ///   writer.write_record("event", schema, evt);
+  /// A block type may also provide a static filter() returning its block
+  /// filter word (see io::filter), io::filter::none if not provided
+  /// The filter of a schema block type: its static filter() if any,
+  /// io::filter::none otherwise
+  template <typename block, typename = void>
+  struct schema_filter {
+    static constexpr types::option_word value() { return io::filter::none; }
+  };
+
+  template <typename block>
+  struct schema_filter<block, decltype(void(block::filter()))> {
+    static types::option_word value() { return block::filter(); }
+  };
+
+  template <typename config, typename... blocks>
+  class record_schema {
+  public:
+    typedef typename config::record_type                                   record_type;
+    typedef typename config::char_type                                     char_type;
+    typedef typename config::copy_type                                     copy_type;
+    typedef typename config::allocator_type                                allocator_type;
+    typedef typename accio::buffer<char_type, copy_type, allocator_type>   buffer_type;
+
+    /// The number of blocks in the schema
+    static constexpr std::size_t nblocks = sizeof...(blocks);
+    static_assert(nblocks > 0, "accio::record_schema: a schema needs at least one block");
+
+  public:
+    /// Constructor. Build the block summaries once
+    record_schema();
+
+    /// Get the block summaries of the schema, without block sizes
+    inline const io::record_summary &summary() const noexcept {
+      return m_summary;
+    }
+
+    /// Write the blocks of a record in the buffer, from its current
+    /// position, and append their summary. As with record_io, the blocks
+    /// failing to write are reported and skipped
+    void write_blocks(const record_type &rec, buffer_type &outbuf, io::record_summary &summary) const;
+
+  private:
+    /// Write the block at 'index' in the schema
+    template <typename block>
+    bool write_block(std::size_t index, const record_type &rec, buffer_type &outbuf, io::record_summary &summary) const;
+
+    /// Expand the block list
+    template <std::size_t... indices>
+    void write_blocks(std::index_sequence<indices...>, const record_type &rec, buffer_type &outbuf, io::record_summary &summary) const;
+
+  private:
+    /// The block summaries
+    io::record_summary           m_summary{};
+  };
+}
+
+#include <accio/details/schema_impl.h>
+
+#endif  //  ACCIO_SCHEMA_H
@@ -0,0 +1,65 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_SHUFFLE_H
+#define ACCIO_SHUFFLE_H 1
+
+// -- std headers
+#include <cstddef>
+#include <cstdint>
+
+#include <accio/definitions.h>
+
+namespace accio {
+
+  /// Shuffle filters of numeric arrays.
+  ///
+  /// The high bytes of neighbour values in an array (exponents, high
+  /// bits of counts) are mostly equal but interleaved with the noisy low
+  /// bytes, which defeats deflate. The byte shuffle transposes an array of
+  /// 'n' elements of 'element' bytes into 'element' planes of 'n' bytes:
+  /// the byte b of the element i is moved to b*n + i. The bit shuffle
+  /// further transposes each plane of the first n - n%8 elements into 8
+  /// bit planes: the bit j of the byte b of the element i is moved to the
+  /// bit i%8 of the byte (8*b + j)*(n/8) + i/8. The bytes that don't make
+  /// a whole element (or group of 8 elements) are copied as is.
+  /// The kernels use AVX2 for 4 and 8 byte elements when the CPU supports
+  /// it, with the same layout as the scalar fallback
+  struct shuffle {
+    typedef std::size_t             size_type;
+
+    /// Byte shuffle 'size' bytes of elements of 'element' bytes
+    static void byte_shuffle(const unsigned char *input, size_type size, size_type element, unsigned char *output) noexcept;
+
+    /// Revert byte_shuffle()
+    static void byte_unshuffle(const unsigned char *input, size_type size, size_type element, unsigned char *output) noexcept;
+
+    /// Bit shuffle 'size' bytes of elements of 'element' bytes
+    static void bit_shuffle(const unsigned char *input, size_type size, size_type element, unsigned char *output) noexcept;
+
+    /// Revert bit_shuffle()
+    static void bit_unshuffle(const unsigned char *input, size_type size, size_type element, unsigned char *output) noexcept;
+
+    /// Apply a block filter (see io::filter) to 'size' bytes.
+    /// Returns false if the filter is unknown
+    static bool encode(types::option_word filter, const unsigned char *input, size_type size, unsigned char *output) noexcept;
+
+    /// Revert a block filter applied with encode().
+    /// Returns false if the filter is unknown
+    static bool decode(types::option_word filter, const unsigned char *input, size_type size, unsigned char *output) noexcept;
+
+    /// Whether the AVX2 kernels are used on this CPU
+    static bool avx2_available() noexcept;
+  };
+}
+
+#include <accio/details/shuffle_impl.h>
+
+#endif  //  ACCIO_SHUFFLE_H
@@ -15,6 +15,9 @@
 #include <accio/definitions.h>
 #include <accio/copy.h>
 #include <accio/buffer.h>
+#include <accio/checksum.h>
+#include <accio/compression.h>
+#include <accio/shuffle.h>
 
 namespace accio {
 
@@ -30,11 +33,17 @@ namespace accio {
     typedef typename buffer_type::size_type    size_type;
     typedef FILE                               file_type;
 
+    // constants
+    static constexpr size_type  async_checksum_size = 64*1024; // payload size above which checksums are computed while writing
+    static constexpr size_type  default_readahead = 8*1024*1024; // bytes read ahead in sequential access modes
+    static constexpr size_type  checked_size = 64*1024; // sizes read from a file above which the file size is checked before allocating
+
   public:
     stream() = default;
     stream(const stream&) = delete;
     stream &operator=(const stream&) = delete;
-    ~stream() = default;
+    /// Destructor. Close the file if still open, writing the pending group
+    ~stream();
 
     /// Get the file name
     inline const std::string& fname() const noexcept {
@@ -51,18 +60,294 @@ namespace accio {
       return m_openmode;
     }
 
-    /// open a file
+    /// Get the checksum verification mode
+    inline io::verify_mode verify_mode() const noexcept {
+      return m_verifymode;
+    }
+
+    /// Get the file header, in the plateform byte order. For files written
+    /// without header (older versions), the header is zero initialized
+    inline const io::file_header& file_header() const noexcept {
+      return m_file_header;
+    }
+
+    /// Set how record checksums are verified on read.
+    /// In asynchronous mode, the checksum of a record is verified while
+    /// the caller decodes it. The result is collected by the next call
+    /// to read_record() or by wait_checksum()
+    inline void set_verify_mode(io::verify_mode mode) noexcept {
+      m_verifymode = mode;
+    }
+
+    /// Get the file access mode in read mode
+    inline io::access_mode access_mode() const noexcept {
+      return m_accessmode;
+    }
+
+    /// Set how the file is accessed in read mode, hinted to the kernel. In
+    /// sequential and streaming modes, the 'readahead' bytes following the
+    /// record being read are requested ahead as the reading goes. In
+    /// streaming mode, the pages behind the record being read are dropped
+    /// from the page cache, so that long scans don't evict the pages used
+    /// by other processes. In random mode, the kernel readahead is turned
+    /// off. Applies to the file currently opened and to the next ones
+    void set_access_mode(io::access_mode mode, size_type readahead = default_readahead);
+
+    /// Get the preset dictionary compressing the records written
+    inline const compressor::dictionary_type &dictionary() const noexcept {
+      return m_dictionary;
+    }
+
+    /// Set the preset dictionary compressing the next records written,
+    /// empty to compress without dictionary. The dictionary is written in
+    /// the file once, in a dictionary record preceding the first record
+    /// compressed with it, and again in each file the stream opens. The
+    /// compressed records reference it by id in their option word.
+    /// The dictionary records are read transparently
+    void set_dictionary(const compressor::dictionary_type &dict);
+
+    /// Whether the preset dictionary is written in the current file
+    inline bool dictionary_written() const noexcept {
+      return m_dictionary_written;
+    }
+
+    /// The size in file of the record holding the preset dictionary,
+    /// 0 without dictionary
+    types::size64_type dictionary_record_size() const;
+
+    /// Get the target size of the record groups (0: no grouping)
+    inline size_type grouping() const noexcept {
+      return m_group_target;
+    }
+
+    /// Set the target size of the record groups, 0 to write each record
+    /// on its own. The compressed records smaller than the target are
+    /// packed in a group record, compressed as a whole when its payload
+    /// reaches the target, before a record with other options or a bigger
+    /// record, and on close. The block filters are not applied to the
+    /// grouped records. The grouped records are read transparently: the
+    /// group is uncompressed once and kept for the next reads.
+    /// write_record() returns success for a grouped record before it is
+    /// written: the write errors are returned when the group is written,
+    /// by the write_record() call flushing it, flush_group() or close()
+    inline void set_grouping(size_type target) noexcept {
+      // the group entries have 32 bit sizes
+      const size_type max_target = 1 << 30;
+      m_group_target = (target > max_target) ? max_target : target;
+    }
+
+    /// open a file. A file header is written at the beginning of new
+    /// files. When reading or appending, the header is checked: returns
+    /// bad_header for an unsupported format version. Files written in
+    /// the opposite byte order are converted on read (reader makes
+    /// right) and can't be opened in the other modes (bad_byte_order)
     error_codes::code_type open(const std::string& fn, io::open_mode mode) noexcept;
 
-    /// close the file
+    /// close the file. The pending record group is written and the
+    /// features of the records written are recorded in the file header.
+    /// The file is closed even if writing the group fails: the error is
+    /// returned, e.g. no_alloc if its compression buffer can't be allocated
     error_codes::code_type close() noexcept;
 
+    /// Write a record. If the option::checksum flag is set in
+    /// the header, the record checksum is computed and written.
+    /// If a compression level is set in the header, the payload is
+    /// compressed after applying the block filters of the summary. The
+    /// record is written uncompressed if the compression doesn't shrink it.
+    /// With grouping, the record may only be appended to the pending
+    /// group: its write errors are reported later (see set_grouping())
+    template <class alloc>
     error_codes::code_type write_record(
       const io::record_header &header,
       const io::record_summary &summary,
-      const buffer_type &buffer
+      const buffer<char_type, copy_type, alloc> &buffer
+    );
+
+    /// Read the next record. The buffer is set in read mode with the
+    /// record payload, uncompressed and unfiltered. The header holds the
+    /// sizes and options of the record as written in the file, e.g without
+    /// compression level if it was stored uncompressed. In asynchronous
+    /// verification mode, returns bad_checksum without reading if the
+    /// previous record is corrupted
+    template <class alloc>
+    error_codes::code_type read_record(
+      io::record_header &header,
+      io::record_summary &summary,
+      buffer<char_type, copy_type, alloc> &buffer
+    );
+
+    /// Read the next record matching the name, skipping the other
+    /// records without reading their payload. Returns eof if not found
+    template <class alloc>
+    error_codes::code_type find_record(
+      const string32 &name,
+      io::record_header &header,
+      io::record_summary &summary,
+      buffer<char_type, copy_type, alloc> &buffer
+    );
+
+    /// Read the next record header and, if not null, its summary. The
+    /// payload is not read: the stream is moved to the next record
+    error_codes::code_type next_header(
+      io::record_header &header,
+      io::record_summary *summary = nullptr
+    );
+
+    /// Read the next record header as stored in the file and, if not
+    /// null, its summary. The group and dictionary records are returned
+    /// as they are, with their stored sizes: the groups are not
+    /// uncompressed and the records they hold are not returned. The
+    /// records left in the current group are skipped
+    error_codes::code_type next_stored_header(
+      io::record_header &header,
+      io::record_summary *summary = nullptr
     );
 
+    /// Skip the next record, reading only its header
+    error_codes::code_type skip_record();
+
+    /// Wait for the pending asynchronous checksum verification.
+    /// Returns bad_checksum if the last record read is corrupted
+    error_codes::code_type wait_checksum();
+
+    /// Write the pending record group, if any
+    error_codes::code_type flush_group();
+
+    /// Build the index of the records of the file, in file order: the
+    /// offset of each record, or of its group and its offset in the
+    /// uncompressed group. The groups are uncompressed and the dictionary
+    /// records loaded on the way. The stream is rewinded to its first record
+    error_codes::code_type build_index(std::vector<io::record_position> &index);
+
+    /// Move to a record of the index built by build_index(), the next
+    /// record read being this one. The last group read is kept in
+    /// memory: moving to a record of this group doesn't read the file.
+    /// The dictionary of a compressed record is loaded when first needed
+    error_codes::code_type seek_record(const io::record_position &position);
+
+  private:
+    /// Write the file header at the current file position
+    error_codes::code_type write_file_header() noexcept;
+
+    /// Read and check the file header at the beginning of the file.
+    /// Files without header are rewinded to their first record
+    error_codes::code_type read_file_header(file_type *file) noexcept;
+
+    /// Record the features of the records written in the file header
+    bool write_features(file_type *file) noexcept;
+
+    /// The header of the record holding the current dictionary
+    io::record_header dictionary_header() const;
+
+    /// Write the current dictionary in a dictionary record
+    error_codes::code_type write_dictionary();
+
+    /// Write a record as stored: the header holds the stored options and
+    /// sizes, the block filter words applied are in m_block_filters
+    error_codes::code_type write_stored(
+      const io::record_header &stored,
+      const io::record_summary &summary,
+      const unsigned char *payload
+    );
+
+    /// Give the page cache hint of the access mode for the whole file
+    void advise_file();
+
+    /// Read ahead the records following the current file position and,
+    /// in streaming mode, drop the pages behind it from the page cache
+    void advise_read();
+
+    /// Check the stream can be read and read the next record header
+    error_codes::code_type read_header(io::record_header &header);
+
+    /// Read the next record header, loading the dictionary records met
+    error_codes::code_type next_record_header(io::record_header &header);
+
+    /// Read the summary if not null, or skip it, and skip the payload
+    /// of the record whose header was just read
+    error_codes::code_type skip_stored(const io::record_header &header, io::record_summary *summary);
+
+    /// Read the summary and the payload of a dictionary record
+    error_codes::code_type read_dictionary(const io::record_header &header);
+
+    /// Load a dictionary not met yet, e.g. after seek_record(): the
+    /// records are scanned from the beginning of the file up to the
+    /// dictionary record, then the file position is restored. Returns
+    /// bad_compress if the file doesn't hold the dictionary
+    error_codes::code_type load_dictionary(types::option_word id);
+
+    /// Compress if required and write a record payload
+    error_codes::code_type write_payload(
+      const io::record_header &header,
+      const io::record_summary &summary,
+      const unsigned char *payload,
+      size_type len
+    );
+
+    /// Append a record to the pending group
+    void append_entry(const io::record_header &header, const io::record_summary &summary, const unsigned char *payload, size_type len);
+
+    /// Whether records of the current group remain to be read
+    inline bool group_pending() const noexcept {
+      return m_group_offset < m_group_size;
+    }
+
+    /// Read and uncompress the payload of a group record, following its summary
+    error_codes::code_type load_group(const io::record_header &header, const io::record_summary &summary);
+
+    /// Read the header and summary of the next record of the current
+    /// group. The record payload is pointed by m_entry_payload
+    error_codes::code_type read_entry(io::record_header &header, io::record_summary &summary);
+
+    /// Copy the payload of the record last read from a group in a buffer
+    template <class alloc>
+    void copy_entry(const io::record_header &header, buffer<char_type, copy_type, alloc> &buffer);
+
+    /// Whether 'len' bytes are left in the file from the current position.
+    /// Checked before skipping bytes, and before allocating memory for
+    /// sizes read from the file that are large enough to matter: a
+    /// smaller size is caught by the short read. The file size is cached
+    /// and refreshed when the check fails, as the file may still be written
+    bool in_file(types::size64_type len);
+
+    /// Read the record summary, following the header
+    error_codes::code_type read_summary(const io::record_header &header, io::record_summary &summary);
+
+    /// Read the record payload and trailer, following the summary,
+    /// verify the record checksum and uncompress the payload
+    template <class alloc>
+    error_codes::code_type read_payload(
+      const io::record_header &header,
+      const io::record_summary &summary,
+      buffer<char_type, copy_type, alloc> &buffer
+    );
+
+    /// Compress a record payload, applying the block filters.
+    /// Returns the compressed size, 0 on failure
+    size_type compress_payload(
+      int level,
+      const io::record_summary &summary,
+      const unsigned char *payload,
+      size_type len
+    );
+
+    /// Revert the block filters of an uncompressed payload
+    bool unfilter_payload(const io::record_summary &summary, unsigned char *payload, size_type len);
+
+    /// Skip the 'nblocks' block summaries not read yet,
+    /// the record payload and the trailer
+    error_codes::code_type skip_payload(const io::record_header &header, types::size_type nblocks);
+
+    /// Compute the checksum of the record summary last read or written
+    checksum::value_type summary_checksum() const;
+
+    /// Convert a word of the record headers between
+    /// the file and the plateform byte order
+    template <typename T>
+    inline T header_order(T word) const noexcept {
+      return m_swap_headers ? io::byte_swap(word) : word;
+    }
+
   private:
     /// The stream open mode
     io::open_mode              m_openmode{io::open_mode::read};
@@ -72,6 +357,72 @@ namespace accio {
     io::open_state             m_openstate{io::open_state::closed};
     /// The file handle
     file_type*                 m_file{nullptr};
+    /// The file size last seen, see in_file()
+    types::offset_type         m_file_size{0};
+    /// The file header
+    io::file_header            m_file_header{};
+    /// The features of the records written since the file was opened
+    types::option_word         m_features{0};
+    /// Whether the record headers are in the opposite byte order
+    bool                       m_swap_headers{false};
+    /// Whether the payloads are in the opposite byte order of the copy policy
+    bool                       m_swap_data{false};
+    /// The file access mode in read mode
+    io::access_mode            m_accessmode{io::access_mode::normal};
+    /// The number of bytes read ahead in sequential access modes
+    size_type                  m_readahead{default_readahead};
+    /// The end of the byte range last read ahead
+    types::offset_type         m_advised_end{0};
+    /// The end of the byte range dropped from the page cache
+    types::offset_type         m_dropped_end{0};
+    /// The checksum verification mode
+    io::verify_mode            m_verifymode{io::verify_mode::sync};
+    /// The worker computing checksums asynchronously
+    checksum_worker            m_checksum{};
+    /// The expected checksum of the last record read
+    checksum::value_type       m_expected_checksum{0};
+    /// The block summaries of the current record, in their file layout
+    std::vector<io::disk_block_summary>   m_disk_summary{};
+    /// The 64 bit block sizes of the current record (option::size64)
+    std::vector<types::size64_type>       m_block_sizes{};
+    /// The block filter words of the current record (option::filters)
+    std::vector<types::option_word>       m_block_filters{};
+    /// The record compressor
+    compressor                            m_compressor{};
+    /// The record decompressor
+    decompressor                          m_decompressor{};
+    /// The compressed payload of the last record read
+    std::vector<unsigned char>            m_compressed{};
+    /// The filtered blocks being compressed or unfiltered
+    std::vector<unsigned char>            m_filtered{};
+    /// The preset dictionary compressing the records written
+    compressor::dictionary_type           m_dictionary{};
+    /// The id of the preset dictionary in the option words
+    types::option_word                    m_dictionary_id{0};
+    /// Whether the preset dictionary is written in the current file
+    bool                                  m_dictionary_written{false};
+    /// The dictionaries read from the current file, by id
+    std::vector<compressor::dictionary_type>   m_dictionaries{};
+    /// The target size of the record groups written
+    size_type                             m_group_target{0};
+    /// The options (checksum, compression level) of the pending group
+    types::option_word                    m_group_options{0};
+    /// The entries of the pending group
+    std::vector<unsigned char>            m_group_output{};
+    /// The uncompressed payload of the last group read
+    buffer_type                           m_group_buffer{0};
+    /// The size of the last group read
+    size_type                             m_group_size{0};
+    /// The offset of the next record to read in the last group read
+    size_type                             m_group_offset{0};
+    /// The file offset of the last group read (-1: none)
+    types::offset_type                    m_group_position{-1};
+    /// The file offset following the last group read
+    types::offset_type                    m_group_next{0};
+    /// The payload of the record last read from a group
+    const unsigned char*                  m_entry_payload{nullptr};
+    /// The block summaries of the records skipped in a group
+    io::record_summary                    m_entry_summary{};
   };
 }
 
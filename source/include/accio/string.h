@@ -12,12 +12,29 @@
 #define ACCIO_STRING_H 1
 
 // -- std headers
+#include <cstdint>
 #include <cstring>
+#include <stdexcept>
 #include <string>
 #include <string.h>
 
 namespace accio {
 
+  /// The hash type of strings
+  typedef std::uint64_t hash_type;
+
+  /// Compute the hash (64 bit FNV-1a) of a C-string, reading at most
+  /// 'maxlen' characters. Evaluated at compile time for literals, e.g:
+  ///   constexpr auto h = accio::string_hash("calorimeter_hits");
+  constexpr hash_type string_hash(const char *str, std::size_t maxlen = std::size_t(-1)) noexcept {
+    hash_type hash = 0xcbf29ce484222325ULL;
+    for(std::size_t i = 0 ; (i < maxlen) and (str[i] != '\0') ; i++) {
+      hash ^= static_cast<unsigned char>(str[i]);
+      hash *= 0x100000001b3ULL;
+    }
+    return hash;
+  }
+
   /// A fixed size string class version
   ///
   /// Note that most of the methods mimic the std::string interface.
@@ -87,6 +104,11 @@ namespace accio {
       return &m_string[0];
     }
 
+    /// The string hash. See string_hash()
+    inline hash_type hash() const noexcept {
+      return string_hash(m_string, len);
+    }
+
     /// Construct an std::string from this string
     inline std::string std() const {
       return std::string(c_str());
@@ -118,6 +140,16 @@ namespace accio {
       return !(lhs == rhs);
     }
 
+    /// Equality operator. Same len only
+    inline friend bool operator==(const string<len> &lhs, const string<len> &rhs) {
+      return (strncmp(&lhs.m_string[0], &rhs.m_string[0], len) == 0);
+    }
+
+    /// Inequality operator. Same len only
+    inline friend bool operator!=(const string<len> &lhs, const string<len> &rhs) {
+      return !(lhs == rhs);
+    }
+
     /// Get a character at a specific position.
     /// Throw out_of_range exception if not in string range
     inline char &at(std::size_t pos) {
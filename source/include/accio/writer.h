@@ -11,8 +11,14 @@
 #ifndef ACCIO_WRITER_H
 #define ACCIO_WRITER_H 1
 
+// -- std headers
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <accio/definitions.h>
 #include <accio/stream.h>
+#include <accio/schema.h>
 
 namespace accio {
 
@@ -34,14 +40,19 @@ namespace accio {
     typedef types::version_type                                            version_type;
 
   public:
-    /// Constructor with block version
+    /// Constructor with block version and optional block filter
+    /// (see io::filter), applied when the record is compressed, e.g
+    /// io::filter::encode(io::filter::byte_shuffle, sizeof(float))
+    /// for a block made of a float array
     block_writer(
       const string_type &t,
       const string_type &n,
-      version_type vers) :
+      version_type vers,
+      types::option_word filt = io::filter::none) :
       m_version(vers),
       m_type(t),
-      m_name(n) {
+      m_name(n),
+      m_filter(filt) {
       /* nop */
     }
 
@@ -60,6 +71,11 @@ namespace accio {
       return m_name;
     }
 
+    /// Get the block filter
+    inline types::option_word filter() const {
+      return m_filter;
+    }
+
     /// Write a block in a buffer.
     virtual error_codes::code_type write(buffer_type &outbuf) const = 0;
 
@@ -70,6 +86,8 @@ namespace accio {
     const string_type                    m_type;
     /// The block name
     const string_type                    m_name;
+    /// The block filter
+    const types::option_word             m_filter;
   };
 
   template <typename config>
@@ -86,8 +104,25 @@ namespace accio {
     /// Method called when a record is written by a file writer
     /// The record object (user data) can be used to create the block writers
     virtual error_codes::code_type create_writers(const record_type& record, block_writers &blocks) const = 0;
+
+    /// Method called when the block writers of a record are not used anymore.
+    /// By default, the list is cleared. Override it to recycle the block
+    /// writers, e.g in a pool used by create_writers(), so that no writer
+    /// is allocated per record. Called from several threads at the same
+    /// time by the concurrent_writer
+    virtual void release_writers(block_writers &blocks) const {
+      blocks.clear();
+    }
   };
 
+  /// file_writer class
+  ///
+  /// Write records in a file or in a set of shard files. Records are
+  /// spread round-robin across the shards, e.g to aggregate the bandwidth
+  /// of several disks. Each shard can be rotated: a new file is opened when
+  /// a size or record count limit is reached. The file names are built from
+  /// patterns in which "{}" is replaced by the file index in the shard
+  /// sequence, e.g "/disk1/run42_{}.accio" -> "/disk1/run42_0000.accio"
   template <class config>
   class file_writer {
   public:
@@ -96,17 +131,114 @@ namespace accio {
     typedef typename config::record_type               record_type;
     typedef typename accio::record_io<config>          record_io;
     typedef typename record_io::block_writers          block_writers;
+    typedef typename config::allocator_type            allocator_type;
+    typedef typename accio::buffer<char_type, copy_type, allocator_type>   buffer_type;
+    typedef typename accio::stream<char_type, copy_type>   stream_type;
 
   public:
     /// Constructor
     file_writer() = default;
-    /// Destructor
-    ~file_writer() = default;
+    /// Destructor. Close the files if still open, writing the pending groups
+    ~file_writer();
 
   public:
-    /// Open a file in write mode
+    /// Open a file in write mode. With rotation, the file
+    /// name must be a pattern with a "{}" placeholder
     error_codes::code_type open(const std::string &fname);
 
+    /// Open one shard file per pattern in write mode. With several
+    /// shards or with rotation, the patterns must contain a "{}" placeholder
+    error_codes::code_type open(const std::vector<std::string> &patterns);
+
+    /// Close the file(s)
+    error_codes::code_type close();
+
+    /// Whether a checksum is written with each record
+    inline bool checksum() const noexcept {
+      return m_checksum;
+    }
+
+    /// Set whether a checksum is written with each record (CRC32C of
+    /// the record summary and payload), verified on read. With more than
+    /// one hardware thread, the checksum of large payloads is computed
+    /// while they are written. Otherwise it costs a pass over the payload
+    /// (see bench_checksum)
+    inline void set_checksum(bool enable) noexcept {
+      m_checksum = enable;
+    }
+
+    /// Get the compression level of the records
+    inline unsigned int compression() const noexcept {
+      return m_compression;
+    }
+
+    /// Set the zlib compression level of the records (0: no compression,
+    /// 1 to 9: from fastest to smallest). The block filters are applied
+    /// before the compression. A record is stored uncompressed if the
+    /// compression doesn't shrink it. The rotation limits are checked
+    /// against the uncompressed record sizes
+    inline void set_compression(unsigned int level) noexcept {
+      const unsigned int max_level = static_cast<unsigned int>(compressor::max_level);
+      m_compression = (level > max_level) ? max_level : level;
+    }
+
+    /// Get the preset dictionary compressing the records
+    inline const compressor::dictionary_type &dictionary() const noexcept {
+      return m_dictionary;
+    }
+
+    /// Set the preset zlib dictionary compressing the records, empty to
+    /// compress without dictionary. Small records sharing their names,
+    /// block headers and layouts compress much better with a dictionary
+    /// holding the common byte sequences. The dictionary is stored once
+    /// per file (see stream::set_dictionary())
+    void set_dictionary(const compressor::dictionary_type &dict);
+
+    /// Train the preset dictionary on the payloads of the next 'nrecords'
+    /// records written while the compression is on. These records are
+    /// compressed without the trained dictionary, the next ones with it
+    /// (see compressor::train_dictionary())
+    void train_dictionary(std::size_t nrecords, std::size_t size = compressor::max_dictionary_size);
+
+    /// Get the target size of the record groups (0: no grouping)
+    inline std::size_t grouping() const noexcept {
+      return m_grouping;
+    }
+
+    /// Set the target size of the record groups: the small compressed
+    /// records are compressed together by groups of about 'target' bytes
+    /// (see stream::set_grouping()), 0 to compress each record on its own.
+    /// The grouped records are written when their group is full or on
+    /// close(): their write errors are returned by these calls
+    void set_grouping(std::size_t target);
+
+    /// Set the number of low mantissa bits zeroed when writing float and
+    /// double values to the records written by write_record() (lossy,
+    /// see buffer::set_truncation())
+    inline void set_truncation(unsigned int float_bits, unsigned int double_bits = 0) noexcept {
+      m_buffer.set_truncation(float_bits, double_bits);
+    }
+
+    /// Get the maximum relative error introduced by the mantissa
+    /// truncation since the last call to set_truncation()
+    inline double truncation_error() const noexcept {
+      return m_buffer.truncation_error();
+    }
+
+    /// Set the file rotation limits, 0 meaning no limit. A new file is opened
+    /// when the next record would make the file bigger than 'max_size' bytes or
+    /// when the file holds 'max_records' records. The size includes the file
+    /// header and the dictionary records. Must be called before open()
+    inline void set_rotation(std::size_t max_size, std::size_t max_records = 0) noexcept {
+      m_max_size = max_size;
+      m_max_records = max_records;
+    }
+
+    /// The names of the files opened since open(), in opening order
+    inline const std::vector<std::string> &files() const noexcept {
+      return m_files;
+    }
+
     // write a record
     error_codes::code_type write_record(
       const string32 &name,                // the record name to write
@@ -114,9 +246,121 @@ namespace accio {
       const record_type &rec               // the record product to write: event, run header, etc ...
     );
 
+    /// Serialize a record in a buffer and fill its header and summary, without
+    /// writing it. The buffer is rewound first. This method doesn't modify the
+    /// writer and can be called concurrently from several threads
+    error_codes::code_type serialize_record(
+      const string32 &name,                // the record name to write
+      const record_io &io_config,          // the io config: record and block settings
+      const record_type &rec,              // the record product to serialize
+      io::record_header &header,           // the record header to fill
+      io::record_summary &summary,         // the record summary to fill
+      buffer_type &outbuf                  // the buffer receiving the record payload
+    ) const;
+
+    /// Serialize a record, see above. The block writers are created in 'writers',
+    /// which keeps its memory across records when reused by the caller
+    error_codes::code_type serialize_record(
+      const string32 &name,                // the record name to write
+      const record_io &io_config,          // the io config: record and block settings
+      const record_type &rec,              // the record product to serialize
+      io::record_header &header,           // the record header to fill
+      io::record_summary &summary,         // the record summary to fill
+      buffer_type &outbuf,                 // the buffer receiving the record payload
+      block_writers &writers               // the storage of the block writers
+    ) const;
+
+    /// Write a record with a static schema. The blocks are written by
+    /// direct calls, without creating block writers
+    template <typename... blocks>
+    error_codes::code_type write_record(
+      const string32 &name,                          // the record name to write
+      const record_schema<config, blocks...> &schema,  // the record layout
+      const record_type &rec                         // the record product to write
+    );
+
+    /// Serialize a record with a static schema, see serialize_record() above
+    template <typename... blocks>
+    error_codes::code_type serialize_record(
+      const string32 &name,                          // the record name to write
+      const record_schema<config, blocks...> &schema,  // the record layout
+      const record_type &rec,                        // the record product to serialize
+      io::record_header &header,                     // the record header to fill
+      io::record_summary &summary,                   // the record summary to fill
+      buffer_type &outbuf                            // the buffer receiving the record payload
+    ) const;
+
+    /// Write a record serialized with serialize_record()
+    error_codes::code_type write_record(
+      const io::record_header &header,
+      const io::record_summary &summary,
+      const buffer_type &outbuf
+    );
+
+  private:
+    /// An output shard: a sequence of files
+    struct shard {
+      /// The record stream of the current file
+      stream_type                  m_stream{};
+      /// The file name pattern
+      std::string                  m_pattern{};
+      /// The index of the current file in the sequence
+      std::size_t                  m_index{0};
+      /// The size of the current file
+      std::size_t                  m_size{0};
+      /// The number of records in the current file
+      std::size_t                  m_records{0};
+    };
+
+    /// Whether the rotation is enabled
+    inline bool rotation() const noexcept {
+      return (0 != m_max_size) or (0 != m_max_records);
+    }
+
+    /// Build a file name from a pattern and a file index
+    static std::string file_name(const std::string &pattern, std::size_t index);
+
+    /// Open the current file of a shard
+    error_codes::code_type open_shard(shard &output);
+
+    /// Start the serialization of a record: fill the record header,
+    /// clear the summary and rewind the buffer
+    void begin_record(const string32 &name, io::record_header &header, io::record_summary &summary, buffer_type &outbuf) const;
+
+    /// Finish the serialization of a record: set the record sizes
+    void end_record(io::record_header &header, const buffer_type &outbuf) const;
+
   private:
-    /// The record stream object
-    typename accio::stream<char_type, copy_type>                 m_stream{};
+    /// The output shards
+    std::vector<std::unique_ptr<shard>>                          m_shards{};
+    /// The shard receiving the next record
+    std::size_t                                                  m_next_shard{0};
+    /// The names of the opened files
+    std::vector<std::string>                                     m_files{};
+    /// Whether a checksum is written with each record
+    bool                                                         m_checksum{false};
+    /// The record compression level
+    unsigned int                                                 m_compression{0};
+    /// The target size of the record groups
+    std::size_t                                                  m_grouping{0};
+    /// The preset compression dictionary
+    compressor::dictionary_type                                  m_dictionary{};
+    /// The number of records to sample to train the dictionary
+    std::size_t                                                  m_training_records{0};
+    /// The size of the dictionary to train
+    std::size_t                                                  m_training_size{0};
+    /// The record payloads sampled to train the dictionary
+    std::vector<std::vector<unsigned char>>                      m_training_samples{};
+    /// The maximum file size (0: no limit)
+    std::size_t                                                  m_max_size{0};
+    /// The maximum number of records per file (0: no limit)
+    std::size_t                                                  m_max_records{0};
+    /// The record buffer, reused across records
+    buffer_type                                                  m_buffer{};
+    /// The record summary, reused across records
+    io::record_summary                                           m_summary{};
+    /// The block writers list, reused across records
+    block_writers                                                m_writers{};
   };
 }
 
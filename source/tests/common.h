@@ -0,0 +1,97 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+#ifndef ACCIO_TESTS_COMMON_H
+#define ACCIO_TESTS_COMMON_H 1
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <accio/writer.h>
+
+namespace fixture {
+
+  /// The io configuration of the test records
+  template <typename record, typename alloc = std::allocator<unsigned char>>
+  struct io_config {
+    typedef record                       record_type;
+    typedef unsigned char                char_type;
+    typedef accio::copy::standard        copy_type;
+    typedef alloc                        allocator_type;
+  };
+
+  /// A record made of an array of values
+  template <typename T>
+  struct event {
+    std::vector<T>    m_data{};
+  };
+
+  /// The values of a record: the record itself or the event data
+  template <typename T>
+  inline const std::vector<T> &values(const std::vector<T> &record) {
+    return record;
+  }
+
+  template <typename T>
+  inline const std::vector<T> &values(const event<T> &record) {
+    return record.m_data;
+  }
+
+  /// A block writing an array of values
+  template <typename config, typename T>
+  class vector_writer : public accio::block_writer<config> {
+  public:
+    typedef typename accio::block_writer<config>::buffer_type    buffer_type;
+
+    vector_writer(const std::string &name, const std::vector<T> &values) :
+      accio::block_writer<config>(name, name, 1),
+      m_values(values) {}
+
+    accio::error_codes::code_type write(buffer_type &outbuf) const {
+      outbuf.write_data(m_values);
+      return accio::error_codes::block::success;
+    }
+
+  private:
+    const std::vector<T>     &m_values;
+  };
+
+  /// A record written as 'nblocks' blocks holding the record values
+  template <typename config>
+  class vector_record : public accio::record_io<config> {
+  public:
+    typedef typename accio::record_io<config>::record_type      record_type;
+    typedef typename accio::record_io<config>::block_writers    block_writers;
+
+    vector_record(const std::string &name = "data", std::size_t nblocks = 1) :
+      m_name(name),
+      m_nblocks(nblocks) {}
+
+    accio::error_codes::code_type create_writers(const record_type &record, block_writers &blocks) const {
+      for(std::size_t b = 0 ; b < m_nblocks ; b++) {
+        blocks.push_back(make_writer(values(record)));
+      }
+      return accio::error_codes::record::success;
+    }
+
+  private:
+    template <typename T>
+    std::shared_ptr<vector_writer<config, T>> make_writer(const std::vector<T> &data) const {
+      return std::make_shared<vector_writer<config, T>>(m_name, data);
+    }
+
+  private:
+    const std::string      m_name;
+    const std::size_t      m_nblocks;
+  };
+}
+
+#endif  //  ACCIO_TESTS_COMMON_H
@@ -0,0 +1,112 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <cstdio>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/writer.h>
+
+// -- test fixtures
+#include <common.h>
+
+typedef fixture::io_config<std::vector<int>>            io_config;
+typedef fixture::vector_record<io_config>               value_record;
+
+std::vector<int> make_values(unsigned int index) {
+  std::vector<int> values(10000 + index % 1000);
+  for(std::size_t i = 0 ; i < values.size() ; i++) {
+    values[i] = static_cast<int>(index*31 + i*7);
+  }
+  return values;
+}
+
+int main() {
+
+  accio::unit_test test("accio_access_test");
+  const std::string fname = "test_accio_access.accio";
+  const unsigned int nrecords = 200;
+  {
+    accio::file_writer<io_config> writer;
+    writer.set_checksum(true);
+    value_record record("values");
+    writer.open(fname);
+    for(unsigned int i = 0 ; i < nrecords ; i++) {
+      writer.write_record("values", record, make_values(i));
+    }
+    writer.close();
+  }
+
+  // the records read in order in all the access modes, with small
+  // read ahead windows to go through the read ahead and drop paths
+  const accio::io::access_mode modes[] = {accio::io::access_mode::normal, accio::io::access_mode::sequential,
+    accio::io::access_mode::streaming, accio::io::access_mode::random};
+  for(auto mode : modes) {
+    for(std::size_t readahead : {std::size_t(0), std::size_t(64*1024), std::size_t(accio::stream<unsigned char>::default_readahead)}) {
+      accio::stream<unsigned char> stream;
+      accio::io::record_header header;
+      accio::io::record_summary summary;
+      accio::buffer<unsigned char> buffer(1024);
+      stream.set_access_mode(mode, readahead);
+      test.test("access mode", mode == stream.access_mode());
+      test.test("open", accio::error_codes::stream::success == stream.open(fname, accio::io::open_mode::read));
+      bool read_ok = true;
+      for(unsigned int i = 0 ; i < nrecords ; i++) {
+        std::vector<int> values;
+        read_ok = read_ok and (accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+        buffer.read_data(values);
+        read_ok = read_ok and (values == make_values(i));
+        // change the mode while reading
+        if(nrecords / 2 == i) {
+          stream.set_access_mode(accio::io::access_mode::streaming, readahead);
+        }
+      }
+      test.test("sequential reads", read_ok);
+      test.test("eof", accio::error_codes::stream::eof == stream.read_record(header, summary, buffer));
+      test.test("close", accio::error_codes::stream::success == stream.close());
+    }
+  }
+
+  // random reads, and backward moves in streaming mode
+  for(auto mode : {accio::io::access_mode::random, accio::io::access_mode::streaming}) {
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    accio::buffer<unsigned char> buffer(1024);
+    std::vector<accio::io::record_position> index;
+    stream.set_access_mode(mode, 64*1024);
+    stream.open(fname, accio::io::open_mode::read);
+    test.test("build index", (accio::error_codes::stream::success == stream.build_index(index)) and (nrecords == index.size()));
+    bool read_ok = true;
+    for(unsigned int i = 0 ; i < nrecords ; i++) {
+      const unsigned int r = (nrecords - 1 - i*37) % nrecords;
+      std::vector<int> values;
+      read_ok = read_ok and (accio::error_codes::stream::success == stream.seek_record(index[r]));
+      read_ok = read_ok and (accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+      buffer.read_data(values);
+      read_ok = read_ok and (values == make_values(r));
+    }
+    test.test("random reads", read_ok);
+    stream.close();
+  }
+
+  // the access mode is ignored in write mode
+  {
+    accio::stream<unsigned char> stream;
+    stream.set_access_mode(accio::io::access_mode::streaming);
+    test.test("open write", accio::error_codes::stream::success == stream.open(fname, accio::io::open_mode::write_new));
+    test.test("close write", accio::error_codes::stream::success == stream.close());
+  }
+  std::remove(fname.c_str());
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
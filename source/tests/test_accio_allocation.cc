@@ -0,0 +1,177 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/writer.h>
+
+// count the heap allocations while enabled
+static std::atomic<bool> count_enabled{false};
+static std::atomic<std::size_t> allocations{0};
+
+void *operator new(std::size_t size) {
+  if(count_enabled.load(std::memory_order_relaxed)) {
+    allocations++;
+  }
+  void *ptr = std::malloc(size ? size : 1);
+  if(nullptr == ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void *operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+struct event {
+  int                   m_event{0};
+  std::vector<float>    m_energies{};
+};
+
+struct io_config {
+  typedef event                        record_type;
+  typedef unsigned char                char_type;
+  typedef accio::copy::standard        copy_type;
+  typedef std::allocator<char_type>    allocator_type;
+};
+
+// a block writer bound to a new record when recycled
+class energies_writer : public accio::block_writer<io_config> {
+public:
+  energies_writer() :
+    accio::block_writer<io_config>("energies", "energies", 1) {}
+  void set_record(const event &evt) {
+    m_event = &evt;
+  }
+  accio::error_codes::code_type write(buffer_type &outbuf) const {
+    outbuf.write_data(m_event->m_event);
+    outbuf.write_data(m_event->m_energies);
+    return accio::error_codes::block::success;
+  }
+private:
+  const event     *m_event{nullptr};
+};
+
+// recycle the block writers in a pool
+class pooled_record : public accio::record_io<io_config> {
+public:
+  accio::error_codes::code_type create_writers(const event& record, block_writers &blocks) const {
+    for(int b=0 ; b<3 ; b++) {
+      std::shared_ptr<energies_writer> writer;
+      if(m_pool.empty()) {
+        writer = std::make_shared<energies_writer>();
+        m_created++;
+      }
+      else {
+        writer = m_pool.back();
+        m_pool.pop_back();
+      }
+      writer->set_record(record);
+      blocks.push_back(writer);
+    }
+    return accio::error_codes::record::success;
+  }
+  void release_writers(block_writers &blocks) const {
+    for(auto &block : blocks) {
+      m_pool.push_back(std::const_pointer_cast<energies_writer>(std::static_pointer_cast<const energies_writer>(block)));
+    }
+    blocks.clear();
+  }
+  std::size_t created() const {
+    return m_created;
+  }
+private:
+  mutable std::vector<std::shared_ptr<energies_writer>>    m_pool{};
+  mutable std::size_t                                      m_created{0};
+};
+
+struct energies_block {
+  static const char *type() { return "energies"; }
+  static const char *name() { return "energies"; }
+  static constexpr accio::types::version_type version() { return 1; }
+  template <typename buffer_type>
+  static accio::error_codes::code_type write(buffer_type &outbuf, const event &evt) {
+    outbuf.write_data(evt.m_event);
+    outbuf.write_data(evt.m_energies);
+    return accio::error_codes::block::success;
+  }
+};
+
+int main() {
+
+  accio::unit_test test("accio_allocation_test");
+
+  const std::string fname = "test_accio_allocation.accio";
+  const unsigned int nrecords = 100;
+  event evt;
+  evt.m_energies.assign(1000, 1.5f);
+  pooled_record record;
+  accio::record_schema<io_config, energies_block, energies_block> schema;
+  accio::file_writer<io_config> writer;
+  writer.set_checksum(true);
+  test.test("open writer", accio::error_codes::stream::success == writer.open(fname));
+
+  // warm up: the first records allocate the writers and the containers
+  test.test("write first record", accio::error_codes::stream::success == writer.write_record("event", record, evt));
+  test.test("write first static record", accio::error_codes::stream::success == writer.write_record("event", schema, evt));
+
+  count_enabled = true;
+  bool success = true;
+  for(unsigned int i=0 ; i<nrecords ; i++) {
+    evt.m_event = i;
+    success = success and (accio::error_codes::stream::success == writer.write_record("event", record, evt));
+    success = success and (accio::error_codes::stream::success == writer.write_record("event", schema, evt));
+  }
+  count_enabled = false;
+  test.test("write records", success);
+  test.test("no allocation per record", 0 == allocations.load());
+  test.test("block writers recycled", 3 == record.created());
+  writer.close();
+
+  // read back
+  accio::stream<unsigned char> stream;
+  accio::io::record_header header;
+  accio::io::record_summary summary;
+  accio::buffer<unsigned char> buffer(1024);
+  stream.open(fname, accio::io::open_mode::read);
+  unsigned int nread = 0;
+  while(accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) {
+    nread++;
+  }
+  test.test("read all records", 2*(nrecords + 1) == nread);
+  stream.close();
+  std::remove(fname.c_str());
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
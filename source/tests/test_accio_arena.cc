@@ -0,0 +1,89 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <limits>
+#include <new>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/arena.h>
+#include <accio/buffer.h>
+
+struct track {
+  track(int id) : m_id(id) {}
+  int                m_id;
+  float              m_momentum[3];
+};
+
+struct counted {
+  counted(int &counter) : m_counter(counter) {}
+  ~counted() { m_counter++; }
+  int               &m_counter;
+};
+
+int main() {
+
+  accio::unit_test test("accio_arena_test");
+
+  accio::arena arena(4096);
+  test.test("empty arena", 0 == arena.allocated());
+
+  auto trk = arena.create<track>(42);
+  test.test("create object", 42 == trk->m_id);
+  test.test("object alignment", 0 == (reinterpret_cast<std::uintptr_t>(trk) % alignof(track)));
+  auto dbl = arena.create_array<double>(10);
+  test.test("array alignment", 0 == (reinterpret_cast<std::uintptr_t>(dbl) % alignof(double)));
+  test.test("allocated size", arena.allocated() >= sizeof(track) + 10*sizeof(double));
+
+  // allocation larger than a chunk
+  auto big = arena.create_array<char>(10000);
+  test.test("large allocation", nullptr != big);
+  bool overflow = false;
+  try {
+    arena.create_array<double>(std::numeric_limits<accio::arena::size_type>::max() / sizeof(double) + 1);
+  }
+  catch(const std::bad_array_new_length &) {
+    overflow = true;
+  }
+  test.test("array size overflow", overflow);
+
+  int destroyed = 0;
+  arena.create<counted>(destroyed);
+  arena.create<counted>(destroyed);
+  auto capacity = arena.capacity();
+  arena.reset();
+  test.test("destructors called on reset", 2 == destroyed);
+  test.test("reset arena", 0 == arena.allocated());
+
+  // second record: the chunks are re-used
+  auto trk2 = arena.create<track>(43);
+  test.test("memory re-used after reset", static_cast<void*>(trk2) == static_cast<void*>(trk));
+  arena.create_array<char>(10000);
+  test.test("no new chunk after reset", capacity == arena.capacity());
+
+  // std containers with arena allocator
+  std::vector<int, accio::arena_allocator<int>> vec{accio::arena_allocator<int>(arena)};
+  for(int i=0 ; i<1000 ; i++) {
+    vec.push_back(i);
+  }
+  test.test("vector in arena", 999 == vec[999]);
+
+  // buffer with arena allocator
+  typedef accio::arena_allocator<unsigned char> buffer_allocator;
+  accio::buffer<unsigned char, accio::copy::standard, buffer_allocator> wbuf(16, buffer_allocator(arena));
+  std::vector<float> data(100, 3.f);
+  test.test("buffer write in arena", 4 + 100*sizeof(float) == wbuf.write_data(data));
+  test.test("buffer allocator", &arena == wbuf.get_allocator().get_arena());
+  arena.reset();
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
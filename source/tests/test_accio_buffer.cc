@@ -12,6 +12,19 @@
 #include <accio/testing/unit_test.h>
 #include <accio/buffer.h>
 
+struct hit {
+  float   m_x;
+  float   m_y;
+  float   m_z;
+  float   m_energy;
+};
+
+namespace accio {
+  template <> struct copy_unit<hit> {
+    typedef float type;
+  };
+}
+
 int main() {
 
   accio::unit_test test("accio_buffer_test");
@@ -38,6 +51,91 @@ int main() {
   test.test("buffer read back integer", sizeof(int) == rbuf.read_data(rval));
   test.test("compare write and read", rval == wval);
 
+  // zero-copy read of a float array
+  float warr[5] = {1.f, 2.f, 3.f, 4.f, 5.f};
+  accio::buffer<unsigned char> wbuf2(len);
+  wbuf2.write_data(warr[0], 5);
+  accio::buffer<unsigned char> rbuf2(wbuf2.begin(), wbuf2.tell(), true);
+  accio::array_view<float> view;
+  test.test("buffer read view", 5*sizeof(float) == rbuf2.read_view(view, 5));
+  test.test("view size", 5 == view.size());
+  test.test("view points in buffer", static_cast<const void*>(view.data()) == static_cast<const void*>(rbuf2.begin()));
+  test.test("view element", 3.f == view[2]);
+  test.test("buffer position after view", 0 == rbuf2.remaining());
+  try {
+    view.at(5);
+    test.test("view out of range", false);
+  }
+  catch(std::out_of_range &except) {
+    test.test("view out of range", true);
+  }
+  rbuf2.seekpos(0);
+  accio::array_view<float> bigview;
+  test.test("view larger than buffer", 0 == rbuf2.read_view(bigview, 6));
+  test.test("view larger than buffer is empty", bigview.empty());
+
+  // padded sizes of arrays of 4 GB and more don't wrap
+  test.test("padded size", (0 == accio::io::padded_size(4, 0)) and (8 == accio::io::padded_size(1, 5)) and (12 == accio::io::padded_size(3, 3)));
+  if(sizeof(std::size_t) > 4) {
+    const std::size_t four_gb = static_cast<std::size_t>(accio::io::size32_max) + 1;
+    test.test("padded size 4 GB", four_gb == accio::io::padded_size(1, four_gb - 1));
+    test.test("padded size above 4 GB", four_gb + 4 == accio::io::padded_size(4, four_gb / 4 + 1));
+    test.test("padded size large count", 3*four_gb == accio::io::padded_size(8, 3*four_gb / 8));
+  }
+
+  // bulk vector write/read, forcing a buffer expansion
+  std::vector<float> wvec(1000);
+  for(unsigned int i=0 ; i<wvec.size() ; i++) {
+    wvec[i] = 0.5f*i;
+  }
+  accio::buffer<unsigned char> wbuf3(16);
+  test.test("buffer write vector", 4 + 1000*sizeof(float) == wbuf3.write_data(wvec));
+  test.test("buffer expanded", wbuf3.size() >= 4 + 1000*sizeof(float));
+  std::array<int, 3> warr3 = {{7, 8, 9}};
+  test.test("buffer write array", 3*sizeof(int) == wbuf3.write_data(warr3));
+  accio::buffer<unsigned char> rbuf3(wbuf3.begin(), wbuf3.tell(), true);
+  std::vector<float> rvec(3, 0.f);
+  test.test("buffer read vector", 4 + 1000*sizeof(float) == rbuf3.read_data(rvec));
+  test.test("read vector size", 1000 == rvec.size());
+  test.test("compare vectors", wvec == rvec);
+  std::array<int, 3> rarr3 = {{0, 0, 0}};
+  test.test("buffer read array", 3*sizeof(int) == rbuf3.read_data(rarr3));
+  test.test("compare arrays", warr3 == rarr3);
+  std::array<int, 0> empty_array;
+  test.test("buffer write empty array", 0 == wbuf3.write_data(empty_array));
+  test.test("buffer read empty array", 0 == rbuf3.read_data(empty_array));
+  rbuf3.seekpos(0);
+  accio::array_view<float> vecview;
+  test.test("buffer read vector view", 4 + 1000*sizeof(float) == rbuf3.read_view(vecview));
+  test.test("vector view size", 1000 == vecview.size());
+  test.test("vector view element", wvec[999] == vecview[999]);
+
+  // structs converted per field by non-native copy policies
+  std::vector<hit> whits(2);
+  whits[0] = {1.f, 2.f, 3.f, 4.f};
+  whits[1] = {5.f, 6.f, 7.f, 8.f};
+  accio::buffer<unsigned char, accio::copy::big_endian> wbuf4(64);
+  test.test("buffer write structs", 4 + 2*sizeof(hit) == wbuf4.write_data(whits));
+  accio::buffer<unsigned char, accio::copy::big_endian> rbuf4(wbuf4.begin(), wbuf4.tell(), true);
+  std::vector<hit> rhits;
+  test.test("buffer read structs", 4 + 2*sizeof(hit) == rbuf4.read_data(rhits));
+  test.test("read structs size", 2 == rhits.size());
+  test.test("compare structs", (rhits[1].m_y == 6.f) and (rhits[1].m_energy == 8.f));
+  accio::buffer<unsigned char, accio::copy::big_endian> rbuf5(wbuf4.begin(), 12, true);
+  test.test("buffer read truncated vector", 0 == rbuf5.read_data(rhits));
+  test.test("truncated vector eof", rbuf5.eof());
+  test.test("truncated vector position", 0 == rbuf5.tell());
+
+  // reader makes right: swap only the data written in the opposite byte order
+  accio::buffer<unsigned char> rbuf6(wbuf4.begin(), wbuf4.tell(), true);
+  rbuf6.set_byte_swap(not accio::copy::big_endian::native);
+  test.test("buffer read swapped structs", 4 + 2*sizeof(hit) == rbuf6.read_data(rhits));
+  test.test("compare swapped structs", (rhits[0].m_x == 1.f) and (rhits[1].m_energy == 8.f));
+  accio::buffer<unsigned char, accio::copy::big_endian> rbuf7(wbuf3.begin(), wbuf3.tell(), true);
+  rbuf7.set_byte_swap(not accio::copy::big_endian::native);
+  test.test("swapped vector view", 4 + 1000*sizeof(float) == rbuf7.read_view(vecview));
+  test.test("swapped vector view element", wvec[999] == vecview[999]);
+
   std::cout << "TEST_PASSED" << std::endl;
   return 0;
 }
@@ -0,0 +1,97 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/writer.h>
+
+// -- test fixtures
+#include <common.h>
+
+typedef fixture::event<float>                           event;
+typedef fixture::io_config<event>                       io_config;
+typedef fixture::vector_record<io_config>               event_record;
+
+int main() {
+
+  accio::unit_test test("accio_checksum_test");
+
+  // reference value from RFC 3720
+  const char *ref = "123456789";
+  test.test("software crc32c", 0xe3069283 == accio::checksum::crc32c_software(ref, 9));
+  test.test("crc32c", 0xe3069283 == accio::checksum::crc32c(ref, 9));
+  test.test("crc32c in two steps", 0xe3069283 == accio::checksum::crc32c(ref + 4, 5, accio::checksum::crc32c(ref, 4)));
+
+  std::vector<unsigned char> data(30011);
+  for(unsigned int i=0 ; i<data.size() ; i++) {
+    data[i] = static_cast<unsigned char>(i*31 + 7);
+  }
+  bool same = true;
+  for(unsigned int offset=0 ; offset<9 ; offset++) {
+    same = same and (accio::checksum::crc32c_hardware(&data[offset], data.size() - offset) ==
+      accio::checksum::crc32c_software(&data[offset], data.size() - offset));
+  }
+  test.test("hardware and software crc32c", not accio::checksum::hardware_available() or same);
+
+  // write records with checksums
+  const std::string fname = "test_accio_checksum.accio";
+  const unsigned int nrecords = 10;
+  accio::file_writer<io_config> writer;
+  writer.set_checksum(true);
+  test.test("open writer", accio::error_codes::stream::success == writer.open(fname));
+  event_record evt_record("samples");
+  event evt;
+  for(unsigned int i=0 ; i<nrecords ; i++) {
+    evt.m_data.assign(1000 + i, 0.1f*i);
+    test.test("write record", accio::error_codes::stream::success == writer.write_record("event", evt_record, evt));
+  }
+  writer.close();
+
+  // read them back, synchronous and asynchronous verification
+  accio::io::record_header header;
+  accio::io::record_summary summary;
+  accio::buffer<unsigned char> buffer(1024);
+  for(auto mode : {accio::io::verify_mode::sync, accio::io::verify_mode::async}) {
+    accio::stream<unsigned char> stream;
+    stream.set_verify_mode(mode);
+    test.test("open reader", accio::error_codes::stream::success == stream.open(fname, accio::io::open_mode::read));
+    unsigned int nread = 0;
+    while(accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) {
+      nread++;
+    }
+    test.test("verify all records", nread == nrecords);
+    test.test("no pending failure", accio::error_codes::stream::success == stream.wait_checksum());
+    stream.close();
+  }
+
+  // corrupt a byte in the payload of the second record
+  FILE *file = fopen(fname.c_str(), "r+b");
+  // header, summary size, summary, payload (sample count + samples), checksum
+  long record_len = sizeof(accio::io::disk_record_header) + 4 + sizeof(accio::io::disk_block_summary) + 4 + 1000*sizeof(float) + 4;
+  fseek(file, sizeof(accio::io::file_header) + record_len + record_len/2, SEEK_SET);
+  fputc(0x42, file);
+  fclose(file);
+
+  accio::stream<unsigned char> stream;
+  stream.open(fname, accio::io::open_mode::read);
+  test.test("read first record", accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+  test.test("detect corruption", accio::error_codes::stream::bad_checksum == stream.read_record(header, summary, buffer));
+  stream.close();
+  stream.set_verify_mode(accio::io::verify_mode::async);
+  stream.open(fname, accio::io::open_mode::read);
+  test.test("read first record async", accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+  test.test("read second record async", accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+  test.test("detect corruption async", accio::error_codes::stream::bad_checksum == stream.wait_checksum());
+  stream.close();
+  std::remove(fname.c_str());
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
@@ -0,0 +1,168 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/concurrent_writer.h>
+
+// -- test fixtures
+#include <common.h>
+
+typedef fixture::event<unsigned int>                    event;
+typedef fixture::io_config<event>                       io_config;
+typedef fixture::vector_record<io_config>               event_record;
+
+struct item : public accio::mpsc_node {
+  unsigned int     m_producer{0};
+  unsigned int     m_value{0};
+};
+
+int main() {
+
+  accio::unit_test test("accio_concurrent_test");
+
+  const unsigned int nproducers = 4;
+  const unsigned int nitems = 10000;
+
+  // queue: concurrent producers, FIFO per producer
+  accio::mpsc_queue<item> queue;
+  test.test("empty queue", (nullptr == queue.pop()) and queue.empty());
+  {
+    item first, second;
+    queue.push(&first);
+    test.test("not empty", not queue.empty());
+    queue.push(&second);
+    test.test("pop first", (&first == queue.pop()) and not queue.empty());
+    test.test("pop last", (&second == queue.pop()) and queue.empty());
+  }
+  std::vector<item> items(nproducers*nitems);
+  std::vector<std::thread> producers;
+  for(unsigned int p=0 ; p<nproducers ; p++) {
+    producers.emplace_back([&, p]() {
+      for(unsigned int i=0 ; i<nitems ; i++) {
+        auto &it = items[p*nitems + i];
+        it.m_producer = p;
+        it.m_value = i;
+        queue.push(&it);
+      }
+    });
+  }
+  std::vector<unsigned int> next(nproducers, 0);
+  unsigned int npopped = 0;
+  bool ordered = true;
+  while(npopped < nproducers*nitems) {
+    auto it = queue.pop();
+    if(nullptr == it) {
+      std::this_thread::yield();
+      continue;
+    }
+    ordered = ordered and (next[it->m_producer] == it->m_value);
+    next[it->m_producer]++;
+    npopped++;
+  }
+  for(auto &producer : producers) {
+    producer.join();
+  }
+  test.test("queue order", ordered);
+  test.test("queue drained", (nullptr == queue.pop()) and queue.empty());
+
+  // writer: concurrent producers, atomic records
+  const std::string fname = "test_accio_concurrent.accio";
+  const unsigned int nrecords = 500;
+  accio::concurrent_writer<io_config> writer(8);
+  writer.set_checksum(true);
+  test.test("open", accio::error_codes::stream::success == writer.open(fname));
+  event_record evt_record;
+  std::vector<accio::error_codes::code_type> statuses(nproducers, accio::error_codes::code_type(accio::error_codes::stream::success));
+  producers.clear();
+  for(unsigned int p=0 ; p<nproducers ; p++) {
+    producers.emplace_back([&, p]() {
+      event evt;
+      for(unsigned int i=0 ; i<nrecords ; i++) {
+        evt.m_data.assign(10 + (i % 50)*p, p);
+        evt.m_data[1] = i;
+        auto status = writer.write_record("event", evt_record, evt);
+        if(accio::error_codes::stream::success != status) {
+          statuses[p] = status;
+        }
+      }
+    });
+  }
+  for(auto &producer : producers) {
+    producer.join();
+  }
+  test.test("close", accio::error_codes::stream::success == writer.close());
+  for(auto status : statuses) {
+    test.test("write records", accio::error_codes::stream::success == status);
+  }
+
+  // read back: all the records, valid, in order per producer
+  accio::stream<unsigned char> stream;
+  accio::io::record_header header;
+  accio::io::record_summary summary;
+  accio::buffer<unsigned char> buffer(1024);
+  event evt;
+  std::fill(next.begin(), next.end(), 0);
+  ordered = true;
+  unsigned int nread = 0;
+  stream.open(fname, accio::io::open_mode::read);
+  while(accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) {
+    buffer.read_data(evt.m_data);
+    const unsigned int p = evt.m_data[0];
+    ordered = ordered and (p < nproducers) and (next[p] == evt.m_data[1]) and (evt.m_data.size() == 10 + (next[p] % 50)*p);
+    next[p]++;
+    nread++;
+  }
+  stream.close();
+  test.test("read records", nproducers*nrecords == nread);
+  test.test("records order", ordered);
+  std::remove(fname.c_str());
+
+  test.test("closed", accio::error_codes::stream::not_open == writer.write_record("event", evt_record, evt));
+
+  // close while the producers write: every record accepted is written
+  std::vector<unsigned int> naccepted(nproducers, 0);
+  test.test("open again", accio::error_codes::stream::success == writer.open(fname));
+  producers.clear();
+  for(unsigned int p=0 ; p<nproducers ; p++) {
+    producers.emplace_back([&, p]() {
+      event pevt;
+      pevt.m_data.assign(200, p);
+      while(accio::error_codes::stream::success == writer.write_record("event", evt_record, pevt)) {
+        naccepted[p]++;
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  test.test("close while writing", accio::error_codes::stream::success == writer.close());
+  for(auto &producer : producers) {
+    producer.join();
+  }
+  nread = 0;
+  stream.open(fname, accio::io::open_mode::read);
+  while(accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) {
+    nread++;
+  }
+  stream.close();
+  unsigned int total_accepted = 0;
+  for(auto n : naccepted) {
+    total_accepted += n;
+  }
+  test.test("accepted records written", (total_accepted > 0) and (total_accepted == nread));
+  std::remove(fname.c_str());
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
@@ -0,0 +1,170 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <cstring>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/descriptor.h>
+
+struct hit {
+  float                 m_x{0.f};
+  float                 m_y{0.f};
+  double                m_time{0.};
+  int                   m_cell[2] = {0, 0};
+  short                 m_flag{0};
+  std::vector<float>    m_energies{};
+};
+
+struct event {
+  int                   m_event{0};
+  int                   m_run{0};
+  hit                   m_hit{};
+  std::vector<int>      m_ids{};
+};
+
+namespace accio {
+  template <>
+  struct descriptor<hit> {
+    static constexpr auto fields() {
+      return make_fields(&hit::m_x, &hit::m_y, &hit::m_time, &hit::m_cell, &hit::m_flag, &hit::m_energies);
+    }
+  };
+
+  template <>
+  struct descriptor<event> {
+    static constexpr auto fields() {
+      return make_fields(&event::m_event, &event::m_run, &event::m_hit, &event::m_ids);
+    }
+  };
+}
+
+struct io_config {
+  typedef event                        record_type;
+  typedef unsigned char                char_type;
+  typedef accio::copy::standard        copy_type;
+  typedef std::allocator<char_type>    allocator_type;
+};
+
+// the field by field version
+template <typename buffer_type>
+void write_by_hand(buffer_type &outbuf, const event &evt) {
+  outbuf.write_data(evt.m_event);
+  outbuf.write_data(evt.m_run);
+  outbuf.write_data(evt.m_hit.m_x);
+  outbuf.write_data(evt.m_hit.m_y);
+  outbuf.write_data(evt.m_hit.m_time);
+  outbuf.write_data(evt.m_hit.m_cell);
+  outbuf.write_data(evt.m_hit.m_flag);
+  outbuf.write_data(evt.m_hit.m_energies);
+  outbuf.write_data(evt.m_ids);
+}
+
+bool same_event(const event &lhs, const event &rhs) {
+  return (lhs.m_event == rhs.m_event) and (lhs.m_run == rhs.m_run) and
+    (lhs.m_hit.m_x == rhs.m_hit.m_x) and (lhs.m_hit.m_y == rhs.m_hit.m_y) and
+    (lhs.m_hit.m_time == rhs.m_hit.m_time) and (lhs.m_hit.m_cell[1] == rhs.m_hit.m_cell[1]) and
+    (lhs.m_hit.m_flag == rhs.m_hit.m_flag) and (lhs.m_hit.m_energies == rhs.m_hit.m_energies) and
+    (lhs.m_ids == rhs.m_ids);
+}
+
+template <typename copy_type>
+bool same_layout(const event &evt) {
+  accio::buffer<unsigned char, copy_type> generated(16), by_hand(16);
+  auto len = accio::write_fields(generated, evt);
+  write_by_hand(by_hand, evt);
+  return (len == generated.tell()) and (generated.tell() == by_hand.tell()) and
+    (0 == std::memcmp(generated.begin(), by_hand.begin(), by_hand.tell()));
+}
+
+template <typename copy_type>
+bool same_truncation(const event &evt) {
+  accio::buffer<unsigned char, copy_type> generated(16), by_hand(16);
+  generated.set_truncation(12, 30);
+  by_hand.set_truncation(12, 30);
+  auto len = accio::write_fields(generated, evt);
+  write_by_hand(by_hand, evt);
+  return (len == generated.tell()) and (generated.tell() == by_hand.tell()) and
+    (0 == std::memcmp(generated.begin(), by_hand.begin(), by_hand.tell())) and
+    (generated.truncation_error() > 0.) and (generated.truncation_error() == by_hand.truncation_error());
+}
+
+int main() {
+
+  accio::unit_test test("accio_descriptor_test");
+
+  test.test("has descriptor", accio::has_descriptor<event>::value and not accio::has_descriptor<int>::value);
+  test.test("mergeable fields", accio::mergeable_field<double>::value and not accio::mergeable_field<short>::value);
+  test.test("not mergeable vector", not accio::mergeable_field<std::vector<int>>::value);
+
+  event evt;
+  evt.m_event = 42;
+  evt.m_run = 7;
+  evt.m_hit.m_x = 1.5f;
+  evt.m_hit.m_y = -2.f;
+  evt.m_hit.m_time = 12.25;
+  evt.m_hit.m_cell[0] = 3;
+  evt.m_hit.m_cell[1] = 4;
+  evt.m_hit.m_flag = 9;
+  evt.m_hit.m_energies = {0.1f, 0.2f};
+  evt.m_ids = {1, 2, 3};
+
+  // the merged copies keep the field by field layout
+  test.test("native layout", same_layout<accio::copy::standard>(evt));
+  test.test("big endian layout", same_layout<accio::copy::big_endian>(evt));
+  test.test("little endian layout", same_layout<accio::copy::little_endian>(evt));
+
+  // round trips
+  accio::buffer<unsigned char> wbuf(16);
+  test.test("write fields", 0 != accio::write_fields(wbuf, evt));
+  accio::buffer<unsigned char> rbuf(wbuf.begin(), wbuf.tell(), true);
+  event read_evt;
+  test.test("read fields", wbuf.tell() == accio::read_fields(rbuf, read_evt));
+  test.test("same event", same_event(evt, read_evt));
+  accio::buffer<unsigned char> rbuf_short(wbuf.begin(), 20, true);
+  test.test("read truncated fields", 0 == accio::read_fields(rbuf_short, read_evt));
+
+  // data written in big endian, read with byte swapping
+  accio::buffer<unsigned char, accio::copy::big_endian> wbuf_be(16);
+  accio::write_fields(wbuf_be, evt);
+  accio::buffer<unsigned char> rbuf_swap(wbuf_be.begin(), wbuf_be.tell(), true);
+  rbuf_swap.set_byte_swap(not accio::copy::big_endian::native);
+  read_evt = event();
+  test.test("read swapped fields", wbuf_be.tell() == accio::read_fields(rbuf_swap, read_evt));
+  test.test("same swapped event", same_event(evt, read_evt));
+
+  // the merged float and double fields are truncated as field by field
+  evt.m_hit.m_x = 1.2345678f;
+  evt.m_hit.m_y = -2.7182818f;
+  evt.m_hit.m_time = 12.3456789012345;
+  evt.m_hit.m_energies = {0.1234567f, 0.2345678f};
+  test.test("native truncation", same_truncation<accio::copy::standard>(evt));
+  test.test("big endian truncation", same_truncation<accio::copy::big_endian>(evt));
+
+  // generated block writer and reader
+  accio::field_block_writer<io_config, event> writer("event", "event", accio::version::encode(1, 0), evt);
+  accio::buffer<unsigned char> block_buf(16);
+  test.test("block writer", accio::error_codes::block::success == writer.write(block_buf));
+  accio::block_reader_registry<io_config> registry;
+  registry.add(std::make_shared<accio::field_block_reader<io_config, event>>("event", 1, [](event &e) -> event& { return e; }));
+  registry.add(std::make_shared<accio::field_block_reader<io_config, hit>>("hit", 1, [](event &e) -> hit& { return e.m_hit; }));
+  accio::io::record_summary summary(1);
+  summary[0].m_type = "event";
+  summary[0].m_version = accio::version::encode(1, 0);
+  summary[0].m_size = block_buf.tell();
+  accio::buffer<unsigned char> block_rbuf(block_buf.begin(), block_buf.tell(), true);
+  read_evt = event();
+  test.test("block reader", accio::error_codes::record::success == registry.read_blocks(block_rbuf, summary, read_evt));
+  test.test("same block event", same_event(evt, read_evt));
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
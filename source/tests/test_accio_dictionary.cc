@@ -0,0 +1,285 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <cstdint>
+#include <cstdio>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/writer.h>
+#include <accio/recovery.h>
+
+struct hit {
+  int                   m_cell{0};
+  float                 m_energy{0.f};
+  std::string           m_detector{};
+};
+
+struct io_config {
+  typedef std::vector<hit>             record_type;
+  typedef unsigned char                char_type;
+  typedef accio::copy::standard        copy_type;
+  typedef std::allocator<char_type>    allocator_type;
+};
+
+class hit_writer : public accio::block_writer<io_config> {
+public:
+  hit_writer(const std::vector<hit> &hits) :
+    accio::block_writer<io_config>("hits", "hits", 1),
+    m_hits(hits) {}
+  accio::error_codes::code_type write(buffer_type &outbuf) const {
+    outbuf.write_data(static_cast<std::uint32_t>(m_hits.size()));
+    for(auto &h : m_hits) {
+      outbuf.write_data(h.m_cell);
+      outbuf.write_data(h.m_energy);
+      outbuf.write_data(std::vector<char>(h.m_detector.begin(), h.m_detector.end()));
+    }
+    return accio::error_codes::block::success;
+  }
+private:
+  const std::vector<hit>     &m_hits;
+};
+
+class hit_record : public accio::record_io<io_config> {
+public:
+  accio::error_codes::code_type create_writers(const std::vector<hit>& record, block_writers &blocks) const {
+    blocks.push_back(std::make_shared<hit_writer>(record));
+    return accio::error_codes::record::success;
+  }
+};
+
+// small records: a few hits in named detectors
+std::vector<hit> make_hits(unsigned int seed) {
+  const char *detectors[] = {"ElectromagneticCalorimeterBarrel", "HadronicCalorimeterEndcap", "SiliconVertexDetectorLayer"};
+  std::vector<hit> hits(5 + seed % 7);
+  for(auto &h : hits) {
+    seed = seed*1664525u + 1013904223u;
+    h.m_cell = static_cast<int>(seed >> 16);
+    h.m_energy = static_cast<float>(seed >> 24) * 0.25f;
+    h.m_detector = detectors[(seed >> 8) % 3];
+  }
+  return hits;
+}
+
+bool read_hits(accio::buffer<unsigned char> &buffer, const std::vector<hit> &expected) {
+  std::uint32_t nhits = 0;
+  buffer.read_data(nhits);
+  if(nhits != expected.size()) {
+    return false;
+  }
+  for(auto &h : expected) {
+    hit read_hit;
+    std::vector<char> detector;
+    buffer.read_data(read_hit.m_cell);
+    buffer.read_data(read_hit.m_energy);
+    buffer.read_data(detector);
+    read_hit.m_detector.assign(detector.begin(), detector.end());
+    if((read_hit.m_cell != h.m_cell) or (read_hit.m_energy != h.m_energy) or (read_hit.m_detector != h.m_detector)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// write the records, read them back and return the file size
+std::size_t write_and_check(accio::unit_test &test, const std::string &fname, accio::file_writer<io_config> &writer, unsigned int nrecords) {
+  hit_record record;
+  test.test("open writer", accio::error_codes::stream::success == writer.open(fname));
+  for(unsigned int i = 0 ; i < nrecords ; i++) {
+    test.test("write record", accio::error_codes::stream::success == writer.write_record("hits", record, make_hits(i)));
+  }
+  writer.close();
+  accio::stream<unsigned char> stream;
+  accio::io::record_header header;
+  accio::io::record_summary summary;
+  accio::buffer<unsigned char> buffer(1024);
+  stream.set_verify_mode(accio::io::verify_mode::sync);
+  test.test("open reader", accio::error_codes::stream::success == stream.open(fname, accio::io::open_mode::read));
+  bool read_ok = true;
+  for(unsigned int i = 0 ; i < nrecords ; i++) {
+    read_ok = read_ok and (accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+    read_ok = read_ok and (0 == (header.m_options & accio::io::option::dictionary_record)) and read_hits(buffer, make_hits(i));
+  }
+  test.test("read records", read_ok);
+  test.test("no more record", accio::error_codes::stream::success != stream.read_record(header, summary, buffer));
+  stream.close();
+  accio::record_scanner scanner(1024);
+  accio::scan_report report;
+  test.test("scan", accio::error_codes::stream::success == scanner.scan(fname, report));
+  test.test("scan safe size", report.m_file_size == report.m_safe_size);
+  return report.m_file_size;
+}
+
+int main() {
+
+  accio::unit_test test("accio_dictionary_test");
+  const std::string fname = "test_accio_dictionary.accio";
+  const unsigned int nrecords = 200;
+
+  // the compressor and decompressor alone
+  std::vector<accio::compressor::dictionary_type> samples;
+  for(unsigned int i = 0 ; i < 20 ; i++) {
+    const std::string text = "run 42 event " + std::to_string(i) + " detector ElectromagneticCalorimeterBarrel status ok";
+    samples.emplace_back(text.begin(), text.end());
+  }
+  auto dictionary = accio::compressor::train_dictionary(samples, 256);
+  test.test("trained dictionary size", (not dictionary.empty()) and (dictionary.size() <= 256));
+  test.test("no common segment", accio::compressor::train_dictionary({samples[0]}).empty());
+  accio::compressor comp;
+  accio::decompressor decomp;
+  const auto &sample = samples.back();
+  std::vector<unsigned char> output(sample.size());
+  test.test("compress with dictionary", comp.begin(9, sample.size(), &dictionary));
+  comp.update(sample.data(), sample.size());
+  const auto with_dict = comp.finish();
+  comp.begin(9, sample.size());
+  comp.update(sample.data(), sample.size());
+  const auto without_dict = comp.finish();
+  test.test("dictionary compresses better", (0 != with_dict) and (with_dict < without_dict));
+  comp.begin(9, sample.size(), &dictionary);
+  comp.update(sample.data(), sample.size());
+  const auto size = comp.finish();
+  test.test("uncompress with dictionary", decomp.uncompress(comp.data(), size, output.data(), output.size(), &dictionary) and (output == sample));
+  test.test("uncompress without dictionary", not decomp.uncompress(comp.data(), size, output.data(), output.size()));
+
+  // the reference: compressed records without dictionary
+  std::size_t plain_size = 0;
+  {
+    accio::file_writer<io_config> writer;
+    writer.set_checksum(true);
+    writer.set_compression(6);
+    plain_size = write_and_check(test, fname, writer, nrecords);
+    std::remove(fname.c_str());
+  }
+
+  // a dictionary trained on the first records
+  std::size_t trained_size = 0;
+  {
+    accio::file_writer<io_config> writer;
+    writer.set_checksum(true);
+    writer.set_compression(6);
+    writer.train_dictionary(20, 4096);
+    trained_size = write_and_check(test, fname, writer, nrecords);
+    test.test("dictionary trained", (not writer.dictionary().empty()) and (writer.dictionary().size() <= 4096));
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    test.test("open scanner", accio::error_codes::stream::success == stream.open(fname, accio::io::open_mode::read));
+    test.test("dictionary feature", 0 != (stream.file_header().m_features & accio::io::feature::dictionary));
+    unsigned int nheaders = 0, ndict = 0;
+    while(accio::error_codes::stream::success == stream.next_header(header)) {
+      nheaders++;
+      ndict += (0 != accio::io::dictionary_id(header.m_options)) ? 1 : 0;
+    }
+    test.test("dictionary record hidden", nrecords == nheaders);
+    test.test("records with dictionary", (ndict > 0) and (ndict <= nrecords - 20));
+    stream.close();
+    std::remove(fname.c_str());
+  }
+  std::cout << "File sizes (no dictionary, trained dictionary): " << plain_size << ", " << trained_size << std::endl;
+  test.test("trained dictionary compresses better", trained_size < plain_size);
+
+  // a user dictionary, with rotation: each file holds the dictionary
+  {
+    const std::string pattern = "test_accio_dictionary_{}.accio";
+    accio::file_writer<io_config> writer;
+    writer.set_compression(6);
+    const std::string common = "ElectromagneticCalorimeterBarrelHadronicCalorimeterEndcapSiliconVertexDetectorLayer";
+    writer.set_dictionary(accio::compressor::dictionary_type(common.begin(), common.end()));
+    writer.set_rotation(0, 50);
+    hit_record record;
+    test.test("open rotation", accio::error_codes::stream::success == writer.open(pattern));
+    for(unsigned int i = 0 ; i < nrecords ; i++) {
+      writer.write_record("hits", record, make_hits(i));
+    }
+    writer.close();
+    const auto files = writer.files();
+    test.test("rotated files", 4 == files.size());
+    unsigned int index = 0;
+    bool read_ok = true;
+    for(auto &file : files) {
+      accio::stream<unsigned char> stream;
+      accio::io::record_header header;
+      accio::io::record_summary summary;
+      accio::buffer<unsigned char> buffer(1024);
+      read_ok = read_ok and (accio::error_codes::stream::success == stream.open(file, accio::io::open_mode::read));
+      while(accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) {
+        read_ok = read_ok and (0 != accio::io::dictionary_id(header.m_options)) and read_hits(buffer, make_hits(index++));
+      }
+      stream.close();
+      std::remove(file.c_str());
+    }
+    test.test("read rotated files", read_ok and (nrecords == index));
+  }
+
+  // the dictionary records count in the rotation size
+  {
+    const std::string pattern = "test_accio_dictionary_{}.accio";
+    std::string common;
+    while(common.size() < 4000) {
+      common += "ElectromagneticCalorimeterBarrelHadronicCalorimeterEndcapSiliconVertexDetectorLayer";
+    }
+    std::size_t first_records[2] = {0, 0};
+    for(int with_dictionary = 0 ; with_dictionary < 2 ; with_dictionary++) {
+      accio::file_writer<io_config> writer;
+      writer.set_compression(6);
+      if(with_dictionary) {
+        writer.set_dictionary(accio::compressor::dictionary_type(common.begin(), common.end()));
+      }
+      writer.set_rotation(10000);
+      hit_record record;
+      writer.open(pattern);
+      for(unsigned int i = 0 ; i < nrecords ; i++) {
+        writer.write_record("hits", record, make_hits(i));
+      }
+      writer.close();
+      for(auto &file : writer.files()) {
+        accio::stream<unsigned char> stream;
+        accio::io::record_header header;
+        stream.open(file, accio::io::open_mode::read);
+        std::size_t nfile = 0;
+        while(accio::error_codes::stream::success == stream.next_header(header)) {
+          nfile++;
+        }
+        stream.close();
+        if(file == writer.files().front()) {
+          first_records[with_dictionary] = nfile;
+        }
+        std::remove(file.c_str());
+      }
+    }
+    test.test("dictionary in rotation size", (first_records[1] > 0) and (first_records[1] < first_records[0]));
+  }
+
+  // an empty dictionary turns the dictionary off
+  {
+    accio::file_writer<io_config> writer;
+    writer.set_compression(6);
+    writer.set_dictionary(dictionary);
+    writer.set_dictionary(accio::compressor::dictionary_type());
+    hit_record record;
+    writer.open(fname);
+    writer.write_record("hits", record, make_hits(1));
+    writer.close();
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    accio::buffer<unsigned char> buffer(1024);
+    stream.open(fname, accio::io::open_mode::read);
+    test.test("dictionary feature off", 0 == (stream.file_header().m_features & accio::io::feature::dictionary));
+    test.test("read without dictionary", (accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) and
+      (0 == accio::io::dictionary_id(header.m_options)) and read_hits(buffer, make_hits(1)));
+    stream.close();
+    std::remove(fname.c_str());
+  }
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
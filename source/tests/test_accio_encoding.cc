@@ -0,0 +1,229 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <cstdint>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/buffer.h>
+#include <accio/encoding.h>
+
+/// Simple linear congruential generator
+struct generator {
+  std::uint64_t next() {
+    m_state = m_state*6364136223846793005ull + 1442695040888963407ull;
+    return m_state >> 11;
+  }
+  std::uint64_t     m_state{42};
+};
+
+bool bitpack_round_trip(std::size_t count, unsigned int bits) {
+  generator gen;
+  const std::uint64_t mask = (bits >= 64) ? ~0ull : ((1ull << bits) - 1);
+  std::uint64_t values[accio::bitpack::block_size] = {}, unpacked[accio::bitpack::block_size] = {};
+  std::uint32_t values32[accio::bitpack::block_size] = {}, unpacked32[accio::bitpack::block_size] = {}, scalar32[accio::bitpack::block_size] = {};
+  accio::bitpack::word_type words[accio::bitpack::words(accio::bitpack::block_size, 64) + 1];
+  for(std::size_t k = 0 ; k < count ; k++) {
+    values[k] = gen.next() & mask;
+    values32[k] = static_cast<std::uint32_t>(values[k]);
+  }
+  // the packed block must not overflow
+  words[accio::bitpack::words(count, bits)] = 0xdeadbeef;
+  accio::bitpack::pack(values, count, bits, words);
+  bool same = (0xdeadbeef == words[accio::bitpack::words(count, bits)]);
+  accio::bitpack::unpack(words, count, bits, unpacked);
+  same = same and std::equal(values, values + count, unpacked);
+  if(bits <= 32) {
+    accio::bitpack::pack(values32, count, bits, words);
+    accio::bitpack::unpack(words, count, bits, unpacked32);
+    accio::bitpack::unpack_scalar(words, count, bits, scalar32);
+    same = same and std::equal(values32, values32 + count, unpacked32) and std::equal(values32, values32 + count, scalar32);
+  }
+  return same;
+}
+
+template <typename copy_type, typename T>
+bool round_trip(const std::vector<T> &data, accio::encoding enc, std::size_t *size = nullptr) {
+  accio::buffer<unsigned char, copy_type> wbuf(16);
+  auto len = accio::write_encoded(wbuf, data, enc);
+  accio::buffer<unsigned char> rbuf(wbuf.begin(), wbuf.tell(), true);
+  rbuf.set_byte_swap(not copy_type::native);
+  std::vector<T> read_data;
+  bool same = (0 != len) and (len == wbuf.tell()) and (len == accio::read_encoded(rbuf, read_data)) and (data == read_data);
+  if(nullptr != size) {
+    *size = len;
+  }
+  return same;
+}
+
+template <typename T>
+bool all_round_trips(const std::vector<T> &data) {
+  bool same = true;
+  for(auto enc : {accio::encoding::raw, accio::encoding::frame_of_reference, accio::encoding::delta,
+    accio::encoding::delta_of_delta, accio::encoding::packed, accio::encoding::automatic}) {
+    same = same and round_trip<accio::copy::standard>(data, enc);
+    same = same and round_trip<accio::copy::big_endian>(data, enc);
+  }
+  return same;
+}
+
+template <typename T>
+bool all_sizes(void (*fill)(std::vector<T>&, std::size_t)) {
+  bool same = true;
+  for(std::size_t count : {0, 1, 2, 3, 5, 127, 128, 129, 130, 300, 1000}) {
+    std::vector<T> data;
+    fill(data, count);
+    same = same and all_round_trips(data);
+  }
+  return same;
+}
+
+template <typename T>
+void fill_sorted(std::vector<T> &data, std::size_t count) {
+  generator gen;
+  T value = 0;
+  for(std::size_t i = 0 ; i < count ; i++) {
+    value += static_cast<T>(gen.next() % 50);
+    data.push_back(value);
+  }
+}
+
+template <typename T>
+void fill_random(std::vector<T> &data, std::size_t count) {
+  generator gen;
+  for(std::size_t i = 0 ; i < count ; i++) {
+    data.push_back(static_cast<T>(gen.next() << 11));
+  }
+}
+
+int main() {
+
+  accio::unit_test test("accio_encoding_test");
+
+  test.test("width 0", 0 == accio::bitpack::width(0));
+  test.test("width 1", 1 == accio::bitpack::width(1));
+  test.test("width 32", 32 == accio::bitpack::width(0xffffffff));
+  test.test("width 64", 64 == accio::bitpack::width(~0ull));
+
+  bool same = true;
+  for(unsigned int bits = 0 ; bits <= 64 ; bits++) {
+    for(std::size_t count : {1, 3, 64, 127, 128}) {
+      same = same and bitpack_round_trip(count, bits);
+    }
+  }
+  test.test("bitpack round trips", same);
+
+  // round trips, all encodings, native and swapped
+  test.test("sorted int", all_sizes<int>(fill_sorted));
+  test.test("sorted unsigned", all_sizes<unsigned int>(fill_sorted));
+  test.test("sorted int64", all_sizes<std::int64_t>(fill_sorted));
+  test.test("sorted uint64", all_sizes<std::uint64_t>(fill_sorted));
+  test.test("sorted short", all_sizes<short>(fill_sorted));
+  test.test("random int", all_sizes<int>(fill_random));
+  test.test("random uint64", all_sizes<std::uint64_t>(fill_random));
+  test.test("random char", all_sizes<char>(fill_random));
+  test.test("extreme values", all_round_trips(std::vector<int>{0x7fffffff, -0x7fffffff - 1, 0, -1, 0x7fffffff}));
+  test.test("decreasing values", all_round_trips(std::vector<std::int64_t>{1000, 900, 850, 700, -20}));
+
+  // compression of sorted arrays: timestamps with a fixed period
+  std::vector<std::uint64_t> timestamps;
+  for(std::uint64_t i = 0 ; i < 1000 ; i++) {
+    timestamps.push_back(1600000000000ull + 25*i);
+  }
+  std::size_t raw_size = 0, delta_size = 0, dod_size = 0;
+  test.test("timestamps raw", round_trip<accio::copy::standard>(timestamps, accio::encoding::raw, &raw_size));
+  test.test("timestamps delta", round_trip<accio::copy::standard>(timestamps, accio::encoding::delta, &delta_size));
+  test.test("timestamps delta of delta", round_trip<accio::copy::standard>(timestamps, accio::encoding::delta_of_delta, &dod_size));
+  test.test("raw size", raw_size, std::size_t(8 + 8*1000));
+  test.test("delta size", delta_size, std::size_t(8 + 2*8));
+  test.test("delta of delta size", dod_size, std::size_t(8 + 3*8));
+  test.test("best encoding", accio::encoding::delta == accio::best_encoding(timestamps));
+  std::vector<int> ids;
+  fill_sorted(ids, 1000);
+  test.test("best encoding sorted", accio::encoding::delta == accio::best_encoding(ids));
+  std::vector<int> small_ids;
+  for(int i = 0 ; i < 1000 ; i++) {
+    small_ids.push_back(100 + (i*7919) % 13);
+  }
+  test.test("best encoding small range", accio::encoding::frame_of_reference == accio::best_encoding(small_ids));
+  std::vector<int> random_ids;
+  fill_random(random_ids, 1000);
+  test.test("best encoding random", accio::encoding::raw == accio::best_encoding(random_ids));
+
+  // truncated and mismatching data
+  accio::buffer<unsigned char> wbuf(16);
+  accio::write_encoded(wbuf, ids, accio::encoding::delta);
+  accio::buffer<unsigned char> rbuf_short(wbuf.begin(), wbuf.tell() - 4, true);
+  std::vector<int> read_ids;
+  test.test("read truncated", 0 == accio::read_encoded(rbuf_short, read_ids));
+  test.test("truncated position", 0 == rbuf_short.tell());
+  accio::buffer<unsigned char> rbuf_type(wbuf.begin(), wbuf.tell(), true);
+  std::vector<std::int64_t> read_ids64;
+  test.test("read other type", 0 == accio::read_encoded(rbuf_type, read_ids64));
+
+  // constant arrays: zero bit values up to max_zero_width, one bit beyond
+  for(std::size_t count : {std::size_t(100), accio::details::max_zero_width, accio::details::max_zero_width + 1000}) {
+    std::vector<int> constant(count, 42);
+    std::size_t size = 0;
+    same = round_trip<accio::copy::standard>(constant, accio::encoding::frame_of_reference, &size);
+    const std::size_t packed_size = (count > accio::details::max_zero_width) ? 4*((count + 31)/32) : 0;
+    test.test("constant array " + std::to_string(count), same and (8 + sizeof(int) + packed_size == size));
+  }
+
+  // a corrupted count of zero bit values isn't decoded
+  accio::buffer<unsigned char> corrupt_buf(16);
+  const accio::types::size_type corrupt_count = 4000000000u;
+  const accio::types::option_word corrupt_word = static_cast<accio::types::option_word>(accio::encoding::frame_of_reference) | (sizeof(int) << 16);
+  const int references[2] = {0, 0};
+  corrupt_buf.write_data(corrupt_count);
+  corrupt_buf.write_data(corrupt_word);
+  corrupt_buf.write_data(references[0], 2);
+  accio::buffer<unsigned char> corrupt_rbuf(corrupt_buf.begin(), corrupt_buf.tell(), true);
+  test.test("read corrupted count", (0 == accio::read_encoded(corrupt_rbuf, read_ids)) and (0 == corrupt_rbuf.tell()));
+
+  // bit packed flags and status codes
+  for(std::size_t count : {0, 1, 31, 33, 128, 1000}) {
+    std::vector<bool> flags(count);
+    for(std::size_t i = 0 ; i < count ; i++) {
+      flags[i] = (0 == (i*2654435761u) % 3);
+    }
+    accio::buffer<unsigned char, accio::copy::big_endian> flag_buf(16);
+    const std::size_t flag_size = accio::write_packed(flag_buf, flags);
+    accio::buffer<unsigned char> flag_rbuf(flag_buf.begin(), flag_buf.tell(), true);
+    flag_rbuf.set_byte_swap(not accio::copy::big_endian::native);
+    std::vector<bool> read_flags;
+    same = (8 + 4*((count + 31)/32) == flag_size) and (flag_size == accio::read_packed(flag_rbuf, read_flags)) and (flags == read_flags);
+    test.test("packed flags " + std::to_string(count), same);
+  }
+  std::vector<unsigned char> codes;
+  std::vector<short> signed_codes;
+  for(int i = 0 ; i < 1000 ; i++) {
+    codes.push_back(static_cast<unsigned char>((i*7) % 16));
+    signed_codes.push_back(static_cast<short>((i*7) % 16 - 8));
+  }
+  accio::buffer<unsigned char> code_buf(16);
+  test.test("packed codes", 8 + 4*125 == accio::write_packed(code_buf, codes, 4));
+  test.test("packed signed codes", 8 + 4*125 == accio::write_packed(code_buf, signed_codes, 4));
+  test.test("code out of range", 0 == accio::write_packed(code_buf, codes, 3));
+  test.test("signed code out of range", 0 == accio::write_packed(code_buf, signed_codes, 3));
+  test.test("width out of range", 0 == accio::write_packed(code_buf, codes, 9));
+  accio::buffer<unsigned char> code_rbuf(code_buf.begin(), code_buf.tell(), true);
+  std::vector<unsigned char> read_codes;
+  std::vector<short> read_signed_codes;
+  test.test("read packed codes", 8 + 4*125 == accio::read_packed(code_rbuf, read_codes));
+  test.test("read packed signed codes", 8 + 4*125 == accio::read_encoded(code_rbuf, read_signed_codes));
+  test.test("same codes", codes == read_codes);
+  test.test("same signed codes", signed_codes == read_signed_codes);
+  test.test("packed width", 4 == accio::details::value_width(signed_codes.data(), signed_codes.size()));
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
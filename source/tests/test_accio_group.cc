@@ -0,0 +1,226 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <algorithm>
+#include <cstdio>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/writer.h>
+#include <accio/recovery.h>
+
+// -- test fixtures
+#include <common.h>
+
+typedef fixture::io_config<std::vector<int>>            io_config;
+typedef fixture::vector_record<io_config>               value_record;
+
+// slow control like records: a few slowly varying values.
+// Every 100th record is big, written on its own
+std::vector<int> make_values(unsigned int index) {
+  std::vector<int> values((0 == index % 100) ? 20000 : 8 + index % 5);
+  for(std::size_t i = 0 ; i < values.size() ; i++) {
+    values[i] = static_cast<int>(1000 + 10*i + index % 17);
+  }
+  return values;
+}
+
+accio::string32 record_name(unsigned int index) {
+  return (0 == index % 10) ? "status" : "sensors";
+}
+
+bool read_values(accio::buffer<unsigned char> &buffer, unsigned int index) {
+  std::vector<int> values;
+  buffer.read_data(values);
+  return values == make_values(index);
+}
+
+std::size_t write_file(const std::string &fname, std::size_t grouping, unsigned int nrecords, bool dictionary = false, bool close = true) {
+  {
+    accio::file_writer<io_config> writer;
+    writer.set_checksum(true);
+    writer.set_compression(6);
+    writer.set_grouping(grouping);
+    if(dictionary) {
+      writer.train_dictionary(20, 1024);
+    }
+    value_record record("values");
+    writer.open(fname);
+    for(unsigned int i = 0 ; i < nrecords ; i++) {
+      writer.write_record(record_name(i), record, make_values(i));
+    }
+    // else closed by the writer destructor
+    if(close) {
+      writer.close();
+    }
+  }
+  accio::record_scanner scanner(1024);
+  accio::scan_report report;
+  scanner.scan(fname, report);
+  return report.m_records.size();
+}
+
+int main() {
+
+  accio::unit_test test("accio_group_test");
+  const std::string fname = "test_accio_group.accio";
+  const unsigned int nrecords = 1000;
+
+  // the reference: each record compressed on its own
+  test.test("ungrouped records", nrecords == write_file(fname, 0, nrecords));
+  FILE *file = std::fopen(fname.c_str(), "rb");
+  std::fseek(file, 0, SEEK_END);
+  const long ungrouped_size = std::ftell(file);
+  std::fclose(file);
+
+  // small records grouped by 4 KB
+  const std::size_t nstored = write_file(fname, 4096, nrecords);
+  test.test("grouped records", nstored < nrecords / 10);
+  file = std::fopen(fname.c_str(), "rb");
+  std::fseek(file, 0, SEEK_END);
+  const long grouped_size = std::ftell(file);
+  std::fclose(file);
+  std::cout << "File sizes (ungrouped, grouped): " << ungrouped_size << ", " << grouped_size << " with " << nstored << " records on disk" << std::endl;
+  test.test("grouping compresses better", grouped_size < ungrouped_size);
+  // a writer destroyed without close() writes its pending group and the
+  // file features: the reads below check them
+  test.test("closed on destruction", nstored == write_file(fname, 4096, nrecords, false, false));
+
+  // sequential reads, synchronous and asynchronous verification
+  for(auto mode : {accio::io::verify_mode::sync, accio::io::verify_mode::async}) {
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    accio::buffer<unsigned char> buffer(1024);
+    stream.set_verify_mode(mode);
+    test.test("open reader", accio::error_codes::stream::success == stream.open(fname, accio::io::open_mode::read));
+    test.test("groups feature", 0 != (stream.file_header().m_features & accio::io::feature::groups));
+    bool read_ok = true;
+    for(unsigned int i = 0 ; i < nrecords ; i++) {
+      read_ok = read_ok and (accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+      read_ok = read_ok and (header.m_name == record_name(i)) and (0 == (header.m_options & accio::io::option::group));
+      read_ok = read_ok and (1 == summary.size()) and (summary[0].m_name == "values") and read_values(buffer, i);
+    }
+    test.test("read records", read_ok);
+    test.test("eof", accio::error_codes::stream::eof == stream.read_record(header, summary, buffer));
+    test.test("checksum", accio::error_codes::stream::success == stream.wait_checksum());
+    stream.close();
+  }
+
+  // headers, skips and searches see the grouped records
+  {
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    accio::buffer<unsigned char> buffer(1024);
+    stream.open(fname, accio::io::open_mode::read);
+    unsigned int nheaders = 0;
+    bool names_ok = true;
+    while(accio::error_codes::stream::success == stream.next_header(header, &summary)) {
+      names_ok = names_ok and (header.m_name == record_name(nheaders)) and (1 == summary.size());
+      nheaders++;
+    }
+    test.test("next header", (nrecords == nheaders) and names_ok);
+    stream.close();
+    stream.open(fname, accio::io::open_mode::read);
+    std::size_t nstored_headers = 0, ngroups = 0;
+    bool stored_ok = true;
+    while(accio::error_codes::stream::success == stream.next_stored_header(header, &summary)) {
+      const bool group = (0 != (header.m_options & accio::io::option::group));
+      stored_ok = stored_ok and ((not group) or ((header.m_name == accio::io::group_name()) and (header.m_compsize < header.m_uncompsize)));
+      ngroups += group ? 1 : 0;
+      nstored_headers++;
+    }
+    test.test("stored headers", stored_ok and (nstored == nstored_headers) and (ngroups > 0));
+    stream.close();
+    stream.open(fname, accio::io::open_mode::read);
+    test.test("skip records", accio::error_codes::stream::success == stream.skip_record() and
+      accio::error_codes::stream::success == stream.skip_record());
+    unsigned int found = 0;
+    bool found_ok = true;
+    while(accio::error_codes::stream::success == stream.find_record("status", header, summary, buffer)) {
+      found_ok = found_ok and read_values(buffer, 10*(found + 1));
+      found++;
+    }
+    test.test("find records", found_ok and (nrecords / 10 - 1 == found));
+    stream.close();
+  }
+
+  // random reads from the index
+  {
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    accio::buffer<unsigned char> buffer(1024);
+    std::vector<accio::io::record_position> index;
+    stream.open(fname, accio::io::open_mode::read);
+    test.test("build index", accio::error_codes::stream::success == stream.build_index(index));
+    test.test("index size", nrecords == index.size());
+    test.test("big record ungrouped", accio::io::ungrouped == index[100].m_group_offset);
+    test.test("small record grouped", (accio::io::ungrouped != index[101].m_group_offset) and (index[101].m_offset == index[102].m_offset));
+    test.test("rewinded", (accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) and read_values(buffer, 0));
+    bool random_ok = true;
+    for(unsigned int i = 0 ; i < nrecords ; i++) {
+      const unsigned int r = (i * 7919) % nrecords;
+      random_ok = random_ok and (accio::error_codes::stream::success == stream.seek_record(index[r]));
+      random_ok = random_ok and (accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) and read_values(buffer, r);
+    }
+    test.test("random reads", random_ok);
+    // the records following a cached group are read from the file
+    bool next_ok = (accio::error_codes::stream::success == stream.seek_record(index[150]));
+    for(unsigned int i = 150 ; i < 250 ; i++) {
+      next_ok = next_ok and (accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) and read_values(buffer, i);
+    }
+    next_ok = next_ok and (accio::error_codes::stream::success == stream.seek_record(index[160]));
+    for(unsigned int i = 160 ; i < 210 ; i++) {
+      next_ok = next_ok and (accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) and read_values(buffer, i);
+    }
+    test.test("sequential reads after seek", next_ok);
+    accio::io::record_position bad = index[101];
+    bad.m_group_offset = 1 << 30;
+    test.test("bad position", accio::error_codes::stream::no_such_record == stream.seek_record(bad));
+    stream.close();
+  }
+  std::remove(fname.c_str());
+
+  // groups compressed with a trained dictionary
+  {
+    write_file(fname, 4096, nrecords, true);
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    accio::buffer<unsigned char> buffer(1024);
+    std::vector<accio::io::record_position> index;
+    stream.open(fname, accio::io::open_mode::read);
+    bool read_ok = true;
+    for(unsigned int i = 0 ; i < nrecords ; i++) {
+      read_ok = read_ok and (accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) and read_values(buffer, i);
+    }
+    test.test("read with dictionary", read_ok);
+    stream.close();
+    stream.open(fname, accio::io::open_mode::read);
+    test.test("index with dictionary", (accio::error_codes::stream::success == stream.build_index(index)) and (nrecords == index.size()));
+    test.test("seek with dictionary", (accio::error_codes::stream::success == stream.seek_record(index[nrecords - 1])) and
+      (accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) and read_values(buffer, nrecords - 1));
+    stream.close();
+    // an index built by another stream: the dictionary is loaded on the first seek
+    stream.open(fname, accio::io::open_mode::read);
+    test.test("seek before dictionary", (accio::error_codes::stream::success == stream.seek_record(index[nrecords/2])) and
+      (accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) and read_values(buffer, nrecords/2));
+    test.test("read after dictionary", (accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) and
+      read_values(buffer, nrecords/2 + 1));
+    stream.close();
+    std::remove(fname.c_str());
+  }
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
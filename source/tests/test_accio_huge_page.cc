@@ -0,0 +1,168 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/concurrent_writer.h>
+#include <accio/huge_page_allocator.h>
+
+// -- test fixtures
+#include <common.h>
+
+typedef fixture::event<unsigned int>                    event;
+typedef fixture::io_config<event, accio::huge_page_allocator<unsigned char>> io_config;
+typedef fixture::vector_record<io_config>               event_record;
+
+void make_event(event &evt, unsigned int producer, unsigned int index) {
+  // from a few hundred bytes to a few MB
+  evt.m_data.resize((0 == index % 10) ? 1000000 + index : 100 + index);
+  for(std::size_t i = 0 ; i < evt.m_data.size() ; i++) {
+    evt.m_data[i] = static_cast<unsigned int>(producer*100000 + index + i);
+  }
+  evt.m_data[0] = producer;
+  evt.m_data[1] = index;
+}
+
+bool huge_aligned(const void *ptr) {
+  return 0 == reinterpret_cast<std::uintptr_t>(ptr) % accio::details::huge_page_size;
+}
+
+int main() {
+
+  accio::unit_test test("accio_huge_page_test");
+  std::cout << "Transparent huge pages enabled: " << accio::huge_pages_enabled() << std::endl;
+  const bool mapping = accio::details::huge_page_mapping();
+
+  // allocator
+  {
+    typedef accio::huge_page_allocator<unsigned char> byte_allocator;
+    byte_allocator alloc;
+    test.test("small not huge", not byte_allocator::is_huge(1024));
+    test.test("large huge", mapping == byte_allocator::is_huge(accio::details::huge_page_size));
+    unsigned char *small = alloc.allocate(1024);
+    small[0] = 1; small[1023] = 2;
+    test.test("small allocation", (1 == small[0]) and (2 == small[1023]));
+    alloc.deallocate(small, 1024);
+    const std::size_t len = 5*1024*1024 + 17;
+    unsigned char *large = alloc.allocate(len);
+    test.test("large aligned", (not mapping) or huge_aligned(large));
+    bool written = true;
+    for(std::size_t i = 0 ; i < len ; i += 4096) {
+      large[i] = static_cast<unsigned char>(i / 4096);
+    }
+    large[len - 1] = 42;
+    for(std::size_t i = 0 ; i < len ; i += 4096) {
+      written = written and (large[i] == static_cast<unsigned char>(i / 4096));
+    }
+    test.test("large allocation", written and (42 == large[len - 1]));
+    alloc.deallocate(large, len);
+    // the fallback mapping, unmapped as the huge page ones
+    void *pages = accio::details::page_map(len);
+    test.test("fallback mapping", (not mapping) or (nullptr != pages));
+    if(nullptr != pages) {
+      static_cast<unsigned char*>(pages)[len - 1] = 42;
+      test.test("fallback memory", 42 == static_cast<unsigned char*>(pages)[len - 1]);
+      accio::details::huge_page_unmap(pages, len);
+    }
+    // rebind keeps the threshold: 1 MB of ints is huge with a 1 MB threshold
+    typedef accio::huge_page_allocator<unsigned char, 1024*1024> mb_allocator;
+    typedef typename mb_allocator::template rebind<int>::other int_allocator;
+    int_allocator ialloc = mb_allocator();
+    test.test("rebind threshold", (mapping == int_allocator::is_huge(256*1024)) and not int_allocator::is_huge(256*1024 - 1));
+    test.test("always equal", (ialloc == mb_allocator()) and not (ialloc != mb_allocator()));
+    int *ints = ialloc.allocate(300*1024);
+    ints[300*1024 - 1] = 7;
+    test.test("rebind allocation", ((not mapping) or huge_aligned(ints)) and (7 == ints[300*1024 - 1]));
+    ialloc.deallocate(ints, 300*1024);
+  }
+
+  // buffer growing from normal to huge pages
+  {
+    accio::buffer<unsigned char, accio::copy::standard, accio::huge_page_allocator<unsigned char>> buffer(1024);
+    std::vector<double> values(1000000);
+    for(std::size_t i = 0 ; i < values.size() ; i++) {
+      values[i] = 0.5*i;
+    }
+    buffer.write_data(values);
+    test.test("buffer grown", buffer.memsize() >= values.size()*sizeof(double));
+    test.test("buffer aligned", (not mapping) or huge_aligned(buffer.begin()));
+    buffer.reset(buffer.size(), std::ios_base::in);
+    std::vector<double> read_values;
+    buffer.read_data(read_values);
+    test.test("buffer data", values == read_values);
+  }
+
+  // concurrent writer: the buffer pool backed by huge pages
+  const std::string fname = "test_accio_huge_page.accio";
+  const unsigned int nproducers = 2;
+  const unsigned int nrecords = 40;
+  {
+    accio::concurrent_writer<io_config> writer(4);
+    writer.set_checksum(true);
+    test.test("open", accio::error_codes::stream::success == writer.open(fname));
+    event_record evt_record;
+    std::vector<accio::error_codes::code_type> statuses(nproducers, accio::error_codes::code_type(accio::error_codes::stream::success));
+    std::vector<std::thread> producers;
+    for(unsigned int p=0 ; p<nproducers ; p++) {
+      producers.emplace_back([&, p]() {
+        event evt;
+        for(unsigned int i=0 ; i<nrecords ; i++) {
+          make_event(evt, p, i);
+          auto status = writer.write_record("event", evt_record, evt);
+          if(accio::error_codes::stream::success != status) {
+            statuses[p] = status;
+          }
+        }
+      });
+    }
+    for(auto &producer : producers) {
+      producer.join();
+    }
+    test.test("close", accio::error_codes::stream::success == writer.close());
+    for(auto status : statuses) {
+      test.test("write records", accio::error_codes::stream::success == status);
+    }
+  }
+
+  // read back with a huge page buffer
+  {
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    io_config::allocator_type alloc;
+    accio::buffer<unsigned char, accio::copy::standard, io_config::allocator_type> buffer(1024, alloc);
+    std::vector<unsigned int> next(nproducers, 0);
+    event evt, expected;
+    bool read_ok = true;
+    unsigned int nread = 0;
+    stream.open(fname, accio::io::open_mode::read);
+    while(accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) {
+      buffer.read_data(evt.m_data);
+      const unsigned int p = evt.m_data[0];
+      read_ok = read_ok and (p < nproducers);
+      if(p < nproducers) {
+        make_event(expected, p, next[p]++);
+        read_ok = read_ok and (evt.m_data == expected.m_data);
+      }
+      nread++;
+    }
+    stream.close();
+    test.test("read records", read_ok and (nproducers*nrecords == nread));
+  }
+  std::remove(fname.c_str());
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
@@ -0,0 +1,117 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/buffer.h>
+
+template <typename F>
+std::vector<F> make_values(std::size_t count) {
+  std::vector<F> values(count);
+  unsigned int state = 7;
+  for(std::size_t i = 0 ; i < count ; i++) {
+    state = state*1664525u + 1013904223u;
+    values[i] = static_cast<F>(state) / static_cast<F>(1000) - static_cast<F>(2000000);
+  }
+  return values;
+}
+
+/// Check the truncated values against a bit mask and the error bound
+template <typename F, typename U>
+bool check_truncation(const std::vector<F> &values, const std::vector<F> &truncated, unsigned int bits, double error, unsigned int mantissa_bits) {
+  const U mask = (static_cast<U>(1) << bits) - 1;
+  double max_error = 0.;
+  for(std::size_t i = 0 ; i < values.size() ; i++) {
+    U word, ref;
+    std::memcpy(&word, &truncated[i], sizeof(word));
+    std::memcpy(&ref, &values[i], sizeof(ref));
+    if((0 != (word & mask)) or (word != (ref & ~mask))) {
+      return false;
+    }
+    max_error = std::max(max_error, std::fabs((static_cast<double>(values[i]) - truncated[i]) / values[i]));
+  }
+  return (error <= accio::mantissa::error_bound(bits, mantissa_bits)) and
+    (std::fabs(error - max_error) <= 1e-6 * max_error) and (max_error > 0.);
+}
+
+int main() {
+
+  accio::unit_test test("accio_mantissa_test");
+
+  test.test("float error bound", std::ldexp(1., -11) == accio::mantissa::error_bound(12, accio::mantissa::float_bits));
+  test.test("double error bound", std::ldexp(1., -32) == accio::mantissa::error_bound(20, accio::mantissa::double_bits));
+
+  // the kernel on all the tail lengths
+  bool valid = true;
+  for(std::size_t count : {1, 2, 3, 4, 5, 7, 8, 1001}) {
+    auto floats = make_values<float>(count);
+    std::vector<float> truncated_floats(count);
+    auto error = accio::mantissa::truncate(floats.data(), count, 12, truncated_floats.data());
+    valid = valid and check_truncation<float, std::uint32_t>(floats, truncated_floats, 12, error, accio::mantissa::float_bits);
+    auto doubles = make_values<double>(count);
+    std::vector<double> truncated_doubles(count);
+    error = accio::mantissa::truncate(doubles.data(), count, 40, truncated_doubles.data());
+    valid = valid and check_truncation<double, std::uint64_t>(doubles, truncated_doubles, 40, error, accio::mantissa::double_bits);
+  }
+  test.test("truncate values", valid);
+
+  // special values are left untouched
+  const float specials[] = {0.f, -0.f, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+    std::numeric_limits<float>::quiet_NaN(), 1.f, 1.00048828125f, std::numeric_limits<float>::denorm_min()};
+  float truncated_specials[8];
+  auto special_error = accio::mantissa::truncate(specials, 8, 23, truncated_specials);
+  test.test("truncate zero", (0.f == truncated_specials[0]) and std::signbit(truncated_specials[1]));
+  test.test("truncate infinities", std::isinf(truncated_specials[2]) and std::isinf(truncated_specials[3]));
+  test.test("truncate nan", std::isnan(truncated_specials[4]));
+  test.test("truncate normal", (1.f == truncated_specials[5]) and (1.f == truncated_specials[6]));
+  test.test("truncate denormal", 0.f == truncated_specials[7]);
+  test.test("denormal error", 1. == special_error);
+
+  // buffer write mode
+  auto values = make_values<float>(1000);
+  accio::buffer<unsigned char> wbuf(16);
+  test.test("default truncation", (0 == wbuf.float_truncation()) and (0 == wbuf.double_truncation()));
+  wbuf.set_truncation(16, 100);
+  test.test("set truncation", (16 == wbuf.float_truncation()) and (accio::mantissa::double_bits == wbuf.double_truncation()));
+  test.test("write truncated vector", 4 + 1000*sizeof(float) == wbuf.write_data(values));
+  test.test("write truncated value", sizeof(float) == wbuf.write_data(values[0]));
+  const int ivalue = 0x7fffffff;
+  test.test("write integer", sizeof(int) == wbuf.write_data(ivalue));
+  test.test("truncation error", (wbuf.truncation_error() > 0.) and (wbuf.truncation_error() <= accio::mantissa::error_bound(16, accio::mantissa::float_bits)));
+  accio::buffer<unsigned char> rbuf(wbuf.begin(), wbuf.tell(), true);
+  std::vector<float> read_values;
+  float read_value = 0.f;
+  int read_ivalue = 0;
+  rbuf.read_data(read_values);
+  rbuf.read_data(read_value);
+  rbuf.read_data(read_ivalue);
+  std::vector<float> truncated_values(1000);
+  accio::mantissa::truncate(values.data(), 1000, 16, truncated_values.data());
+  test.test("read truncated vector", truncated_values == read_values);
+  test.test("read truncated value", truncated_values[0] == read_value);
+  test.test("integers untouched", ivalue == read_ivalue);
+
+  // truncation before a non native copy policy
+  accio::buffer<unsigned char, accio::copy::big_endian> wbuf_be(16);
+  wbuf_be.set_truncation(16);
+  wbuf_be.write_data(values);
+  accio::buffer<unsigned char> rbuf_be(wbuf_be.begin(), wbuf_be.tell(), true);
+  rbuf_be.set_byte_swap(not accio::copy::big_endian::native);
+  rbuf_be.read_data(read_values);
+  test.test("read swapped truncated vector", truncated_values == read_values);
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
@@ -0,0 +1,87 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/reader.h>
+
+struct event {
+  int       m_event{0};
+  int       m_run{0};
+  int       m_version{0};
+};
+
+struct io_config {
+  typedef event                        record_type;
+  typedef unsigned char                char_type;
+  typedef accio::copy::standard        copy_type;
+  typedef std::allocator<char_type>    allocator_type;
+};
+
+// reader for major version 1
+class event_reader_v1 : public accio::block_reader<io_config> {
+public:
+  event_reader_v1() : accio::block_reader<io_config>("event", 1) {}
+  accio::error_codes::code_type read(buffer_type &inbuf, const accio::io::block_summary &, event &evt) const {
+    inbuf.read_data(evt.m_event);
+    evt.m_version = 1;
+    return accio::error_codes::block::success;
+  }
+};
+
+// reader for major version 2: also read the run number
+class event_reader_v2 : public accio::block_reader<io_config> {
+public:
+  event_reader_v2() : accio::block_reader<io_config>("event", 2) {}
+  accio::error_codes::code_type read(buffer_type &inbuf, const accio::io::block_summary &, event &evt) const {
+    inbuf.read_data(evt.m_event);
+    inbuf.read_data(evt.m_run);
+    evt.m_version = 2;
+    return accio::error_codes::block::success;
+  }
+};
+
+int main() {
+
+  accio::unit_test test("accio_reader_test");
+
+  accio::block_reader_registry<io_config> registry;
+  test.test("add reader v1", accio::error_codes::block::success == registry.add(std::make_shared<event_reader_v1>()));
+  test.test("add reader v2", accio::error_codes::block::success == registry.add(std::make_shared<event_reader_v2>()));
+  test.test("duplicate reader", accio::error_codes::block::dup_reader == registry.add(std::make_shared<event_reader_v2>()));
+  test.test("registry size", 2 == registry.size());
+
+  auto reader = registry.find("event", accio::version::encode(2, 3));
+  test.test("find reader by major version", (nullptr != reader) and (2 == reader->major_version()));
+  test.test("unknown version", nullptr == registry.find("event", accio::version::encode(3, 0)));
+  test.test("unknown type", nullptr == registry.find("hits", accio::version::encode(1, 0)));
+
+  // a record with an unknown block followed by an event block v2
+  accio::buffer<unsigned char> wbuf(1024);
+  int unknown[3] = {1, 2, 3};
+  accio::io::record_summary summary(2);
+  summary[0].m_type = "unknown";
+  summary[0].m_version = accio::version::encode(1, 0);
+  summary[0].m_size = wbuf.write_data(unknown[0], 3);
+  summary[1].m_type = "event";
+  summary[1].m_version = accio::version::encode(2, 1);
+  summary[1].m_size = wbuf.write_data(42) + wbuf.write_data(7);
+
+  accio::buffer<unsigned char> rbuf(wbuf.begin(), wbuf.tell(), true);
+  event evt;
+  test.test("read blocks", accio::error_codes::record::success == registry.read_blocks(rbuf, summary, evt));
+  test.test("dispatched to v2 reader", 2 == evt.m_version);
+  test.test("event number", 42 == evt.m_event);
+  test.test("run number", 7 == evt.m_run);
+  test.test("buffer fully read", 0 == rbuf.remaining());
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
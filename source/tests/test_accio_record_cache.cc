@@ -0,0 +1,179 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/writer.h>
+#include <accio/record_cache.h>
+
+// -- test fixtures
+#include <common.h>
+
+typedef fixture::io_config<std::vector<int>>            io_config;
+typedef fixture::vector_record<io_config>               value_record;
+
+std::vector<int> make_values(unsigned int index) {
+  std::vector<int> values(100 + index % 50);
+  for(std::size_t i = 0 ; i < values.size() ; i++) {
+    values[i] = static_cast<int>(index*1000 + i);
+  }
+  return values;
+}
+
+// a decoded record, as cached by an event display
+struct decoded {
+  std::vector<int>     m_values{};
+  inline std::size_t memory() const noexcept {
+    return sizeof(*this) + m_values.capacity()*sizeof(int);
+  }
+};
+
+accio::io::record_position position(long offset) {
+  accio::io::record_position pos;
+  pos.m_offset = offset;
+  return pos;
+}
+
+int main() {
+
+  accio::unit_test test("accio_record_cache_test");
+
+  // LRU eviction under the budget
+  {
+    typedef accio::record_cache<decoded> cache_type;
+    cache_type cache(1000);
+    auto make = [](std::size_t n) { auto d = std::make_shared<decoded>(); d->m_values.resize(n); return cache_type::value_ptr(d); };
+    test.test("empty cache", nullptr == cache.find(position(0)));
+    cache.insert(position(0), make(1), 400);
+    cache.insert(position(1), make(2), 400);
+    test.test("find record", (nullptr != cache.find(position(0))) and (1 == cache.find(position(0))->m_values.size()));
+    // record 1 is the least recently used
+    cache.insert(position(2), make(3), 400);
+    test.test("evict lru", (nullptr == cache.find(position(1))) and (nullptr != cache.find(position(0))) and (nullptr != cache.find(position(2))));
+    auto stats = cache.statistics();
+    test.test("statistics", (4 == stats.m_hits) and (2 == stats.m_misses) and (1 == stats.m_evictions) and (2 == stats.m_records) and (800 == stats.m_memory));
+    test.test("too big not cached", (nullptr != cache.insert(position(3), make(4), 2000)) and (nullptr == cache.find(position(3))));
+    auto kept = cache.insert(position(0), make(5), 400);
+    test.test("keep cached value", 1 == kept->m_values.size());
+    accio::io::record_position grouped = position(0);
+    grouped.m_group_offset = 0;
+    test.test("group offset in key", nullptr == cache.find(grouped));
+    cache.set_budget(500);
+    stats = cache.statistics();
+    test.test("smaller budget", (1 == stats.m_records) and (400 == stats.m_memory) and (500 == cache.budget()));
+    unsigned int nloads = 0;
+    auto loaded = cache.get(position(7), [&]() { nloads++; return make(7); });
+    loaded = cache.get(position(7), [&]() { nloads++; return make(7); });
+    test.test("get loads once", (1 == nloads) and (7 == loaded->m_values.size()));
+    test.test("failed load", nullptr == cache.get(position(8), []() { return cache_type::value_ptr(); }));
+    cache.reset_statistics();
+    cache.clear();
+    stats = cache.statistics();
+    test.test("clear", (0 == stats.m_hits) and (0 == stats.m_records) and (0 == stats.m_memory));
+  }
+
+  // uncompressed records read through the cache
+  const std::string fname = "test_accio_record_cache.accio";
+  const unsigned int nrecords = 500;
+  {
+    accio::file_writer<io_config> writer;
+    writer.set_checksum(true);
+    writer.set_compression(6);
+    writer.set_grouping(16*1024);
+    value_record record("values");
+    writer.open(fname);
+    for(unsigned int i = 0 ; i < nrecords ; i++) {
+      writer.write_record("values", record, make_values(i));
+    }
+    writer.close();
+  }
+  typedef accio::record_cache<accio::cached_record<unsigned char>> buffer_cache;
+  std::vector<accio::io::record_position> index;
+  {
+    accio::stream<unsigned char> stream;
+    stream.open(fname, accio::io::open_mode::read);
+    stream.build_index(index);
+    stream.close();
+  }
+  test.test("index", nrecords == index.size());
+  {
+    buffer_cache cache(64*1024);
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    accio::buffer<unsigned char> buffer(1024);
+    stream.open(fname, accio::io::open_mode::read);
+    bool read_ok = true;
+    for(unsigned int pass = 0 ; pass < 3 ; pass++) {
+      for(unsigned int r : {10, 400, 11, 250, 10}) {
+        std::vector<int> values;
+        read_ok = read_ok and (accio::error_codes::stream::success == accio::read_record(stream, cache, index[r], header, summary, buffer));
+        buffer.read_data(values);
+        read_ok = read_ok and (values == make_values(r)) and (1 == summary.size()) and (header.m_name == "values");
+      }
+    }
+    test.test("cached reads", read_ok);
+    auto stats = cache.statistics();
+    test.test("cached read statistics", (4 == stats.m_misses) and (11 == stats.m_hits) and (4 == stats.m_records));
+    accio::io::record_position bad = index[0];
+    bad.m_group_offset = 1 << 30;
+    test.test("bad position", accio::error_codes::stream::no_such_record == accio::read_record(stream, cache, bad, header, summary, buffer));
+    stream.close();
+  }
+
+  // a cache shared by reader threads, each with its own stream
+  {
+    buffer_cache cache(256*1024);
+    std::atomic<unsigned int> nerrors{0};
+    std::vector<std::thread> threads;
+    for(unsigned int t = 0 ; t < 4 ; t++) {
+      threads.emplace_back([&, t]() {
+        accio::stream<unsigned char> stream;
+        accio::io::record_header header;
+        accio::io::record_summary summary;
+        accio::buffer<unsigned char> buffer(1024);
+        stream.set_verify_mode(accio::io::verify_mode::async);
+        stream.open(fname, accio::io::open_mode::read);
+        unsigned int state = t + 1;
+        for(unsigned int i = 0 ; i < 2000 ; i++) {
+          state = state*1664525u + 1013904223u;
+          // a handful of records revisited
+          const unsigned int r = (state >> 16) % 40 * 12;
+          std::vector<int> values;
+          if(accio::error_codes::stream::success != accio::read_record(stream, cache, index[r], header, summary, buffer)) {
+            nerrors++;
+            continue;
+          }
+          buffer.read_data(values);
+          if(values != make_values(r)) {
+            nerrors++;
+          }
+        }
+        stream.close();
+      });
+    }
+    for(auto &thread : threads) {
+      thread.join();
+    }
+    auto stats = cache.statistics();
+    std::cout << "Shared cache: " << stats.m_hits << " hits, " << stats.m_misses << " misses, " << stats.m_records << " records, " << stats.m_memory << " bytes" << std::endl;
+    test.test("concurrent reads", 0 == nerrors);
+    test.test("concurrent statistics", (8000 == stats.m_hits + stats.m_misses) and (stats.m_hits > stats.m_misses) and (stats.m_memory <= 256*1024));
+  }
+  std::remove(fname.c_str());
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
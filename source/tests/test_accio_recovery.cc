@@ -0,0 +1,181 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <cstdio>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/writer.h>
+#include <accio/recovery.h>
+
+// -- test fixtures
+#include <common.h>
+
+typedef fixture::event<unsigned int>                    event;
+typedef fixture::io_config<event>                       io_config;
+typedef fixture::vector_record<io_config>               event_record;
+
+int main() {
+
+  accio::unit_test test("accio_recovery_test");
+
+  // marker search
+  std::vector<unsigned char> data(1000, 0);
+  test.test("no marker", data.size() == accio::record_scanner::find_marker(data.data(), data.size()));
+  for(std::size_t pos : {0, 4, 60, 64, 500, 996}) {
+    std::vector<unsigned char> copy(data);
+    std::memcpy(&copy[pos], &accio::io::marker::record, sizeof(accio::types::marker_type));
+    test.test("find marker", pos == accio::record_scanner::find_marker(copy.data(), copy.size()));
+  }
+  std::memcpy(&data[302], &accio::io::marker::record, sizeof(accio::types::marker_type));
+  test.test("skip unaligned marker", data.size() == accio::record_scanner::find_marker(data.data(), data.size()));
+
+  // write records. The payloads contain record markers
+  const std::string fname = "test_accio_recovery.accio";
+  const unsigned int nrecords = 20;
+  accio::file_writer<io_config> writer;
+  writer.set_checksum(true);
+  test.test("open writer", accio::error_codes::stream::success == writer.open(fname));
+  event_record evt_record("words");
+  event evt;
+  for(unsigned int i=0 ; i<nrecords ; i++) {
+    evt.m_data.assign(100 + 37*i, i);
+    evt.m_data[i] = accio::io::marker::record;
+    test.test("write record", accio::error_codes::stream::success == writer.write_record("event", evt_record, evt));
+  }
+  writer.close();
+
+  // scan the complete file, with small chunks
+  accio::record_scanner scanner(1024);
+  accio::scan_report report;
+  test.test("scan", accio::error_codes::stream::success == scanner.scan(fname, report));
+  test.test("all records found", nrecords == report.m_records.size());
+  test.test("file is valid", report.m_file_size == report.m_safe_size);
+  test.test("file header skipped", sizeof(accio::io::file_header) == report.m_header_size);
+  test.test("no corruption", 0 == report.m_corrupted_bytes and 0 == report.m_trailing_bytes);
+  const accio::record_index index = report.m_records;
+  test.test("record sizes", index[3].m_offset + index[3].m_size == index[4].m_offset);
+  test.test("record header", sizeof(unsigned int)*(100 + 37*3) + 4 == index[3].m_header.m_compsize);
+
+  // truncate the file in the middle of the last record
+  std::vector<unsigned char> content(report.m_file_size);
+  FILE *file = fopen(fname.c_str(), "rb");
+  test.test("read file", content.size() == fread(content.data(), 1, content.size(), file));
+  fclose(file);
+  const std::vector<unsigned char> original(content);
+  const long truncated_size = index.back().m_offset + index.back().m_size / 2;
+  file = fopen(fname.c_str(), "wb");
+  fwrite(content.data(), 1, truncated_size, file);
+  fclose(file);
+  test.test("scan truncated", accio::error_codes::stream::success == scanner.scan(fname, report));
+  {
+    // the truncated record can't be skipped either
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    unsigned int nskipped = 0;
+    stream.open(fname, accio::io::open_mode::read);
+    while(accio::error_codes::stream::success == stream.skip_record()) {
+      nskipped++;
+    }
+    test.test("skip truncated", nrecords - 1 == nskipped);
+    stream.close();
+    stream.open(fname, accio::io::open_mode::read);
+    unsigned int nheaders = 0;
+    auto status = accio::error_codes::stream::success;
+    while(accio::error_codes::stream::success == (status = stream.next_header(header))) {
+      nheaders++;
+    }
+    test.test("headers truncated", (nrecords - 1 == nheaders) and (accio::error_codes::stream::off_end == status));
+    stream.close();
+  }
+  test.test("partial record dropped", nrecords - 1 == report.m_records.size());
+  test.test("safe size", index.back().m_offset == report.m_safe_size);
+  test.test("trailing bytes", truncated_size - index.back().m_offset == report.m_trailing_bytes);
+
+  // break the header of a record in the middle of the file
+  content[index[5].m_offset] = 0;
+  file = fopen(fname.c_str(), "wb");
+  fwrite(content.data(), 1, content.size(), file);
+  fclose(file);
+  test.test("scan corrupted", accio::error_codes::stream::success == scanner.scan(fname, report));
+  test.test("broken record dropped", nrecords - 1 == report.m_records.size());
+  test.test("records after corruption found", index[6].m_offset == report.m_records[5].m_offset);
+  test.test("safe size before corruption", index[5].m_offset == report.m_safe_size);
+  test.test("corrupted bytes", index[5].m_size == report.m_corrupted_bytes);
+
+  // inconsistent summary: block size doesn't match the record size
+  content[index[5].m_offset] = static_cast<unsigned char>(accio::io::marker::record & 0xff);
+  const std::size_t size_offset = index[2].m_offset + sizeof(accio::io::disk_record_header) + sizeof(accio::types::size_type) + offsetof(accio::io::disk_block_summary, m_size);
+  content[size_offset] ^= 0x10;
+  file = fopen(fname.c_str(), "wb");
+  fwrite(content.data(), 1, content.size(), file);
+  fclose(file);
+  test.test("scan inconsistent", accio::error_codes::stream::success == scanner.scan(fname, report));
+  test.test("inconsistent record dropped", nrecords - 1 == report.m_records.size());
+  test.test("safe size before inconsistency", index[2].m_offset == report.m_safe_size);
+
+  // the stream doesn't allocate memory for sizes beyond the end of the file
+  auto read_corrupted = [&](std::size_t offset, const void *word, std::size_t len) {
+    content = original;
+    std::memcpy(&content[offset], word, len);
+    file = fopen(fname.c_str(), "wb");
+    fwrite(content.data(), 1, content.size(), file);
+    fclose(file);
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    accio::buffer<unsigned char> buffer(1024);
+    stream.open(fname, accio::io::open_mode::read);
+    for(unsigned int i=0 ; i<3 ; i++) {
+      stream.read_record(header, summary, buffer);
+    }
+    auto status = stream.read_record(header, summary, buffer);
+    stream.close();
+    return status;
+  };
+  const accio::types::size_type huge_count = 0x7fffffff;
+  test.test("corrupted block count", accio::error_codes::stream::off_end ==
+    read_corrupted(index[3].m_offset + sizeof(accio::io::disk_record_header), &huge_count, sizeof(huge_count)));
+  const accio::types::size_type huge_size = 0x7ffffff0;
+  test.test("corrupted payload size", accio::error_codes::stream::off_end ==
+    read_corrupted(index[3].m_offset + offsetof(accio::io::disk_record_header, m_compsize), &huge_size, sizeof(huge_size)));
+
+  // a corrupted uncompressed size is not allocated
+  {
+    accio::file_writer<io_config> cwriter;
+    cwriter.set_compression(6);
+    cwriter.open(fname);
+    for(unsigned int i=0 ; i<3 ; i++) {
+      evt.m_data.assign(1000, i);
+      cwriter.write_record("event", evt_record, evt);
+    }
+    cwriter.close();
+    scanner.scan(fname, report);
+    file = fopen(fname.c_str(), "r+b");
+    fseek(file, static_cast<long>(report.m_records[1].m_offset + offsetof(accio::io::disk_record_header, m_uncompsize)), SEEK_SET);
+    fwrite(&huge_size, sizeof(huge_size), 1, file);
+    fclose(file);
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    accio::buffer<unsigned char> buffer(1024);
+    stream.open(fname, accio::io::open_mode::read);
+    test.test("read compressed", accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+    test.test("corrupted uncompressed size", accio::error_codes::stream::bad_compress == stream.read_record(header, summary, buffer));
+    stream.close();
+  }
+  std::remove(fname.c_str());
+
+  test.test("missing file", accio::error_codes::stream::not_found == scanner.scan(fname, report));
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
@@ -0,0 +1,179 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <cstdio>
+#include <cstring>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/concurrent_writer.h>
+
+struct event {
+  int                   m_event{0};
+  std::vector<float>    m_energies{};
+};
+
+struct io_config {
+  typedef event                        record_type;
+  typedef unsigned char                char_type;
+  typedef accio::copy::standard        copy_type;
+  typedef std::allocator<char_type>    allocator_type;
+};
+
+// static blocks
+struct info_block {
+  static const char *type() { return "info"; }
+  static const char *name() { return "event_info"; }
+  static constexpr accio::types::version_type version() { return accio::version::encode(1, 2); }
+  template <typename buffer_type>
+  static accio::error_codes::code_type write(buffer_type &outbuf, const event &evt) {
+    outbuf.write_data(evt.m_event);
+    return accio::error_codes::block::success;
+  }
+};
+
+struct energies_block {
+  static const char *type() { return "energies"; }
+  static const char *name() { return "energies"; }
+  static constexpr accio::types::version_type version() { return accio::version::encode(2, 0); }
+  template <typename buffer_type>
+  static accio::error_codes::code_type write(buffer_type &outbuf, const event &evt) {
+    outbuf.write_data(evt.m_energies);
+    return accio::error_codes::block::success;
+  }
+};
+
+struct shuffled_block : public energies_block {
+  static accio::types::option_word filter() { return accio::io::filter::encode(accio::io::filter::byte_shuffle, sizeof(float)); }
+};
+
+struct failing_block {
+  static const char *type() { return "failing"; }
+  static const char *name() { return "failing"; }
+  static constexpr accio::types::version_type version() { return accio::version::encode(1, 0); }
+  template <typename buffer_type>
+  static accio::error_codes::code_type write(buffer_type &outbuf, const event &) {
+    outbuf.write_data(42);
+    return accio::error_codes::block::not_found;
+  }
+};
+
+// the same layout with block writers
+class info_writer : public accio::block_writer<io_config> {
+public:
+  info_writer(const event &evt) :
+    accio::block_writer<io_config>("info", "event_info", accio::version::encode(1, 2)),
+    m_event(evt) {}
+  accio::error_codes::code_type write(buffer_type &outbuf) const {
+    return info_block::write(outbuf, m_event);
+  }
+private:
+  const event     &m_event;
+};
+
+class energies_writer : public accio::block_writer<io_config> {
+public:
+  energies_writer(const event &evt) :
+    accio::block_writer<io_config>("energies", "energies", accio::version::encode(2, 0)),
+    m_event(evt) {}
+  accio::error_codes::code_type write(buffer_type &outbuf) const {
+    return energies_block::write(outbuf, m_event);
+  }
+private:
+  const event     &m_event;
+};
+
+class event_record : public accio::record_io<io_config> {
+public:
+  accio::error_codes::code_type create_writers(const event& record, block_writers &blocks) const {
+    blocks.push_back(std::make_shared<info_writer>(record));
+    blocks.push_back(std::make_shared<energies_writer>(record));
+    return accio::error_codes::record::success;
+  }
+};
+
+int main() {
+
+  accio::unit_test test("accio_schema_test");
+
+  accio::record_schema<io_config, info_block, energies_block> schema;
+  test.test("schema size", 2 == schema.nblocks);
+  test.test("schema summary", (2 == schema.summary().size()) and (schema.summary()[1].m_type == "energies"));
+  test.test("schema block version", accio::version::encode(1, 2) == schema.summary()[0].m_version);
+
+  // same serialization with the static and the virtual paths
+  event evt;
+  evt.m_event = 12;
+  evt.m_energies = {1.f, 2.f, 3.5f};
+  accio::file_writer<io_config> writer;
+  accio::io::record_header static_header, dynamic_header;
+  accio::io::record_summary static_summary, dynamic_summary;
+  accio::file_writer<io_config>::buffer_type static_buffer(1024), dynamic_buffer(1024);
+  test.test("serialize static", accio::error_codes::record::success == writer.serialize_record("event", schema, evt, static_header, static_summary, static_buffer));
+  test.test("serialize dynamic", accio::error_codes::record::success == writer.serialize_record("event", event_record(), evt, dynamic_header, dynamic_summary, dynamic_buffer));
+  test.test("same record size", (static_header.m_uncompsize == dynamic_header.m_uncompsize) and (static_header.m_compsize == dynamic_header.m_compsize));
+  test.test("same payload", 0 == std::memcmp(static_buffer.begin(), dynamic_buffer.begin(), static_buffer.tell()));
+  bool same_summary = (static_summary.size() == dynamic_summary.size());
+  for(std::size_t b = 0 ; same_summary and (b < static_summary.size()) ; b++) {
+    same_summary = (static_summary[b].m_size == dynamic_summary[b].m_size) and
+      (static_summary[b].m_type == dynamic_summary[b].m_type) and
+      (static_summary[b].m_name == dynamic_summary[b].m_name) and
+      (static_summary[b].m_version == dynamic_summary[b].m_version);
+  }
+  test.test("same summary", same_summary);
+  test.test("no block filter", accio::io::filter::none == static_summary[1].m_filter);
+
+  // the block filter of a schema block type
+  accio::record_schema<io_config, info_block, shuffled_block> shuffled_schema;
+  const auto byte_filter = accio::io::filter::encode(accio::io::filter::byte_shuffle, sizeof(float));
+  test.test("schema block filter", (accio::io::filter::none == shuffled_schema.summary()[0].m_filter) and (byte_filter == shuffled_schema.summary()[1].m_filter));
+  writer.serialize_record("event", shuffled_schema, evt, static_header, static_summary, static_buffer);
+  test.test("serialized block filter", (2 == static_summary.size()) and (byte_filter == static_summary[1].m_filter));
+
+  // failing blocks are skipped
+  accio::record_schema<io_config, info_block, failing_block, energies_block> failing_schema;
+  writer.serialize_record("event", failing_schema, evt, static_header, static_summary, static_buffer);
+  test.test("failing block skipped", (2 == static_summary.size()) and (static_summary[1].m_type == "energies"));
+  test.test("failing block rewinded", static_header.m_uncompsize == dynamic_header.m_uncompsize);
+
+  // write and read back
+  const std::string fname = "test_accio_schema.accio";
+  test.test("write not open", accio::error_codes::stream::not_open == writer.write_record("event", schema, evt));
+  test.test("open writer", accio::error_codes::stream::success == writer.open(fname));
+  for(int i=0 ; i<5 ; i++) {
+    evt.m_event = i;
+    test.test("write record", accio::error_codes::stream::success == writer.write_record("event", schema, evt));
+  }
+  writer.close();
+  accio::concurrent_writer<io_config> cwriter;
+  test.test("open concurrent writer", accio::error_codes::stream::success == cwriter.open(fname + ".c"));
+  test.test("concurrent write", accio::error_codes::stream::success == cwriter.write_record("event", schema, evt));
+  test.test("close concurrent writer", accio::error_codes::stream::success == cwriter.close());
+  std::remove((fname + ".c").c_str());
+
+  accio::stream<unsigned char> stream;
+  accio::buffer<unsigned char> buffer(1024);
+  stream.open(fname, accio::io::open_mode::read);
+  int nread = 0;
+  while(accio::error_codes::stream::success == stream.read_record(static_header, static_summary, buffer)) {
+    event read_evt;
+    buffer.read_data(read_evt.m_event);
+    buffer.read_data(read_evt.m_energies);
+    test.test("read event", (nread == read_evt.m_event) and (evt.m_energies == read_evt.m_energies));
+    nread++;
+  }
+  test.test("read all records", 5 == nread);
+  stream.close();
+  std::remove(fname.c_str());
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
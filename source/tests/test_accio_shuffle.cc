@@ -0,0 +1,215 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <cmath>
+#include <cstdio>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/writer.h>
+#include <accio/recovery.h>
+
+struct event {
+  std::vector<float>    m_energies{};
+  std::vector<int>      m_counts{};
+};
+
+struct io_config {
+  typedef event                        record_type;
+  typedef unsigned char                char_type;
+  typedef accio::copy::standard        copy_type;
+  typedef std::allocator<char_type>    allocator_type;
+};
+
+class energy_writer : public accio::block_writer<io_config> {
+public:
+  energy_writer(const event &evt, accio::types::option_word filter) :
+    accio::block_writer<io_config>("energies", "energies", 1, filter),
+    m_event(evt) {}
+  accio::error_codes::code_type write(buffer_type &outbuf) const {
+    outbuf.write_data(m_event.m_energies);
+    return accio::error_codes::block::success;
+  }
+private:
+  const event     &m_event;
+};
+
+class count_writer : public accio::block_writer<io_config> {
+public:
+  count_writer(const event &evt) :
+    accio::block_writer<io_config>("counts", "counts", 1),
+    m_event(evt) {}
+  accio::error_codes::code_type write(buffer_type &outbuf) const {
+    outbuf.write_data(m_event.m_counts);
+    return accio::error_codes::block::success;
+  }
+private:
+  const event     &m_event;
+};
+
+class event_record : public accio::record_io<io_config> {
+public:
+  event_record(accio::types::option_word filter) : m_filter(filter) {}
+  accio::error_codes::code_type create_writers(const event& record, block_writers &blocks) const {
+    blocks.push_back(std::make_shared<energy_writer>(record, m_filter));
+    blocks.push_back(std::make_shared<count_writer>(record));
+    return accio::error_codes::record::success;
+  }
+private:
+  accio::types::option_word    m_filter;
+};
+
+std::vector<unsigned char> make_bytes(std::size_t size, unsigned int seed) {
+  std::vector<unsigned char> bytes(size);
+  for(auto &byte : bytes) {
+    seed = seed*1664525u + 1013904223u;
+    byte = static_cast<unsigned char>(seed >> 24);
+  }
+  return bytes;
+}
+
+int main() {
+
+  accio::unit_test test("accio_shuffle_test");
+
+  // the kernels against the layout definition, on all the tail lengths
+  bool byte_layout = true, bit_layout = true, byte_inverse = true, bit_inverse = true;
+  for(std::size_t element : {1, 2, 3, 4, 8, 12}) {
+    for(std::size_t size : {1, 7, 31, 127, 128, 129, 255, 256, 1000, 4099, 10007}) {
+      auto input = make_bytes(size, static_cast<unsigned int>(element*size));
+      std::vector<unsigned char> output(size), back(size);
+      accio::shuffle::byte_shuffle(input.data(), size, element, output.data());
+      const std::size_t n = size / element;
+      for(std::size_t i = 0 ; i < size ; i++) {
+        const std::size_t expected = (i < n*element) ? (i % element)*n + i / element : i;
+        byte_layout = byte_layout and (output[expected] == input[i]);
+      }
+      accio::shuffle::byte_unshuffle(output.data(), size, element, back.data());
+      byte_inverse = byte_inverse and (back == input);
+      accio::shuffle::bit_shuffle(input.data(), size, element, output.data());
+      const std::size_t ngroups = size / (8*element);
+      for(std::size_t i = 0 ; i < 8*ngroups ; i++) {
+        for(std::size_t b = 0 ; b < element ; b++) {
+          for(std::size_t j = 0 ; j < 8 ; j++) {
+            const bool bit = (0 != (input[i*element + b] & (1 << j)));
+            bit_layout = bit_layout and (bit == (0 != (output[(8*b + j)*ngroups + i/8] & (1 << (i%8)))));
+          }
+        }
+      }
+      for(std::size_t i = 8*ngroups*element ; i < size ; i++) {
+        bit_layout = bit_layout and (output[i] == input[i]);
+      }
+      accio::shuffle::bit_unshuffle(output.data(), size, element, back.data());
+      bit_inverse = bit_inverse and (back == input);
+    }
+  }
+  test.test("byte shuffle layout", byte_layout);
+  test.test("byte unshuffle", byte_inverse);
+  test.test("bit shuffle layout", bit_layout);
+  test.test("bit unshuffle", bit_inverse);
+  std::cout << "AVX2 kernels: " << (accio::shuffle::avx2_available() ? "yes" : "no") << std::endl;
+
+  // filter words
+  const auto byte_filter = accio::io::filter::encode(accio::io::filter::byte_shuffle, sizeof(float));
+  const auto bit_filter = accio::io::filter::encode(accio::io::filter::bit_shuffle, sizeof(float));
+  test.test("filter type", accio::io::filter::bit_shuffle == accio::io::filter::type(bit_filter));
+  test.test("filter element", sizeof(float) == accio::io::filter::element(bit_filter));
+  std::vector<unsigned char> filtered(16);
+  test.test("unknown filter", not accio::shuffle::encode(0x7f, filtered.data(), 16, filtered.data()));
+
+  // compressed records, the energies being filtered
+  event evt;
+  for(int i = 0 ; i < 2000 ; i++) {
+    evt.m_energies.push_back(100.f + 10.f * std::sin(0.01f * i));
+    evt.m_counts.push_back(i / 7);
+  }
+  const std::string fname = "test_accio_shuffle.accio";
+  std::size_t file_sizes[3] = {0, 0, 0};
+  const accio::types::option_word filters[3] = {accio::io::filter::none, byte_filter, bit_filter};
+  for(std::size_t f = 0 ; f < 3 ; f++) {
+    accio::file_writer<io_config> writer;
+    writer.set_checksum(true);
+    writer.set_compression(6);
+    test.test("compression level", 6 == writer.compression());
+    test.test("open writer", accio::error_codes::stream::success == writer.open(fname));
+    event_record evt_record(filters[f]);
+    for(int i = 0 ; i < 3 ; i++) {
+      test.test("write record", accio::error_codes::stream::success == writer.write_record("event", evt_record, evt));
+    }
+    // not compressible: stored as is
+    event noise;
+    auto bytes = make_bytes(4*1000, 42);
+    noise.m_counts.assign(reinterpret_cast<const int*>(bytes.data()), reinterpret_cast<const int*>(bytes.data()) + 1000);
+    test.test("write noise", accio::error_codes::stream::success == writer.write_record("noise", evt_record, noise));
+    writer.close();
+
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    accio::buffer<unsigned char> buffer(1024);
+    stream.set_verify_mode((1 == f) ? accio::io::verify_mode::async : accio::io::verify_mode::sync);
+    test.test("open reader", accio::error_codes::stream::success == stream.open(fname, accio::io::open_mode::read));
+    test.test("compression feature", 0 != (stream.file_header().m_features & accio::io::feature::compression));
+    test.test("filters feature", (accio::io::filter::none != filters[f]) == (0 != (stream.file_header().m_features & accio::io::feature::filters)));
+    for(int i = 0 ; i < 3 ; i++) {
+      test.test("read record", accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+      test.test("compressed record", (6 == (header.m_options & accio::io::option::compression)) and (header.m_compsize < header.m_uncompsize));
+      test.test("record filters", (filters[f] == summary[0].m_filter) and (accio::io::filter::none == summary[1].m_filter));
+      event read_evt;
+      buffer.read_data(read_evt.m_energies);
+      buffer.read_data(read_evt.m_counts);
+      test.test("read energies", evt.m_energies == read_evt.m_energies);
+      test.test("read counts", evt.m_counts == read_evt.m_counts);
+    }
+    test.test("read noise", accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+    test.test("noise stored uncompressed", (0 == (header.m_options & (accio::io::option::compression | accio::io::option::filters))) and
+      (header.m_compsize == header.m_uncompsize) and (accio::io::filter::none == summary[0].m_filter));
+    test.test("noise checksum", accio::error_codes::stream::success == stream.wait_checksum());
+    stream.close();
+
+    // the scanner follows the compressed records
+    accio::record_scanner scanner(1024);
+    accio::scan_report report;
+    test.test("scan", accio::error_codes::stream::success == scanner.scan(fname, report));
+    test.test("scan all records", (4 == report.m_records.size()) and (report.m_file_size == report.m_safe_size));
+    file_sizes[f] = report.m_file_size;
+    std::remove(fname.c_str());
+  }
+  std::cout << "File sizes (none, byte shuffle, bit shuffle): " << file_sizes[0] << ", " << file_sizes[1] << ", " << file_sizes[2] << std::endl;
+  test.test("byte shuffle compresses better", file_sizes[1] < file_sizes[0]);
+  test.test("bit shuffle compresses better", file_sizes[2] < file_sizes[0]);
+
+  // a corrupted compressed payload is detected
+  {
+    accio::file_writer<io_config> writer;
+    writer.set_compression(1);
+    event_record evt_record(bit_filter);
+    writer.open(fname);
+    writer.write_record("event", evt_record, evt);
+    writer.close();
+    FILE *file = fopen(fname.c_str(), "r+b");
+    fseek(file, -16, SEEK_END);
+    const unsigned char garbage[8] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+    fwrite(garbage, 1, sizeof(garbage), file);
+    fclose(file);
+    accio::stream<unsigned char> stream;
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    accio::buffer<unsigned char> buffer(1024);
+    stream.open(fname, accio::io::open_mode::read);
+    test.test("corrupted payload", accio::error_codes::stream::bad_compress == stream.read_record(header, summary, buffer));
+    stream.close();
+    std::remove(fname.c_str());
+  }
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
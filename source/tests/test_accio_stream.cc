@@ -0,0 +1,250 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <cstdio>
+#include <cstring>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/writer.h>
+#include <accio/recovery.h>
+
+// -- test fixtures
+#include <common.h>
+
+typedef fixture::event<int>                             event;
+typedef fixture::io_config<event>                       io_config;
+typedef fixture::vector_record<io_config>               event_record;
+
+int main() {
+
+  accio::unit_test test("accio_stream_test");
+
+  // a run header every 10 events. Odd sizes to exercise the padding
+  const std::string fname = "test_accio_stream.accio";
+  accio::file_writer<io_config> writer;
+  writer.set_checksum(true);
+  test.test("open writer", accio::error_codes::stream::success == writer.open(fname));
+  event_record evt_record("data", 2);
+  event evt;
+  unsigned int nrecords = 0;
+  for(int run=0 ; run<3 ; run++) {
+    evt.m_data.assign(1, run);
+    test.test("write run", accio::error_codes::stream::success == writer.write_record("run", evt_record, evt));
+    nrecords++;
+    for(int i=0 ; i<10 ; i++) {
+      evt.m_data.assign(3*i + 1, i);
+      test.test("write event", accio::error_codes::stream::success == writer.write_record("event", evt_record, evt));
+      nrecords++;
+    }
+  }
+  writer.close();
+
+  accio::stream<unsigned char> stream;
+  accio::io::record_header header;
+  accio::io::record_summary summary;
+  accio::buffer<unsigned char> buffer(1024);
+
+  // count the records, reading headers only
+  test.test("open", accio::error_codes::stream::success == stream.open(fname, accio::io::open_mode::read));
+  unsigned int count = 0, nruns = 0;
+  accio::error_codes::code_type status;
+  while(accio::error_codes::stream::success == (status = stream.next_header(header))) {
+    count++;
+    nruns += (header.m_name == "run") ? 1 : 0;
+  }
+  test.test("eof", accio::error_codes::stream::eof == status);
+  test.test("count records", nrecords == count);
+  test.test("count runs", 3 == nruns);
+  stream.close();
+
+  // list with summaries, skip, then read
+  stream.open(fname, accio::io::open_mode::read);
+  test.test("next header with summary", accio::error_codes::stream::success == stream.next_header(header, &summary));
+  test.test("summary read", 2 == summary.size() and summary[0].m_type == "data");
+  test.test("skip record", accio::error_codes::stream::success == stream.skip_record());
+  test.test("read record", accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+  event read_evt;
+  buffer.read_data(read_evt.m_data);
+  test.test("read after skip", (header.m_name == "event") and (4 == read_evt.m_data.size()) and (1 == read_evt.m_data[0]));
+  stream.close();
+
+  // pull the run headers only
+  stream.open(fname, accio::io::open_mode::read);
+  int run = 0;
+  while(accio::error_codes::stream::success == (status = stream.find_record("run", header, summary, buffer))) {
+    buffer.read_data(read_evt.m_data);
+    test.test("find run", (1 == read_evt.m_data.size()) and (run == read_evt.m_data[0]));
+    run++;
+  }
+  test.test("find all runs", (3 == run) and (accio::error_codes::stream::eof == status));
+  stream.close();
+  std::remove(fname.c_str());
+
+  // 64 bit sizes layout, forced on a small record between two 32 bit ones
+  test.test("open write", accio::error_codes::stream::success == stream.open(fname, accio::io::open_mode::write_new));
+  accio::buffer<unsigned char> outbuf(1024);
+  outbuf.write_data(std::vector<int>(10, 7));
+  summary.assign(2, accio::io::block_summary());
+  summary[0].m_type = "data";
+  summary[0].m_size = outbuf.tell() - 8;
+  summary[1].m_type = "more";
+  summary[1].m_size = 8;
+  header.m_marker = accio::io::marker::record;
+  header.m_compsize = header.m_uncompsize = outbuf.tell();
+  header.m_name = "event";
+  std::size_t file_size = sizeof(accio::io::file_header);
+  for(auto options : {accio::io::option::checksum, accio::io::option::checksum | accio::io::option::size64, accio::types::option_word(0)}) {
+    header.m_options = options;
+    test.test("write record", accio::error_codes::stream::success == stream.write_record(header, summary, outbuf));
+    file_size += accio::io::record_size(header, summary.size());
+  }
+  stream.close();
+  struct stat st;
+  accio::io::file::stat(fname.c_str(), &st);
+  test.test("file size", file_size == static_cast<std::size_t>(st.st_size));
+  test.test("64 bit layout size", accio::io::header_size(header) + 16 == accio::io::header_size(accio::io::record_header{accio::io::marker::record, accio::io::option::size64, 0, 0, "event"}));
+
+  stream.open(fname, accio::io::open_mode::read);
+  test.test("read 32 bit record", accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+  test.test("read 64 bit record", accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+  test.test("64 bit option", 0 != (header.m_options & accio::io::option::size64));
+  test.test("64 bit sizes", (44 == header.m_compsize) and (2 == summary.size()) and (36 == summary[0].m_size) and (8 == summary[1].m_size));
+  buffer.read_data(read_evt.m_data);
+  test.test("64 bit record payload", (10 == read_evt.m_data.size()) and (7 == read_evt.m_data[9]));
+  test.test("read last record", accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+  stream.close();
+  stream.open(fname, accio::io::open_mode::read);
+  count = 0;
+  while(accio::error_codes::stream::success == stream.next_header(header)) {
+    count++;
+  }
+  test.test("skip 64 bit record", 3 == count);
+  test.test("file header", (accio::io::marker::file == stream.file_header().m_marker) and (accio::io::format_version == stream.file_header().m_version));
+  test.test("file features", (accio::io::feature::checksum | accio::io::feature::size64) == stream.file_header().m_features);
+  stream.close();
+  FILE *file = nullptr;
+  accio::record_scanner scanner;
+  accio::scan_report report;
+  scanner.scan(fname, report);
+  test.test("scan 64 bit record", (3 == report.m_records.size()) and (report.m_file_size == report.m_safe_size));
+  std::remove(fname.c_str());
+
+  // file header: features of the appended records
+  header.m_options = 0;
+  stream.open(fname, accio::io::open_mode::write_new);
+  stream.write_record(header, summary, outbuf);
+  stream.close();
+  stream.open(fname, accio::io::open_mode::read);
+  test.test("no features", 0 == stream.file_header().m_features);
+  stream.close();
+  header.m_options = accio::io::option::checksum;
+  test.test("open append", accio::error_codes::stream::success == stream.open(fname, accio::io::open_mode::write_append));
+  stream.write_record(header, summary, outbuf);
+  stream.close();
+  stream.open(fname, accio::io::open_mode::read);
+  test.test("appended features", accio::io::feature::checksum == stream.file_header().m_features);
+  count = 0;
+  while(accio::error_codes::stream::success == stream.skip_record()) {
+    count++;
+  }
+  test.test("appended records", 2 == count);
+  stream.close();
+
+  // file written without header
+  std::vector<unsigned char> content(accio::io::record_size(header, summary.size()) + sizeof(accio::io::file_header));
+  file = accio::io::file::open(fname.c_str(), "rb");
+  accio::io::file::read(content.data(), 1, content.size(), file);
+  accio::io::file::close(file);
+  file = accio::io::file::open(fname.c_str(), "wb");
+  accio::io::file::write(content.data() + sizeof(accio::io::file_header), 1, content.size() - sizeof(accio::io::file_header), file);
+  accio::io::file::close(file);
+  test.test("open file without header", accio::error_codes::stream::success == stream.open(fname, accio::io::open_mode::read));
+  test.test("no file header", 0 == stream.file_header().m_version);
+  test.test("read file without header", accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+  stream.close();
+
+  // reader makes right: payloads written in big endian
+  std::vector<int> values = {1, -2, 0x01020304};
+  accio::buffer<unsigned char, accio::copy::big_endian> swapped_buffer(1024);
+  swapped_buffer.write_data(values);
+  accio::stream<unsigned char, accio::copy::big_endian> swapped_stream;
+  summary.assign(1, accio::io::block_summary());
+  summary[0].m_type = "data";
+  summary[0].m_size = swapped_buffer.tell();
+  header.m_options = accio::io::option::checksum;
+  header.m_compsize = header.m_uncompsize = swapped_buffer.tell();
+  test.test("open big endian", accio::error_codes::stream::success == swapped_stream.open(fname, accio::io::open_mode::write_new));
+  swapped_stream.write_record(header, summary, swapped_buffer);
+  swapped_stream.close();
+  test.test("open big endian file", accio::error_codes::stream::success == stream.open(fname, accio::io::open_mode::read));
+  test.test("read big endian record", accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+  test.test("swap big endian payload", accio::copy::big_endian::native != buffer.byte_swap());
+  buffer.read_data(read_evt.m_data);
+  test.test("big endian payload", values == read_evt.m_data);
+  stream.close();
+
+  // a file written in the opposite byte order: swap the header words
+  content.resize(sizeof(accio::io::file_header) + accio::io::record_size(header, 1));
+  file = accio::io::file::open(fname.c_str(), "rb");
+  accio::io::file::read(content.data(), 1, content.size(), file);
+  accio::io::file::close(file);
+  auto swap_word = [&](std::size_t offset) {
+    accio::types::size_type word;
+    std::memcpy(&word, &content[offset], sizeof(word));
+    word = accio::io::byte_swap(word);
+    std::memcpy(&content[offset], &word, sizeof(word));
+  };
+  for(std::size_t offset : {0, 4, 8, 12, 20}) {
+    swap_word(offset);
+  }
+  const std::size_t record_offset = sizeof(accio::io::file_header);
+  const std::size_t summary_offset = record_offset + sizeof(accio::io::disk_record_header);
+  for(std::size_t offset : {record_offset, record_offset + 4, record_offset + 8, record_offset + 12, summary_offset, summary_offset + 4, summary_offset + 8}) {
+    swap_word(offset);
+  }
+  // the checksum covers the bytes as written
+  accio::checksum::value_type crc = accio::checksum::crc32c(&content[summary_offset], content.size() - summary_offset - 4);
+  crc = accio::io::byte_swap(crc);
+  std::memcpy(&content[content.size() - 4], &crc, sizeof(crc));
+  file = accio::io::file::open(fname.c_str(), "wb");
+  accio::io::file::write(content.data(), 1, content.size(), file);
+  accio::io::file::close(file);
+  test.test("open swapped file", accio::error_codes::stream::success == stream.open(fname, accio::io::open_mode::read));
+  test.test("swapped file header", (accio::io::format_version == stream.file_header().m_version) and (accio::io::feature::checksum == stream.file_header().m_features));
+  test.test("read swapped record", accio::error_codes::stream::success == stream.read_record(header, summary, buffer));
+  test.test("swapped record header", (accio::io::option::checksum == header.m_options) and (16 == header.m_compsize) and (16 == summary[0].m_size));
+  buffer.read_data(read_evt.m_data);
+  test.test("swapped payload", values == read_evt.m_data);
+  test.test("swapped file end", accio::error_codes::stream::eof == stream.skip_record());
+  stream.close();
+  test.test("append byte order", accio::error_codes::stream::bad_byte_order == stream.open(fname, accio::io::open_mode::write_append));
+
+  // unsupported version
+  accio::io::file_header file_header = {accio::io::marker::file, accio::version::encode(2, 0), sizeof(accio::io::file_header), accio::io::marker::byte_order, accio::io::marker::byte_order, 0};
+  file = accio::io::file::open(fname.c_str(), "wb");
+  accio::io::file::write(&file_header, sizeof(file_header), 1, file);
+  accio::io::file::close(file);
+  test.test("unsupported version", accio::error_codes::stream::bad_header == stream.open(fname, accio::io::open_mode::read));
+  test.test("not opened", accio::io::open_state::closed == stream.open_state());
+  std::remove(fname.c_str());
+
+  // large file offsets
+  file = accio::io::file::open(fname.c_str(), "wb");
+  const accio::types::offset_type large_offset = 5LL*1024*1024*1024;
+  test.test("seek after 4 Go", 0 == accio::io::file::seek(file, large_offset, SEEK_SET));
+  test.test("tell after 4 Go", large_offset == accio::io::file::tell(file));
+  accio::io::file::close(file);
+  std::remove(fname.c_str());
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
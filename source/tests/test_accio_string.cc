@@ -37,6 +37,12 @@ int main() {
   test.test("char at 5 is t", str8.at(5) == 'a');
   test.test("char [5] is t", str8[5] == 'a');
 
+  constexpr accio::hash_type literal_hash = accio::string_hash("tototat");
+  test.test("hash of literal", literal_hash == str8.hash());
+  test.test("hash differs", accio::string_hash("tototet") != str8.hash());
+  test.test("string equality", str8 == accio::string8("tototat"));
+  test.test("string inequality", str8 != accio::string8("tototet"));
+
   try {
     auto c = str8.at(8);
     test.test("out of range", false);
@@ -0,0 +1,115 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <cstdio>
+
+// -- accio headers
+#include <accio/testing/unit_test.h>
+#include <accio/writer.h>
+
+// -- test fixtures
+#include <common.h>
+
+typedef fixture::event<int>                             event;
+typedef fixture::io_config<event>                       io_config;
+typedef fixture::vector_record<io_config>               event_record;
+
+// read back the records of a file: count and check the event numbers
+unsigned int read_file(const std::string &fname, std::vector<int> &numbers) {
+  accio::stream<unsigned char> stream;
+  accio::io::record_header header;
+  accio::io::record_summary summary;
+  accio::buffer<unsigned char> buffer(1024);
+  event evt;
+  unsigned int nrecords = 0;
+  stream.open(fname, accio::io::open_mode::read);
+  while(accio::error_codes::stream::success == stream.read_record(header, summary, buffer)) {
+    buffer.read_data(evt.m_data);
+    numbers.push_back(evt.m_data[0]);
+    nrecords++;
+  }
+  stream.close();
+  return nrecords;
+}
+
+int main() {
+
+  accio::unit_test test("accio_writer_test");
+
+  event_record evt_record;
+  event evt;
+  std::vector<int> numbers;
+
+  // patterns are required for rotation and shards
+  accio::file_writer<io_config> writer;
+  writer.set_rotation(0, 10);
+  test.test("rotation requires a pattern", accio::error_codes::stream::bad_pattern == writer.open("test_accio_writer.accio"));
+  test.test("shards require patterns", accio::error_codes::stream::bad_pattern == writer.open(std::vector<std::string>{"a_{}.accio", "b.accio"}));
+  test.test("not open", accio::error_codes::stream::not_open == writer.write_record("event", evt_record, evt));
+
+  // rotation by record count
+  test.test("open rotation", accio::error_codes::stream::success == writer.open("test_accio_writer_{}.accio"));
+  for(int i=0 ; i<25 ; i++) {
+    evt.m_data.assign(10, i);
+    test.test("write record", accio::error_codes::stream::success == writer.write_record("event", evt_record, evt));
+  }
+  test.test("close", accio::error_codes::stream::success == writer.close());
+  auto files = writer.files();
+  test.test("rotated files", 3 == files.size());
+  test.test("file name", "test_accio_writer_0002.accio" == files[2]);
+  test.test("first file", 10 == read_file(files[0], numbers));
+  test.test("last file", 5 == read_file(files[2], numbers));
+  test.test("record order", 0 == numbers[0] and 9 == numbers[9] and 20 == numbers[10]);
+  for(auto &fname : files) {
+    std::remove(fname.c_str());
+  }
+
+  // rotation by size
+  evt.m_data.assign(100, 0);
+  const std::size_t record_size = sizeof(accio::io::disk_record_header) + 4 + sizeof(accio::io::disk_block_summary) + 4 + 100*sizeof(int);
+  writer.set_rotation(sizeof(accio::io::file_header) + 3*record_size);
+  writer.open("test_accio_writer_{}.accio");
+  for(int i=0 ; i<7 ; i++) {
+    writer.write_record("event", evt_record, evt);
+  }
+  writer.close();
+  files = writer.files();
+  test.test("files by size", 3 == files.size());
+  struct stat st;
+  accio::io::file::stat(files[0].c_str(), &st);
+  test.test("file size", sizeof(accio::io::file_header) + 3*record_size == static_cast<std::size_t>(st.st_size));
+  for(auto &fname : files) {
+    std::remove(fname.c_str());
+  }
+
+  // round-robin across 3 shards, with rotation
+  writer.set_rotation(0, 4);
+  test.test("open shards", accio::error_codes::stream::success == writer.open(std::vector<std::string>{"test_accio_writer_a{}.accio", "test_accio_writer_b{}.accio", "test_accio_writer_c{}.accio"}));
+  for(int i=0 ; i<24 ; i++) {
+    evt.m_data.assign(10, i);
+    writer.write_record("event", evt_record, evt);
+  }
+  writer.close();
+  files = writer.files();
+  test.test("shard files", 6 == files.size());
+  numbers.clear();
+  test.test("shard a first file", 4 == read_file("test_accio_writer_a0000.accio", numbers));
+  test.test("round robin", 0 == numbers[0] and 3 == numbers[1] and 9 == numbers[3]);
+  numbers.clear();
+  test.test("shard c second file", 4 == read_file("test_accio_writer_c0001.accio", numbers));
+  test.test("round robin rotated", 14 == numbers[0] and 23 == numbers[3]);
+  for(auto &fname : files) {
+    std::remove(fname.c_str());
+  }
+
+  std::cout << "TEST_PASSED" << std::endl;
+  return 0;
+}
@@ -0,0 +1,273 @@
+//==========================================================================
+//  ACCIO: ACelerated and Compact IO library
+//--------------------------------------------------------------------------
+//
+// For the licensing terms see LICENSE file.
+// For the list of contributors see AUTHORS file.
+//
+// Author     : R.Ete
+//====================================================================
+
+// -- std headers
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// -- accio headers
+#include <accio/stream.h>
+
+namespace {
+
+  typedef accio::stream<unsigned char>     stream_type;
+
+  /// Size totals for a record name or a block type
+  struct size_totals {
+    std::size_t      m_count{0};
+    std::size_t      m_compsize{0};
+    std::size_t      m_uncompsize{0};
+  };
+
+  void usage() {
+    std::cout << "Usage: accio-inspect [options] file" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -s, --summary   print only the size totals per record name and block type" << std::endl;
+    std::cout << "  -b, --bench     read the file end to end and report the throughput per stage:" << std::endl;
+    std::cout << "                  stored headers, headers with the groups uncompressed, records" << std::endl;
+    std::cout << "                  uncompressed, records uncompressed with checksums verified" << std::endl;
+    std::cout << "  -h, --help      print this help" << std::endl;
+  }
+
+  std::string error_str(accio::error_codes::code_type code) {
+    std::ostringstream ss;
+    ss << "0x" << std::hex << code;
+    return ss.str();
+  }
+
+  double ratio(std::size_t uncompsize, std::size_t compsize) {
+    return (0 == compsize) ? 1. : static_cast<double>(uncompsize) / compsize;
+  }
+
+  /// Print the totals with their uncompressed sizes or, for
+  /// stored totals, with their sizes in the file
+  void print_totals(const std::string &title, const std::map<std::string, size_totals> &totals, std::size_t all_size, bool stored = false) {
+    std::cout << title << std::endl;
+    std::cout << "  " << std::left << std::setw(32) << "name" << std::right << std::setw(10) << "count"
+      << std::setw(16) << (stored ? "stored (o)" : "size (o)") << std::setw(10) << "fraction" << std::setw(10) << "ratio" << std::endl;
+    for(auto &total : totals) {
+      const std::size_t size = stored ? total.second.m_compsize : total.second.m_uncompsize;
+      std::cout << "  " << std::left << std::setw(32) << total.first << std::right
+        << std::setw(10) << total.second.m_count
+        << std::setw(16) << size
+        << std::setw(9) << std::fixed << std::setprecision(2) << 100. * size / std::max<std::size_t>(all_size, 1) << "%"
+        << std::setw(10) << ratio(total.second.m_uncompsize, total.second.m_compsize) << std::endl;
+    }
+  }
+
+  void print_header(const std::string &title, const accio::io::record_header &header, std::size_t compsize, const accio::io::record_summary &summary) {
+    std::cout << title << header.m_name.c_str() << std::endl;
+    std::cout << "  options: 0x" << std::hex << header.m_options << std::dec
+      << ", compressed size: " << compsize
+      << ", uncompressed size: " << header.m_uncompsize
+      << ", ratio: " << std::fixed << std::setprecision(2) << ratio(header.m_uncompsize, compsize)
+      << ", blocks: " << summary.size() << std::endl;
+    for(auto &block : summary) {
+      std::cout << "    block: type: " << block.m_type.c_str()
+        << ", name: " << block.m_name.c_str()
+        << ", version: " << accio::version::decode_major(block.m_version) << "." << accio::version::decode_minor(block.m_version)
+        << ", size: " << block.m_size << std::endl;
+    }
+  }
+
+  /// Dump the record headers and block summaries
+  int inspect(const std::string &fname, bool summary_only) {
+    stream_type stream;
+    auto open_status = stream.open(fname, accio::io::open_mode::read);
+    if(accio::error_codes::stream::success != open_status) {
+      std::cerr << "ERROR - Couldn't open file " << fname << ", error code " << error_str(open_status) << std::endl;
+      return 1;
+    }
+    auto &file_header = stream.file_header();
+    if(accio::io::marker::file == file_header.m_marker) {
+      std::cout << "File format: " << accio::version::decode_major(file_header.m_version) << "." << accio::version::decode_minor(file_header.m_version)
+        << ", features: 0x" << std::hex << file_header.m_features << std::dec << std::endl;
+    }
+    else {
+      std::cout << "File format: no file header" << std::endl;
+    }
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    // the records as stored: the group and dictionary records are listed,
+    // the records they hold are not
+    std::map<std::string, size_totals> stored_totals, record_totals, block_totals;
+    std::vector<accio::io::record_header> groups;
+    std::size_t nstored = 0, all_stored = 0;
+    accio::error_codes::code_type status;
+    while(accio::error_codes::stream::success == (status = stream.next_stored_header(header, &summary))) {
+      auto &stotal = stored_totals[header.m_name.c_str()];
+      stotal.m_count++;
+      stotal.m_compsize += header.m_compsize;
+      stotal.m_uncompsize += header.m_uncompsize;
+      all_stored += header.m_compsize;
+      const bool group = (0 != (header.m_options & accio::io::option::group));
+      if(group) {
+        groups.push_back(header);
+      }
+      if((not summary_only) and (group or (0 != (header.m_options & accio::io::option::dictionary_record)))) {
+        print_header("Stored record #" + std::to_string(nstored) + ": ", header, header.m_compsize, summary);
+      }
+      nstored++;
+    }
+    if(accio::error_codes::stream::eof != status) {
+      stream.close();
+      std::cout << "Number of stored records: " << nstored << std::endl;
+      print_totals("Stored records:", stored_totals, all_stored, true);
+      std::cerr << "ERROR - Stopped after " << nstored << " stored records, error code " << error_str(status) << std::endl;
+      return 1;
+    }
+    // the records, each grouped record taking the share of the stored
+    // group size matching its share of the uncompressed group
+    std::vector<accio::io::record_position> index;
+    status = stream.build_index(index);
+    std::size_t nrecords = 0, all_uncompsize = 0, all_blocksize = 0, ngroups = 0;
+    accio::types::offset_type group_offset = -1;
+    while((accio::error_codes::stream::success == status) and
+      (accio::error_codes::stream::success == (status = stream.next_header(header, &summary)))) {
+      std::size_t compsize = header.m_compsize;
+      if((nrecords < index.size()) and (accio::io::ungrouped != index[nrecords].m_group_offset)) {
+        // the groups are met in file order
+        if(index[nrecords].m_offset != group_offset) {
+          group_offset = index[nrecords].m_offset;
+          ngroups++;
+        }
+        if(ngroups <= groups.size()) {
+          auto &group_header = groups[ngroups - 1];
+          compsize = static_cast<std::size_t>(header.m_uncompsize / ratio(group_header.m_uncompsize, group_header.m_compsize));
+        }
+      }
+      auto &rtotal = record_totals[header.m_name.c_str()];
+      rtotal.m_count++;
+      rtotal.m_compsize += compsize;
+      rtotal.m_uncompsize += header.m_uncompsize;
+      all_uncompsize += header.m_uncompsize;
+      for(auto &block : summary) {
+        // the compressed size of the blocks is not known:
+        // assume the same compression ratio for all the blocks of a record
+        auto &btotal = block_totals[block.m_type.c_str()];
+        btotal.m_count++;
+        btotal.m_uncompsize += block.m_size;
+        btotal.m_compsize += static_cast<std::size_t>(block.m_size / ratio(header.m_uncompsize, compsize));
+        all_blocksize += block.m_size;
+      }
+      if(not summary_only) {
+        print_header("Record #" + std::to_string(nrecords) + ": ", header, compsize, summary);
+      }
+      nrecords++;
+    }
+    stream.close();
+    std::cout << "Number of stored records: " << nstored << std::endl;
+    std::cout << "Number of records: " << nrecords << std::endl;
+    print_totals("Stored records:", stored_totals, all_stored, true);
+    print_totals("Records:", record_totals, all_uncompsize);
+    print_totals("Blocks:", block_totals, all_blocksize);
+    if(accio::error_codes::stream::eof != status) {
+      std::cerr << "ERROR - Stopped after " << nrecords << " records, error code " << error_str(status) << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  /// Time a reading stage over the whole file
+  template <typename F>
+  int bench_stage(const std::string &name, const std::string &fname, double file_size, F read_one) {
+    stream_type stream;
+    if(accio::error_codes::stream::success != stream.open(fname, accio::io::open_mode::read)) {
+      std::cerr << "ERROR - Couldn't open file " << fname << std::endl;
+      return 1;
+    }
+    std::size_t nrecords = 0;
+    accio::error_codes::code_type status;
+    auto start = std::chrono::steady_clock::now();
+    while(accio::error_codes::stream::success == (status = read_one(stream))) {
+      nrecords++;
+    }
+    if(accio::error_codes::stream::eof == status) {
+      status = stream.wait_checksum();
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stream.close();
+    std::cout << "  " << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+      << std::setw(12) << file_size / (1024.*1024.) / elapsed << " Mo/s"
+      << std::setw(14) << nrecords / elapsed << " records/s" << std::endl;
+    if((accio::error_codes::stream::eof != status) and (accio::error_codes::stream::success != status)) {
+      std::cerr << "ERROR - Stopped after " << nrecords << " records, error code " << error_str(status) << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  /// Read the file end to end, stage by stage
+  int bench(const std::string &fname) {
+    struct stat st;
+    if(0 != accio::io::file::stat(fname.c_str(), &st)) {
+      std::cerr << "ERROR - Couldn't stat file " << fname << std::endl;
+      return 1;
+    }
+    const double file_size = static_cast<double>(st.st_size);
+    accio::io::record_header header;
+    accio::io::record_summary summary;
+    accio::buffer<unsigned char> buffer(1024);
+    std::cout << "File size: " << st.st_size << " o" << std::endl;
+    int ret = 0;
+    ret |= bench_stage("stored headers", fname, file_size, [&](stream_type &stream) {
+      return stream.next_stored_header(header, &summary);
+    });
+    ret |= bench_stage("headers + groups", fname, file_size, [&](stream_type &stream) {
+      return stream.next_header(header, &summary);
+    });
+    ret |= bench_stage("records", fname, file_size, [&](stream_type &stream) {
+      stream.set_verify_mode(accio::io::verify_mode::none);
+      return stream.read_record(header, summary, buffer);
+    });
+    ret |= bench_stage("records + checksums", fname, file_size, [&](stream_type &stream) {
+      stream.set_verify_mode(accio::io::verify_mode::sync);
+      return stream.read_record(header, summary, buffer);
+    });
+    return ret;
+  }
+}
+
+int main(int argc, char **argv) {
+  bool summary_only = false, bench_mode = false;
+  std::string fname;
+  for(int i=1 ; i<argc ; i++) {
+    std::string arg = argv[i];
+    if(("-s" == arg) or ("--summary" == arg)) {
+      summary_only = true;
+    }
+    else if(("-b" == arg) or ("--bench" == arg)) {
+      bench_mode = true;
+    }
+    else if(("-h" == arg) or ("--help" == arg)) {
+      usage();
+      return 0;
+    }
+    else if(fname.empty() and ('-' != arg[0])) {
+      fname = arg;
+    }
+    else {
+      usage();
+      return 1;
+    }
+  }
+  if(fname.empty()) {
+    usage();
+    return 1;
+  }
+  return bench_mode ? bench(fname) : inspect(fname, summary_only);
+}